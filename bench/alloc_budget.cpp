@@ -0,0 +1,187 @@
+// Allocation regression check for the market-data path.
+//
+// Replays the recorded corpus through BackpackClient::dispatch_message into
+// typed handlers, measures steady-state allocations per message for each
+// channel, and exits non-zero if any channel exceeds its budget. The call
+// sites responsible are printed for channels over budget, or for every
+// channel with --sites.
+//
+// The budgets are regression ceilings taken from the counts measured when
+// the harness was added. They are not a claim that the path is
+// allocation-free: parsing still builds a nlohmann::json DOM per frame.
+// WebSocketClient's read loop is not driven either. Its per-frame work is a
+// copy into a reused std::string, which does not allocate once the string
+// has grown to the largest frame, but that is not measured here.
+//
+// Usage: backpack_alloc_budget [--passes N] [--sites N] [--budget channel=N]... [--frame-arena]
+
+#include <cstdio>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <string>
+
+#include <backpack/backpack_client.hpp>
+
+#include "alloc_counter.hpp"
+#include "corpus.hpp"
+
+using backpack::bench::AllocSnapshot;
+using backpack::bench::Corpus;
+using backpack::bench::load_corpus;
+
+namespace {
+
+// Steady-state allocations allowed per message, set at the counts measured
+// when the harness was added; lower them as allocations are removed, never
+// raise them to make a change pass. Almost all of what remains
+// is the nlohmann::json DOM built by parse (one node per value plus object
+// and array storage); the rest are std::string members of the decoded types
+// too long for the small-string buffer, e.g. ISO 8601 timestamps, and the
+// order book vectors. --frame-arena subscribes with the backpack::pmr types
+// and moves those into a per-frame arena.
+std::map<std::string, double> default_budgets() {
+    return {
+        {"ticker", 37},
+        {"trades", 34},
+        {"depth", 242},
+        {"orders", 47},
+    };
+}
+
+struct Options {
+    int passes = 200;
+    size_t sites = 0;
+    bool frame_arena = false;
+    std::map<std::string, double> budgets = default_budgets();
+};
+
+class Replay {
+public:
+    Replay(const Corpus& corpus, bool frame_arena)
+        : corpus_(corpus), client_("wss://127.0.0.1:1", "http://127.0.0.1:1") {
+        if (frame_arena) {
+            client_.enable_frame_arena();
+            subscribe<backpack::pmr::Ticker, backpack::pmr::Trade, backpack::pmr::OrderBook, backpack::pmr::Order>(
+                corpus);
+        } else {
+            subscribe<backpack::Ticker, backpack::Trade, backpack::OrderBook, backpack::Order>(corpus);
+        }
+    }
+
+    // The arena only backs the backpack::pmr event types
+    template<typename Ticker, typename Trade, typename OrderBook, typename Order>
+    void subscribe(const Corpus& corpus) {
+        using backpack::Channel;
+        auto count = [this](const auto&) { ++delivered_; };
+        for (const auto& payload : corpus.payloads) {
+            std::string symbol = payload.value("symbol", "");
+            client_.subscribe<Ticker>(Channel::TICKER, symbol, count);
+            client_.subscribe<Trade>(Channel::TRADES, symbol, count);
+            client_.subscribe<OrderBook>(Channel::DEPTH, symbol, count);
+        }
+        client_.subscribe<Order>(Channel::USER_ORDERS, "", count);
+    }
+
+    void run(int passes) {
+        for (int pass = 0; pass < passes; ++pass) {
+            for (const auto& frame : corpus_.frames) {
+                client_.dispatch_message(frame);
+            }
+        }
+    }
+
+    uint64_t delivered() const { return delivered_; }
+
+private:
+    const Corpus& corpus_;
+    backpack::BackpackClient client_;
+    uint64_t delivered_ = 0;
+};
+
+bool check_channel(const std::string& channel, double budget, const Options& options) {
+    const Corpus& corpus = load_corpus(channel);
+    Replay replay(corpus, options.frame_arena);
+
+    // First pass grows caches, handler state and metric series; only steady state counts
+    replay.run(1);
+
+    uint64_t delivered_before = replay.delivered();
+    AllocSnapshot start = AllocSnapshot::take();
+    replay.run(options.passes);
+    AllocSnapshot end = AllocSnapshot::take();
+
+    double messages = static_cast<double>(corpus.frames.size()) * options.passes;
+    if (replay.delivered() - delivered_before != static_cast<uint64_t>(messages)) {
+        throw std::runtime_error("Not every " + channel + " frame reached its handler");
+    }
+
+    double allocs = static_cast<double>(end.allocations - start.allocations) / messages;
+    double bytes = static_cast<double>(end.bytes - start.bytes) / messages;
+    bool ok = allocs <= budget;
+    std::printf("%-8s allocs/msg=%-8.2f bytes/msg=%-10.1f ceiling=%-8.2f %s\n",
+                channel.c_str(), allocs, bytes, budget, ok ? "OK" : "OVER BUDGET");
+
+    size_t sites = options.sites > 0 ? options.sites : (ok ? 0 : 5);
+    if (sites > 0) {
+        backpack::bench::clear_alloc_sites();
+        backpack::bench::start_site_capture();
+        replay.run(1);
+        backpack::bench::stop_site_capture();
+        std::fflush(stdout);
+        backpack::bench::print_alloc_sites(std::cout, sites, static_cast<double>(corpus.frames.size()));
+        std::cout << std::flush;
+    }
+    return ok;
+}
+
+void print_usage(const char* argv0) {
+    std::cout << "Usage: " << argv0 << " [options]\n"
+              << "  --passes N           Corpus passes measured per channel (default 200)\n"
+              << "  --sites N            Print the top N allocating call sites for every channel\n"
+              << "  --budget CHANNEL=N   Override a channel's allocs/msg ceiling\n"
+              << "  --frame-arena        Subscribe with the backpack::pmr types, decoded into a per-frame arena\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    try {
+        Options options;
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            auto next = [&]() -> std::string {
+                if (i + 1 >= argc) {
+                    throw std::invalid_argument("Missing value for " + arg);
+                }
+                return argv[++i];
+            };
+
+            if (arg == "--passes") options.passes = std::stoi(next());
+            else if (arg == "--sites") options.sites = std::stoul(next());
+            else if (arg == "--frame-arena") options.frame_arena = true;
+            else if (arg == "--budget") {
+                std::string value = next();
+                size_t eq = value.find('=');
+                if (eq == std::string::npos) {
+                    throw std::invalid_argument("Budget must be CHANNEL=N: " + value);
+                }
+                options.budgets[value.substr(0, eq)] = std::stod(value.substr(eq + 1));
+            } else if (arg == "--help" || arg == "-h") {
+                print_usage(argv[0]);
+                return 0;
+            } else {
+                throw std::invalid_argument("Unknown option: " + arg);
+            }
+        }
+
+        bool ok = true;
+        for (const auto& budget : options.budgets) {
+            ok = check_channel(budget.first, budget.second, options) && ok;
+        }
+        return ok ? 0 : 1;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 2;
+    }
+}
@@ -0,0 +1,259 @@
+#include "alloc_counter.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <cxxabi.h>
+#include <execinfo.h>
+
+namespace backpack {
+namespace bench {
+
+AllocCounters& alloc_counters() {
+    static AllocCounters counters;
+    return counters;
+}
+
+namespace {
+
+constexpr size_t SITE_TABLE_SIZE = 4096;
+
+AllocSite site_table[SITE_TABLE_SIZE];
+size_t site_count = 0;
+std::atomic<bool> capturing{false};
+thread_local bool in_capture = false;
+
+uint64_t hash_frames(void* const* frames, int depth) {
+    uint64_t h = 1469598103934665603ULL;
+    for (int i = 0; i < depth; ++i) {
+        h = (h ^ reinterpret_cast<uintptr_t>(frames[i])) * 1099511628211ULL;
+    }
+    return h;
+}
+
+// Open-addressed insert into the fixed table; allocation-free so it can run inside operator new
+void record_site(std::size_t size) {
+    void* frames[AllocSite::MAX_FRAMES];
+    int depth = backtrace(frames, AllocSite::MAX_FRAMES);
+    if (depth <= 0) {
+        return;
+    }
+
+    size_t slot = hash_frames(frames, depth) % SITE_TABLE_SIZE;
+    for (size_t probe = 0; probe < SITE_TABLE_SIZE; ++probe, slot = (slot + 1) % SITE_TABLE_SIZE) {
+        AllocSite& site = site_table[slot];
+        if (site.allocations == 0) {
+            std::memcpy(site.frames, frames, sizeof(void*) * static_cast<size_t>(depth));
+            site.depth = depth;
+            site.allocations = 1;
+            site.bytes = size;
+            ++site_count;
+            return;
+        }
+        if (site.depth == depth && std::memcmp(site.frames, frames, sizeof(void*) * static_cast<size_t>(depth)) == 0) {
+            ++site.allocations;
+            site.bytes += size;
+            return;
+        }
+    }
+}
+
+std::string demangle(const char* symbol) {
+    // backtrace_symbols gives "module(mangled+0xoff) [addr]"
+    const char* begin = std::strchr(symbol, '(');
+    const char* end = begin ? std::strchr(begin, '+') : nullptr;
+    if (!begin || !end || end == begin + 1) {
+        return symbol;
+    }
+
+    std::string mangled(begin + 1, end);
+    int status = 0;
+    std::unique_ptr<char, void (*)(void*)> name(abi::__cxa_demangle(mangled.c_str(), nullptr, nullptr, &status), std::free);
+    if (status != 0) {
+        return mangled;
+    }
+
+    // Collapse template arguments; nlohmann::json signatures are otherwise unreadable
+    std::string shortened;
+    int nesting = 0;
+    for (const char* c = name.get(); *c; ++c) {
+        if (*c == '<') {
+            if (nesting++ == 0) {
+                shortened += "<>";
+            }
+        } else if (*c == '>' && nesting > 0) {
+            --nesting;
+        } else if (nesting == 0) {
+            shortened += *c;
+        }
+    }
+    return shortened;
+}
+
+} // namespace
+
+void start_site_capture() {
+    // backtrace() loads libgcc on first use, which must not happen inside operator new
+    void* warmup[1];
+    backtrace(warmup, 1);
+    capturing.store(true, std::memory_order_relaxed);
+}
+
+void stop_site_capture() {
+    capturing.store(false, std::memory_order_relaxed);
+}
+
+void clear_alloc_sites() {
+    std::fill(std::begin(site_table), std::end(site_table), AllocSite{});
+    site_count = 0;
+}
+
+std::vector<AllocSite> alloc_sites() {
+    std::vector<AllocSite> sites;
+    sites.reserve(site_count);
+    for (const AllocSite& site : site_table) {
+        if (site.allocations > 0) {
+            sites.push_back(site);
+        }
+    }
+    std::sort(sites.begin(), sites.end(), [](const AllocSite& a, const AllocSite& b) {
+        return a.allocations > b.allocations;
+    });
+    return sites;
+}
+
+void print_alloc_sites(std::ostream& os, size_t top, double per) {
+    bool was_capturing = capturing.exchange(false, std::memory_order_relaxed);
+
+    std::vector<AllocSite> sites = alloc_sites();
+    for (size_t i = 0; i < sites.size() && i < top; ++i) {
+        const AllocSite& site = sites[i];
+        char header[128];
+        std::snprintf(header, sizeof(header), "  #%zu  %.2f allocs, %.1f bytes\n", i + 1,
+                      static_cast<double>(site.allocations) / per, static_cast<double>(site.bytes) / per);
+        os << header;
+
+        std::unique_ptr<char*, void (*)(void*)> symbols(backtrace_symbols(site.frames, site.depth), std::free);
+        std::vector<std::string> frames;
+        for (int f = 0; f < site.depth; ++f) {
+            frames.push_back(symbols ? demangle(symbols.get()[f]) : "?");
+        }
+
+        // Start below operator new so the allocator hook's own frames are skipped
+        size_t first = 0;
+        for (size_t f = 0; f < frames.size(); ++f) {
+            if (frames[f].rfind("operator new", 0) == 0) {
+                first = f + 1;
+            }
+        }
+        for (size_t f = first; f < frames.size() && f < first + 8; ++f) {
+            os << "        " << frames[f] << "\n";
+        }
+    }
+
+    capturing.store(was_capturing, std::memory_order_relaxed);
+}
+
+} // namespace bench
+} // namespace backpack
+
+namespace {
+
+void count_alloc(std::size_t size) {
+    auto& c = backpack::bench::alloc_counters();
+    c.allocations.fetch_add(1, std::memory_order_relaxed);
+    c.bytes.fetch_add(size, std::memory_order_relaxed);
+    
+    if (backpack::bench::capturing.load(std::memory_order_relaxed) && !backpack::bench::in_capture) {
+        backpack::bench::in_capture = true;
+        backpack::bench::record_site(size);
+        backpack::bench::in_capture = false;
+    }
+}
+
+void* counted_alloc(std::size_t size) {
+    count_alloc(size);
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+// Aligned new is what std::pmr::new_delete_resource() uses, so it must be counted too
+void* counted_alloc(std::size_t size, std::align_val_t alignment) {
+    count_alloc(size);
+    auto align = static_cast<std::size_t>(alignment);
+    if (void* p = std::aligned_alloc(align, (std::max<std::size_t>(size, 1) + align - 1) / align * align)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+} // namespace
+
+void* operator new(std::size_t size) {
+    return counted_alloc(size);
+}
+
+void* operator new[](std::size_t size) {
+    return counted_alloc(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return counted_alloc(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return counted_alloc(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    return counted_alloc(size, alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return counted_alloc(size, alignment);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept {
+    std::free(p);
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+namespace backpack {
+namespace bench {
+
+/**
+ * @brief Process-wide allocation counters
+ * 
+ * Populated by the replacement operator new/delete in alloc_counter.cpp,
+ * which every benchmark executable links in.
+ */
+struct AllocCounters {
+    std::atomic<uint64_t> allocations{0};
+    std::atomic<uint64_t> bytes{0};
+};
+
+AllocCounters& alloc_counters();
+
+/**
+ * @brief Snapshot of the allocation counters, used to compute per-iteration deltas
+ */
+struct AllocSnapshot {
+    uint64_t allocations;
+    uint64_t bytes;
+    
+    static AllocSnapshot take() {
+        auto& c = alloc_counters();
+        return {c.allocations.load(std::memory_order_relaxed), c.bytes.load(std::memory_order_relaxed)};
+    }
+};
+
+/**
+ * @brief Allocations attributed to one call stack
+ */
+struct AllocSite {
+    static constexpr int MAX_FRAMES = 16;
+    
+    void* frames[MAX_FRAMES];
+    int depth;
+    uint64_t allocations;
+    uint64_t bytes;
+};
+
+/**
+ * @brief Start attributing every allocation to its call stack
+ * 
+ * Capture walks the stack on each allocation, so it is far slower than plain
+ * counting; enable it only around the code being investigated. The site
+ * table has a fixed size and is not thread-safe: capture from one thread.
+ */
+void start_site_capture();
+
+/**
+ * @brief Stop attributing allocations; collected sites are kept
+ */
+void stop_site_capture();
+
+/**
+ * @brief Discard all collected sites
+ */
+void clear_alloc_sites();
+
+/**
+ * @brief Collected sites, most allocations first
+ */
+std::vector<AllocSite> alloc_sites();
+
+/**
+ * @brief Print the top sites with demangled frames
+ * 
+ * Link with -rdynamic (ENABLE_EXPORTS) so frames outside shared libraries
+ * resolve to names.
+ * 
+ * @param os Output stream
+ * @param top Number of sites to print
+ * @param per Divisor for the counts, e.g. the number of messages processed
+ */
+void print_alloc_sites(std::ostream& os, size_t top, double per = 1.0);
+
+} // namespace bench
+} // namespace backpack
@@ -0,0 +1,589 @@
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <openssl/evp.h>
+
+#include <backpack/backpack_client.hpp>
+#include <backpack/clock.hpp>
+#include <backpack/codec.hpp>
+#include <backpack/memory.hpp>
+#include <backpack/rest_client.hpp>
+#include <backpack/sharded_executor.hpp>
+#include <backpack/subscription_manager.hpp>
+#include <backpack/types.hpp>
+#include <backpack/utils.hpp>
+
+#include "alloc_counter.hpp"
+#include "corpus.hpp"
+#include "feedgen/feed_generator.hpp"
+
+using backpack::json;
+using backpack::bench::AllocSnapshot;
+using backpack::bench::Corpus;
+using backpack::bench::load_corpus;
+
+namespace {
+
+// Report allocations per iteration next to the timing columns
+class AllocReport {
+public:
+    explicit AllocReport(benchmark::State& state)
+        : state_(state), start_(AllocSnapshot::take()) {}
+
+    ~AllocReport() {
+        AllocSnapshot end = AllocSnapshot::take();
+        state_.counters["allocs/op"] = benchmark::Counter(
+            static_cast<double>(end.allocations - start_.allocations), benchmark::Counter::kAvgIterations);
+        state_.counters["bytes/op"] = benchmark::Counter(
+            static_cast<double>(end.bytes - start_.bytes), benchmark::Counter::kAvgIterations);
+    }
+
+private:
+    benchmark::State& state_;
+    AllocSnapshot start_;
+};
+
+template<typename T>
+void bench_from_json(benchmark::State& state, const std::string& corpus_name) {
+    const Corpus& corpus = load_corpus(corpus_name);
+    size_t i = 0;
+
+    AllocReport report(state);
+    for (auto _ : state) {
+        T obj = T::from_json(corpus.payloads[i]);
+        benchmark::DoNotOptimize(obj);
+        if (++i == corpus.payloads.size()) {
+            i = 0;
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+void BM_TickerFromJson(benchmark::State& state) {
+    bench_from_json<backpack::Ticker>(state, "ticker");
+}
+BENCHMARK(BM_TickerFromJson);
+
+void BM_TradeFromJson(benchmark::State& state) {
+    bench_from_json<backpack::Trade>(state, "trades");
+}
+BENCHMARK(BM_TradeFromJson);
+
+void BM_OrderBookFromJson(benchmark::State& state) {
+    bench_from_json<backpack::OrderBook>(state, "depth");
+}
+BENCHMARK(BM_OrderBookFromJson);
+
+void BM_OrderFromJson(benchmark::State& state) {
+    bench_from_json<backpack::Order>(state, "orders");
+}
+BENCHMARK(BM_OrderFromJson);
+
+// Decode into a frame arena reset after every event, as dispatch does with enable_frame_arena()
+template<typename T>
+void bench_from_json_arena(benchmark::State& state, const std::string& corpus_name) {
+    const Corpus& corpus = load_corpus(corpus_name);
+    backpack::FrameArena arena;
+    size_t i = 0;
+
+    AllocReport report(state);
+    for (auto _ : state) {
+        {
+            T obj = T::from_json(corpus.payloads[i], arena.resource());
+            benchmark::DoNotOptimize(obj);
+        }
+        arena.reset();
+        if (++i == corpus.payloads.size()) {
+            i = 0;
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+void BM_TradeFromJsonArena(benchmark::State& state) {
+    bench_from_json_arena<backpack::pmr::Trade>(state, "trades");
+}
+BENCHMARK(BM_TradeFromJsonArena);
+
+void BM_OrderBookFromJsonArena(benchmark::State& state) {
+    bench_from_json_arena<backpack::pmr::OrderBook>(state, "depth");
+}
+BENCHMARK(BM_OrderBookFromJsonArena);
+
+// Generate a throwaway ED25519 key so signing runs without real credentials
+std::string generate_test_private_key() {
+    EVP_PKEY* pkey = EVP_PKEY_Q_keygen(nullptr, nullptr, "ED25519");
+    if (!pkey) {
+        throw std::runtime_error("Failed to generate ED25519 key");
+    }
+
+    std::string raw(32, '\0');
+    size_t len = raw.size();
+    if (EVP_PKEY_get_raw_private_key(pkey, reinterpret_cast<unsigned char*>(raw.data()), &len) != 1) {
+        EVP_PKEY_free(pkey);
+        throw std::runtime_error("Failed to export ED25519 key");
+    }
+    EVP_PKEY_free(pkey);
+
+    raw.resize(len);
+    return backpack::base64_encode(raw);
+}
+
+backpack::OrderRequest sample_order() {
+    backpack::OrderRequest order;
+    order.symbol = "SOL-USDC";
+    order.side = backpack::OrderSide::BUY;
+    order.type = backpack::OrderType::LIMIT;
+    order.quantity = 12.5;
+    order.price = 142.35;
+    order.client_order_id = "1718116373589";
+    order.time_in_force = backpack::TimeInForce::IOC;
+    return order;
+}
+
+void BM_SignRequest(benchmark::State& state) {
+    backpack::RestClient client("http://127.0.0.1:1");
+    client.set_credentials("bench-key", generate_test_private_key());
+
+    const std::string body = sample_order().to_json().dump();
+    const int64_t timestamp = backpack::get_current_timestamp_ms();
+
+    AllocReport report(state);
+    for (auto _ : state) {
+        std::string signature = client.sign_request(backpack::HttpMethod::POST, timestamp, body);
+        benchmark::DoNotOptimize(signature);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SignRequest);
+
+void BM_OrderRequestToJson(benchmark::State& state) {
+    const backpack::OrderRequest order = sample_order();
+
+    AllocReport report(state);
+    for (auto _ : state) {
+        std::string body = order.to_json().dump();
+        benchmark::DoNotOptimize(body);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_OrderRequestToJson);
+
+void BM_UrlEncode(benchmark::State& state) {
+    const std::string input = "SOL-USDC&clientOrderId=1718116373589 side=BUY/limit~100%";
+
+    AllocReport report(state);
+    for (auto _ : state) {
+        std::string encoded = backpack::url_encode(input);
+        benchmark::DoNotOptimize(encoded);
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(input.size()));
+}
+BENCHMARK(BM_UrlEncode);
+
+void BM_BuildQueryString(benchmark::State& state) {
+    const std::map<std::string, std::string> params = {
+        {"symbol", "SOL-USDC"},
+        {"limit", "1000"},
+        {"fromId", "81723645"},
+        {"startTime", "1718116373589"},
+        {"endTime", "1718119973589"}
+    };
+
+    AllocReport report(state);
+    for (auto _ : state) {
+        std::string query = backpack::build_query_string(params);
+        benchmark::DoNotOptimize(query);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_BuildQueryString);
+
+// Codec throughput into caller buffers; range(0) is the input size in bytes.
+// 64 bytes is an ED25519 signature and 32 an HMAC-SHA256 digest.
+std::string random_bytes(size_t size) {
+    std::string bytes(size, '\0');
+    uint32_t x = 2463534242u;
+    for (auto& c : bytes) {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        c = static_cast<char>(x);
+    }
+    return bytes;
+}
+
+void BM_Base64Encode(benchmark::State& state) {
+    const std::string input = random_bytes(static_cast<size_t>(state.range(0)));
+    std::string out(backpack::codec::base64_encoded_size(input.size()), '\0');
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(backpack::codec::base64_encode(input.data(), input.size(), &out[0]));
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Base64Encode)->Arg(32)->Arg(64)->Arg(4096);
+
+// OpenSSL baseline for the encoder the SDK used before
+void BM_Base64EncodeOpenSSL(benchmark::State& state) {
+    const std::string input = random_bytes(static_cast<size_t>(state.range(0)));
+    std::string out(backpack::codec::base64_encoded_size(input.size()) + 1, '\0');
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(EVP_EncodeBlock(reinterpret_cast<unsigned char*>(&out[0]),
+            reinterpret_cast<const unsigned char*>(input.data()), static_cast<int>(input.size())));
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Base64EncodeOpenSSL)->Arg(32)->Arg(64)->Arg(4096);
+
+void BM_Base64Decode(benchmark::State& state) {
+    const std::string input = backpack::codec::base64_encode(random_bytes(static_cast<size_t>(state.range(0))));
+    std::vector<unsigned char> out(backpack::codec::base64_decoded_max_size(input.size()));
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(backpack::codec::base64_decode(input.data(), input.size(), out.data()));
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(input.size()));
+}
+BENCHMARK(BM_Base64Decode)->Arg(32)->Arg(64)->Arg(4096);
+
+void BM_HexEncode(benchmark::State& state) {
+    const std::string input = random_bytes(static_cast<size_t>(state.range(0)));
+    std::string out(2 * input.size(), '\0');
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(backpack::codec::hex_encode(input.data(), input.size(), &out[0]));
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_HexEncode)->Arg(32)->Arg(4096);
+
+void BM_HexDecode(benchmark::State& state) {
+    const std::string input = backpack::codec::hex_encode(random_bytes(static_cast<size_t>(state.range(0))));
+    std::vector<unsigned char> out(input.size() / 2);
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(backpack::codec::hex_decode(input.data(), input.size(), out.data()));
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(input.size()));
+}
+BENCHMARK(BM_HexDecode)->Arg(32)->Arg(4096);
+
+void BM_UrlEncodeInto(benchmark::State& state) {
+    const std::string input = "SOL-USDC&clientOrderId=1718116373589 side=BUY/limit~100%";
+    std::string out(3 * input.size(), '\0');
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(backpack::codec::url_encode(input.data(), input.size(), &out[0]));
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(input.size()));
+}
+BENCHMARK(BM_UrlEncodeInto);
+
+// Event-rate timestamps: consecutive calls mostly fall in the same second
+void BM_FormatIso8601(benchmark::State& state) {
+    int64_t timestamp = 1718116320358;
+    char out[backpack::ISO8601_MS_LENGTH];
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(backpack::format_iso8601(timestamp++, out));
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FormatIso8601);
+
+void BM_TimestampToIso8601(benchmark::State& state) {
+    int64_t timestamp = 1718116320358;
+
+    AllocReport report(state);
+    for (auto _ : state) {
+        std::string formatted = backpack::timestamp_to_iso8601(timestamp++);
+        benchmark::DoNotOptimize(formatted);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_TimestampToIso8601);
+
+void BM_ParseIso8601(benchmark::State& state) {
+    const Corpus& corpus = load_corpus("trades");
+    std::vector<std::string> timestamps;
+    for (const auto& payload : corpus.payloads) {
+        timestamps.push_back(payload.at("timestamp").get<std::string>());
+    }
+    size_t i = 0;
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(backpack::parse_iso8601_ms(timestamps[i]));
+        if (++i == timestamps.size()) {
+            i = 0;
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ParseIso8601);
+
+void BM_SystemClockNow(benchmark::State& state) {
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(std::chrono::system_clock::now());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SystemClockNow);
+
+void BM_SteadyClockNow(benchmark::State& state) {
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(std::chrono::steady_clock::now());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SteadyClockNow);
+
+// Arg 0: monotonic now_ns(), arg 1: wall_ns()
+void BM_TscClock(benchmark::State& state) {
+    if (!backpack::TscClock::enable()) {
+        state.SkipWithError("no invariant TSC");
+        return;
+    }
+    bool wall = state.range(0) != 0;
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(wall ? backpack::TscClock::wall_ns() : backpack::TscClock::now_ns());
+    }
+    state.counters["tsc_ghz"] = backpack::TscClock::tsc_hz() / 1e9;
+    state.SetItemsProcessed(state.iterations());
+    backpack::TscClock::disable();
+}
+BENCHMARK(BM_TscClock)->Arg(0)->Arg(1);
+
+// Replay recorded frames through BackpackClient::dispatch_message into typed handlers
+// (frame_arena: backpack::pmr event types decoded into a per-frame arena;
+// bound: handlers passed to subscribe<T> instead of the std::function subscribe_* methods;
+// feed_latency: every frame's exchange timestamp also recorded by the feed latency monitor)
+void bench_dispatch(benchmark::State& state, const std::string& corpus_name, bool frame_arena = false,
+                    bool bound = false, bool feed_latency = false) {
+    using backpack::Channel;
+    const Corpus& corpus = load_corpus(corpus_name);
+
+    backpack::BackpackClient client("wss://127.0.0.1:1", "http://127.0.0.1:1");
+    if (frame_arena) {
+        client.enable_frame_arena();
+    }
+    if (feed_latency) {
+        client.enable_feed_latency();
+    }
+    uint64_t delivered = 0;
+    auto count = [&delivered](const auto&) { ++delivered; };
+
+    for (const auto& payload : corpus.payloads) {
+        std::string symbol = payload.value("symbol", "");
+        if (frame_arena) {
+            client.subscribe<backpack::pmr::Ticker>(Channel::TICKER, symbol, count);
+            client.subscribe<backpack::pmr::Trade>(Channel::TRADES, symbol, count);
+            client.subscribe<backpack::pmr::OrderBook>(Channel::DEPTH, symbol, count);
+        } else if (bound) {
+            client.subscribe<backpack::Ticker>(Channel::TICKER, symbol, count);
+            client.subscribe<backpack::Trade>(Channel::TRADES, symbol, count);
+            client.subscribe<backpack::OrderBook>(Channel::DEPTH, symbol, count);
+        } else {
+            client.subscribe_ticker(symbol, count);
+            client.subscribe_trades(symbol, count);
+            client.subscribe_depth(symbol, count);
+        }
+    }
+    if (frame_arena) {
+        client.subscribe<backpack::pmr::Order>(Channel::USER_ORDERS, "", count);
+    } else if (bound) {
+        client.subscribe<backpack::Order>(Channel::USER_ORDERS, "", count);
+    } else {
+        client.subscribe_user_orders(count);
+    }
+
+    size_t i = 0;
+    AllocReport report(state);
+    for (auto _ : state) {
+        client.dispatch_message(corpus.frames[i]);
+        if (++i == corpus.frames.size()) {
+            i = 0;
+        }
+    }
+
+    if (delivered != static_cast<uint64_t>(state.iterations())) {
+        state.SkipWithError("Not every frame reached its handler");
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+void BM_DispatchTicker(benchmark::State& state) {
+    bench_dispatch(state, "ticker");
+}
+BENCHMARK(BM_DispatchTicker);
+
+void BM_DispatchTrades(benchmark::State& state) {
+    bench_dispatch(state, "trades");
+}
+BENCHMARK(BM_DispatchTrades);
+
+void BM_DispatchDepth(benchmark::State& state) {
+    bench_dispatch(state, "depth");
+}
+BENCHMARK(BM_DispatchDepth);
+
+void BM_DispatchOrders(benchmark::State& state) {
+    bench_dispatch(state, "orders");
+}
+BENCHMARK(BM_DispatchOrders);
+
+void BM_DispatchTradesArena(benchmark::State& state) {
+    bench_dispatch(state, "trades", true);
+}
+BENCHMARK(BM_DispatchTradesArena);
+
+void BM_DispatchDepthArena(benchmark::State& state) {
+    bench_dispatch(state, "depth", true);
+}
+BENCHMARK(BM_DispatchDepthArena);
+
+void BM_DispatchTickerBound(benchmark::State& state) {
+    bench_dispatch(state, "ticker", false, true);
+}
+BENCHMARK(BM_DispatchTickerBound);
+
+void BM_DispatchTradesBound(benchmark::State& state) {
+    bench_dispatch(state, "trades", false, true);
+}
+BENCHMARK(BM_DispatchTradesBound);
+
+void BM_DispatchTradesFeedLatency(benchmark::State& state) {
+    bench_dispatch(state, "trades", false, false, true);
+}
+BENCHMARK(BM_DispatchTradesFeedLatency);
+
+// Cost of producing a synthetic frame; must stay well below the dispatch cost it feeds
+void BM_FeedGenerate(benchmark::State& state) {
+    backpack::feedgen::FeedConfig config;
+    config.symbols = backpack::feedgen::FeedGenerator::make_symbols(static_cast<size_t>(state.range(0)));
+    backpack::feedgen::FeedGenerator generator(std::move(config));
+
+    AllocReport report(state);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(generator.next().data());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FeedGenerate)->Arg(1)->Arg(100);
+
+// Mixed depth/trades/ticker frames for N symbols straight into dispatch_message;
+// items/s is the single-core saturation rate of the parse and dispatch path
+void BM_SyntheticDispatch(benchmark::State& state) {
+    backpack::feedgen::FeedConfig config;
+    config.symbols = backpack::feedgen::FeedGenerator::make_symbols(static_cast<size_t>(state.range(0)));
+    backpack::feedgen::FeedGenerator generator(config);
+
+    backpack::BackpackClient client("wss://127.0.0.1:1", "http://127.0.0.1:1");
+    uint64_t delivered = 0;
+    for (const auto& symbol : config.symbols) {
+        client.subscribe_ticker(symbol, [&delivered](const backpack::Ticker&) { ++delivered; });
+        client.subscribe_trades(symbol, [&delivered](const backpack::Trade&) { ++delivered; });
+        client.subscribe_depth(symbol, [&delivered](const backpack::OrderBook&) { ++delivered; });
+    }
+
+    AllocReport report(state);
+    for (auto _ : state) {
+        client.dispatch_message(generator.next());
+    }
+
+    if (delivered != static_cast<uint64_t>(state.iterations())) {
+        state.SkipWithError("Not every frame reached its handler");
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SyntheticDispatch)->Arg(1)->Arg(100)->Arg(1000);
+
+// BM_SyntheticDispatch with callbacks on a ShardedExecutor of range(1) workers;
+// each callback burns ~range(2) ns, so items/s shows how far the pool scales
+void BM_ShardedDispatch(benchmark::State& state) {
+    backpack::feedgen::FeedConfig config;
+    config.symbols = backpack::feedgen::FeedGenerator::make_symbols(static_cast<size_t>(state.range(0)));
+    backpack::feedgen::FeedGenerator generator(config);
+
+    backpack::BackpackClient client("wss://127.0.0.1:1", "http://127.0.0.1:1");
+    backpack::ShardedExecutor::Options options;
+    options.workers = static_cast<size_t>(state.range(1));
+    client.enable_sharded_dispatch(options);
+
+    const int64_t work_ns = state.range(2);
+    std::atomic<uint64_t> delivered{0};
+    auto handler = [&delivered, work_ns](const auto&) {
+        int64_t until = backpack::LatencyTracer::now_ns() + work_ns;
+        while (backpack::LatencyTracer::now_ns() < until) {
+        }
+        delivered.fetch_add(1, std::memory_order_relaxed);
+    };
+    for (const auto& symbol : config.symbols) {
+        client.subscribe_ticker(symbol, handler);
+        client.subscribe_trades(symbol, handler);
+        client.subscribe_depth(symbol, handler);
+    }
+
+    for (auto _ : state) {
+        client.dispatch_message(generator.next());
+    }
+    while (delivered.load(std::memory_order_relaxed) < static_cast<uint64_t>(state.iterations())) {
+        std::this_thread::yield();
+    }
+
+    backpack::ShardedExecutorStats stats = client.sharded_executor()->stats();
+    state.counters["steals"] = static_cast<double>(stats.steals);
+    state.counters["producer_waits"] = static_cast<double>(stats.producer_waits);
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ShardedDispatch)
+    ->Args({100, 1, 1000})
+    ->Args({100, 2, 1000})
+    ->Args({100, 4, 1000})
+    ->UseRealTime();
+
+// Subscribe range(0) streams and acknowledge them, with at most range(1) streams per frame
+void BM_SubscriptionFlush(benchmark::State& state) {
+    std::vector<std::string> streams;
+    for (int64_t i = 0; i < state.range(0); ++i) {
+        streams.push_back(backpack::stream_name("trades", "SYM" + std::to_string(i) + "-USDC"));
+    }
+    backpack::SubscriptionManager::Options options;
+    options.max_streams_per_frame = static_cast<size_t>(state.range(1));
+
+    size_t frames = 0;
+    size_t bytes = 0;
+    for (auto _ : state) {
+        std::vector<uint64_t> ids;
+        backpack::SubscriptionManager manager([&](const std::string& frame) {
+            ids.push_back(json::parse(frame)["id"].get<uint64_t>());
+            bytes += frame.size();
+            return true;
+        }, options);
+        manager.on_connected();
+        for (const auto& stream : streams) {
+            manager.subscribe(stream);
+        }
+        frames += manager.flush();
+        for (uint64_t id : ids) {
+            manager.on_response(json{{"result", nullptr}, {"id", id}});
+        }
+        benchmark::DoNotOptimize(manager.stats());
+    }
+    state.counters["frames"] = static_cast<double>(frames) / static_cast<double>(state.iterations());
+    state.counters["bytes"] = static_cast<double>(bytes) / static_cast<double>(state.iterations());
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_SubscriptionFlush)->Args({1000, 1})->Args({1000, 100});
+
+} // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,50 @@
+#include "corpus.hpp"
+
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+
+namespace backpack {
+namespace bench {
+
+std::string corpus_dir() {
+    if (const char* dir = std::getenv("BACKPACK_BENCH_CORPUS")) {
+        return dir;
+    }
+    return BACKPACK_BENCH_CORPUS_DIR;
+}
+
+const Corpus& load_corpus(const std::string& name) {
+    static std::map<std::string, Corpus> cache;
+
+    auto it = cache.find(name);
+    if (it != cache.end()) {
+        return it->second;
+    }
+
+    std::string path = corpus_dir() + "/" + name + ".jsonl";
+    std::ifstream in(path);
+    if (!in) {
+        throw std::runtime_error("Failed to open corpus file: " + path);
+    }
+
+    Corpus corpus;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty()) {
+            continue;
+        }
+        corpus.payloads.push_back(nlohmann::json::parse(line).at("data"));
+        corpus.frames.push_back(std::move(line));
+    }
+
+    if (corpus.frames.empty()) {
+        throw std::runtime_error("Corpus file is empty: " + path);
+    }
+
+    return cache.emplace(name, std::move(corpus)).first->second;
+}
+
+} // namespace bench
+} // namespace backpack
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+namespace backpack {
+namespace bench {
+
+/**
+ * @brief Recorded WebSocket frames, one JSON frame per line of <name>.jsonl
+ */
+struct Corpus {
+    std::vector<std::string> frames;
+    std::vector<nlohmann::json> payloads; // "data" member of each frame
+};
+
+/**
+ * @brief Directory holding the corpus files
+ * 
+ * BACKPACK_BENCH_CORPUS in the environment overrides the built-in path.
+ */
+std::string corpus_dir();
+
+/**
+ * @brief Load (and cache) a corpus by name, e.g. "ticker"
+ * 
+ * @throws std::runtime_error if the file is missing or empty
+ */
+const Corpus& load_corpus(const std::string& name);
+
+} // namespace bench
+} // namespace backpack
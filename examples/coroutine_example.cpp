@@ -0,0 +1,73 @@
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <iostream>
+#include <string>
+#include <backpack/backpack_client.hpp>
+
+// Global flag for graceful shutdown
+std::atomic<bool> running(true);
+
+// Signal handler for graceful shutdown
+void signal_handler(int signal) {
+    std::cout << "Received signal " << signal << ", shutting down..." << std::endl;
+    running = false;
+}
+
+// Print trades as they arrive; runs inside client.poll()
+backpack::Task<> print_trades(backpack::BackpackClient& client, std::string symbol) {
+    while (running) {
+        auto trades = client.trades(symbol);
+        try {
+            while (auto trade = co_await trades.next()) {
+                std::cout << trade->symbol << " " << (trade->is_buyer_maker ? "sell " : "buy  ")
+                          << trade->quantity << " @ " << trade->price << std::endl;
+            }
+            co_return;
+        } catch (const backpack::StreamOverflowError& e) {
+            // Trades were missed while this loop was busy; start over on a fresh stream
+            std::cerr << e.what() << ", resubscribing" << std::endl;
+        }
+    }
+}
+
+// Print the clock offset once, then every ticker
+backpack::Task<> print_tickers(backpack::BackpackClient& client, std::string symbol) {
+    int64_t server_time = co_await client.get_server_time_async();
+    std::cout << "Server time: " << server_time << " ms" << std::endl;
+
+    auto tickers = client.tickers(symbol);
+    while (auto ticker = co_await tickers.next()) {
+        std::cout << ticker->symbol << " last " << ticker->last_price
+                  << " bid " << ticker->best_bid << " ask " << ticker->best_ask << std::endl;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::signal(SIGINT, signal_handler);
+    std::signal(SIGTERM, signal_handler);
+
+    const std::string symbol = argc > 1 ? argv[1] : "SOL-USDC";
+
+    try {
+        backpack::BackpackClient client;
+        client.enable_poll_mode();
+        if (!client.connect()) {
+            std::cerr << "Failed to connect to WebSocket server" << std::endl;
+            return 1;
+        }
+
+        backpack::spawn(print_trades(client, symbol));
+        backpack::spawn(print_tickers(client, symbol));
+
+        // Every coroutine above resumes on this thread
+        while (running) {
+            client.poll(std::chrono::milliseconds(1));
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
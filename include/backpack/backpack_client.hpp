@@ -3,15 +3,30 @@
 #include <string>
 #include <memory>
 #include <functional>
+#include <atomic>
 #include <map>
 #include <mutex>
 #include <nlohmann/json.hpp>
 
+#include "feed_latency.hpp"
+#include "latency.hpp"
+#include "memory.hpp"
+#include "metrics.hpp"
+#include "metrics_exporter.hpp"
+#include "rcu.hpp"
+#include "runtime.hpp"
+#include "sharded_executor.hpp"
+#include "stream_watchdog.hpp"
+#include "subscription_manager.hpp"
 #include "types.hpp"
 #include "utils.hpp"
 #include "websocket_client.hpp"
 #include "rest_client.hpp"
 
+#ifdef BACKPACK_ENABLE_COROUTINES
+#include "coro.hpp"
+#endif
+
 namespace backpack {
 
 /**
@@ -34,6 +49,26 @@ public:
     explicit BackpackClient(const std::string& websocket_url = "wss://ws.backpack.exchange",
                            const std::string& rest_url = "https://api.backpack.exchange");
     
+    /**
+     * @brief Construct a BackpackClient that shares threads and caches with other clients
+     * 
+     * WebSocket I/O and heartbeats run on the runtime's io_context instead
+     * of an io thread of its own, and REST requests share the runtime's
+     * RestEngine (DNS results and TLS sessions). Use one runtime for many
+     * sub-accounts.
+     * 
+     * The destructor waits for the client's pending handlers on the runtime,
+     * so destroy the client from a thread that is not running the runtime,
+     * never from one of its callbacks; that aborts instead of deadlocking.
+     * 
+     * @param runtime Shared runtime; must outlive the client
+     * @param websocket_url WebSocket API URL (default: wss://ws.backpack.exchange)
+     * @param rest_url REST API URL (default: https://api.backpack.exchange)
+     */
+    explicit BackpackClient(std::shared_ptr<ClientRuntime> runtime,
+                            const std::string& websocket_url = "wss://ws.backpack.exchange",
+                            const std::string& rest_url = "https://api.backpack.exchange");
+    
     /**
      * @brief Destroy the BackpackClient object
      */
@@ -47,6 +82,18 @@ public:
      */
     void set_credentials(const std::string& api_key, const std::string& api_secret);
     
+    /**
+     * @brief Verify WebSocket and REST peers against a PEM CA bundle instead of the system one
+     * 
+     * The file replaces the system trust store on both connections. Clients
+     * on a ClientRuntime share its TLS context; use ClientRuntime::set_ca_file()
+     * for them instead.
+     * 
+     * @param path Path to a PEM file (e.g. the certificate written by mock_exchange)
+     * @throws std::runtime_error if the client uses a shared runtime
+     */
+    void set_ca_file(const std::string& path);
+    
     /**
      * @brief Connect to the WebSocket server
      * 
@@ -59,6 +106,99 @@ public:
      */
     void disconnect();
     
+    /**
+     * @brief Let the application run all network I/O from its own loop
+     * 
+     * In poll mode connect() starts no threads: WebSocket reads, writes and
+     * the heartbeat, and the *_async REST requests, only make progress when
+     * the application calls poll(), and every handler and callback runs on
+     * that thread. Opt-in helpers that sample or ping in the background
+     * (enable_server_clock(), enable_keepalive()) still use their own
+     * threads. Call before connect().
+     * 
+     * @param enabled Whether to run without internal I/O threads
+     */
+    void enable_poll_mode(bool enabled = true);
+    
+    /**
+     * @brief Run subscription callbacks on a worker pool instead of the io thread
+     * 
+     * Frames are still read and decoded on the io thread; each event is then
+     * handed to a ShardedExecutor keyed by symbol (by channel for private
+     * streams). Callbacks for one symbol run in order, one at a time, and
+     * different symbols run in parallel, so handlers must not share state
+     * across symbols without their own locking. Events handed off this way
+     * are allocated from the default resource, not the frame arena. Call
+     * once, before subscribing.
+     * 
+     * @param options Worker count, per-symbol queue size and batch size
+     * @throws std::runtime_error if already enabled or a stream has a handler
+     */
+    void enable_sharded_dispatch(ShardedExecutor::Options options = {});
+    
+    /**
+     * @brief Executor used by enable_sharded_dispatch(), or nullptr
+     */
+    ShardedExecutor* sharded_executor();
+    
+    /**
+     * @brief Watch every subscribed stream for silence longer than its SLA
+     * 
+     * Each stream's SLA follows its own message rate within per-channel
+     * bounds (see StreamWatchdog). Checks run from one timer on the
+     * WebSocket's io_context, so in poll mode they run from poll(). The
+     * callback runs there too, once when a stream goes stale and once when
+     * it recovers. With options.resubscribe, a stale stream is sent
+     * UNSUBSCRIBE and SUBSCRIBE on the open connection. Without a callback,
+     * stale streams are logged. Counts and per-stream silence are exported
+     * as backpack_ws_stream_* and backpack_ws_stale_* metrics. Call once,
+     * before connect() and before subscribing.
+     * 
+     * @param options Check interval, per-channel SLA policies and whether to resubscribe
+     * @param callback Receives stale and recovered events (optional)
+     * @throws std::runtime_error if already enabled, connected, or a stream has a handler
+     */
+    void enable_stream_watchdog(StreamWatchdog::Options options = {},
+                                std::function<void(const StaleStreamEvent&)> callback = nullptr);
+    
+    /**
+     * @brief Watchdog used by enable_stream_watchdog(), or nullptr
+     */
+    StreamWatchdog* stream_watchdog();
+    
+    /**
+     * @brief Measure how long feed messages take to arrive from the exchange
+     * 
+     * Each message's exchange time is compared with the wall time its frame
+     * was read, corrected by the exchange clock offset when
+     * enable_server_clock() is on (see FeedLatencyMonitor). Percentiles are
+     * kept per stream and for the connection, restart on every connect(),
+     * and are exported as backpack_ws_feed_latency_seconds and
+     * backpack_ws_stream_feed_latency_seconds, labelled with
+     * options.connection (default: the WebSocket URL). Call once, before
+     * subscribing.
+     * 
+     * @param options Connection label, offset refresh interval and latency cap
+     * @throws std::runtime_error if already enabled or a stream has a handler
+     */
+    void enable_feed_latency(FeedLatencyMonitor::Options options = {});
+    
+    /**
+     * @brief Monitor used by enable_feed_latency(), or nullptr
+     */
+    FeedLatencyMonitor* feed_latency();
+    
+    /**
+     * @brief Run ready network I/O, timers and REST completions without blocking
+     * 
+     * Completed REST requests run their callbacks first, then WebSocket
+     * handlers run until none are ready or the budget is used up.
+     * 
+     * @param budget Time after which to stop running WebSocket handlers (zero: one at most)
+     * @return Number of handlers and callbacks run
+     */
+    size_t poll(std::chrono::microseconds budget = std::chrono::microseconds::zero());
+    
     /**
      * @brief Check if connected to the WebSocket server
      * 
@@ -153,20 +293,234 @@ public:
      */
     bool subscribe_user_balances(std::function<void(const Balance&)> callback);
     
+    /**
+     * @brief Subscribe with a handler bound at compile time
+     * 
+     * The handler can be any callable taking const T&. It is stored by
+     * value and is not wrapped in std::function. Decoding T and calling the
+     * handler are compiled into one function per (T, Handler) pair, so each
+     * event costs one indirect call to reach that function and the handler
+     * can be inlined into it. The subscribe_* methods above use this with a
+     * std::function handler.
+     * 
+     * @tparam T Event type with a static from_json(json), or from_json(json, memory_resource*)
+     *           to decode from the event memory resource (the backpack::pmr types)
+     * @param channel Channel to subscribe to
+     * @param symbol Trading pair (empty for private channels)
+     * @param handler Callable invoked with each decoded event
+     * @return true if subscription successful, false otherwise
+     */
+    template<typename T, typename Handler>
+    bool subscribe(Channel channel, const std::string& symbol, Handler&& handler);
+    
     /**
      * @brief Unsubscribe from a channel
      * 
+     * The handler is removed at once; the UNSUBSCRIBE frame is sent now, at
+     * the end of the enclosing batch, or not at all if the stream was never
+     * subscribed on this connection.
+     * 
      * @param channel Channel to unsubscribe from
      * @param symbol Symbol to unsubscribe from (if applicable)
      * @return true if unsubscription successful, false otherwise
      */
     bool unsubscribe(Channel channel, const std::string& symbol = "");
     
+    /**
+     * @brief Holds back subscription frames until the scope ends
+     * 
+     * Returned by batch_subscriptions(). Batches nest; the outermost one
+     * sends everything subscribed or unsubscribed inside it as a few
+     * SUBSCRIBE and UNSUBSCRIBE frames.
+     */
+    class [[nodiscard]] SubscriptionBatch {
+    public:
+        ~SubscriptionBatch();
+        
+        SubscriptionBatch(const SubscriptionBatch&) = delete;
+        SubscriptionBatch& operator=(const SubscriptionBatch&) = delete;
+        
+    private:
+        friend class BackpackClient;
+        explicit SubscriptionBatch(BackpackClient& client);
+        
+        BackpackClient& client_;
+    };
+    
+    /**
+     * @brief Subscribe to many streams with a few frames instead of one per stream
+     * 
+     * @code
+     * {
+     *     auto batch = client.batch_subscriptions();
+     *     for (const auto& symbol : symbols) {
+     *         client.subscribe_trades(symbol, on_trade);
+     *     }
+     * } // One SUBSCRIBE per 100 streams goes out here
+     * @endcode
+     * 
+     * @return Scope that sends the pending changes when destroyed
+     */
+    SubscriptionBatch batch_subscriptions();
+    
+    /**
+     * @brief Desired, acknowledged and in-flight stream subscriptions
+     * 
+     * While connected, a timer on the WebSocket's io_context calls flush()
+     * at least every 500ms, so frames that timed out or could not be sent
+     * go out again without waiting for the next subscribe. Counts are
+     * exported as backpack_ws_subscription_* metrics.
+     */
+    SubscriptionManager& subscriptions();
+    
     /**
      * @brief Send ping to keep connection alive
      */
     void ping();
     
+    /**
+     * @brief Dispatch a raw WebSocket frame to the registered handlers
+     * 
+     * This is what the WebSocket read loop calls for every frame. It is public
+     * so recorded frames can be replayed through the same path (benchmarks, replay tools).
+     * 
+     * @param message Raw JSON frame as received from the server
+     */
+    void dispatch_message(const std::string& message);
+    
+    /**
+     * @brief Enable or disable tick-to-trade latency tracing
+     * 
+     * When enabled, each frame is timed from socket read through parse, handler
+     * entry and, for orders sent from a handler on the io thread, order encode,
+     * signing and write completion.
+     * 
+     * @param enabled Whether to capture timestamps
+     */
+    void enable_latency_tracing(bool enabled);
+    
+    /**
+     * @brief Decode market data events into a per-frame arena
+     * 
+     * Applies to subscriptions with the backpack::pmr event types, e.g.
+     * subscribe<pmr::Trade>(Channel::TRADES, ...); the plain types keep
+     * using the global allocator. Those events are allocated from a
+     * FrameArena that is reset once every handler for the frame has
+     * returned, so decoding stops using the global allocator after the arena
+     * has grown to the largest frame. Handlers that keep an event beyond the
+     * callback must copy it. Call before connect().
+     * 
+     * @param initial_bytes Initial arena size; 0 goes back to the global allocator
+     */
+    void enable_frame_arena(size_t initial_bytes = 64 * 1024);
+    
+    /**
+     * @brief Decode market data events from a caller-owned memory resource
+     * 
+     * Use this for batch lifetimes, e.g. an EventPool the application resets
+     * between batches. Like enable_frame_arena(), it only applies to the
+     * backpack::pmr event types. It replaces any frame arena. The resource must outlive
+     * its use by the client. Call before connect().
+     * 
+     * @param resource Resource to decode into, or nullptr for the global allocator
+     */
+    void set_event_memory_resource(std::pmr::memory_resource* resource);
+    
+    /**
+     * @brief Correct signing timestamps with an estimate of the exchange clock
+     * 
+     * See RestClient::enable_server_clock(). The offset, its uncertainty and
+     * the skew are exported as backpack_server_clock_* metrics.
+     * 
+     * @param options Sampling interval, burst size, window and smoothing
+     * @throws std::runtime_error if already enabled
+     */
+    void enable_server_clock(ServerClockEstimator::Options options = {});
+    
+    /**
+     * @brief Server clock estimator, or nullptr if not enabled
+     */
+    ServerClockEstimator* server_clock();
+    
+    /**
+     * @brief Detect missing trade ids and fetch them over REST
+     * 
+     * Trades from subscribe_trades() (and trades() streams) then pass through
+     * a TradeSequencer: each symbol's handler sees consecutive ids, with
+     * trades lost to lag or a reconnect fetched from
+     * GET /api/v1/historicalTrades and delivered before the live trades that
+     * followed them. Recovered trades, and live ones held while fetching,
+     * are delivered from the sequencer's thread. Counts are exported as
+     * backpack_trade_* metrics. Call once, after set_credentials() and
+     * set_ca_file(), and before subscribing.
+     * 
+     * @param options Largest gap to fetch, page size and trades held meanwhile
+     * @throws std::runtime_error if already enabled or a stream has a handler
+     */
+    void enable_trade_recovery(TradeSequencer::Options options = {});
+    
+    /**
+     * @brief Trade sequencer, or nullptr if not enabled
+     */
+    TradeSequencer* trade_sequencer();
+    
+    /**
+     * @brief Open REST connections ahead of the first order
+     * 
+     * @param connections Number of connections that should be open afterwards
+     * @return Number of new connections opened
+     */
+    size_t warm_up(size_t connections = 1);
+    
+    /**
+     * @brief Keep REST connections open so orders after an idle period go out warm
+     * 
+     * See RestClient::enable_keepalive(). Cold orders are exported as
+     * backpack_rest_cold_orders_total.
+     * 
+     * @param options Number of connections, ping interval and connection age limits
+     */
+    void enable_keepalive(KeepaliveOptions options = {});
+    
+    /**
+     * @brief Per-stage latency histograms
+     * 
+     * @return Tracer holding one HDR histogram per LatencyStage
+     */
+    LatencyTracer& latency_tracer();
+    
+    /**
+     * @brief Per-endpoint REST latency, size and status-code metrics
+     * 
+     * @return Metrics registry of the underlying REST client
+     */
+    RestMetrics& rest_metrics();
+    
+    /**
+     * @brief Registry holding the SDK's counters, gauges and summaries
+     * 
+     * Per-stream message counts, connects/disconnects, parse time and errors
+     * are recorded here, and REST and latency-tracer metrics are rendered
+     * into it on scrape. Applications may register their own metrics too.
+     * 
+     * @return Metrics registry
+     */
+    MetricsRegistry& metrics();
+    
+    /**
+     * @brief Serve metrics in Prometheus text format at http://address:port/metrics
+     * 
+     * @param port Port to listen on (0 picks a free port)
+     * @param address Address to bind (default: loopback only)
+     * @return Port the exporter is listening on
+     */
+    unsigned short start_metrics_exporter(unsigned short port, const std::string& address = "127.0.0.1");
+    
+    /**
+     * @brief Stop the metrics exporter if running
+     */
+    void stop_metrics_exporter();
+    
     // REST API endpoints
     
     /**
@@ -176,6 +530,11 @@ public:
      */
     int64_t get_server_time();
     
+    /**
+     * @brief Get server time without blocking; the callback runs from poll()
+     */
+    void get_server_time_async(AsyncCallback<int64_t> callback);
+    
     /**
      * @brief Get exchange information
      * 
@@ -247,6 +606,14 @@ public:
      */
     Order create_order(const OrderRequest& order);
     
+    /**
+     * @brief Create a new order without blocking; the callback runs from poll()
+     * 
+     * @param order Order to create
+     * @param callback Receives the created order or the error
+     */
+    void create_order_async(const OrderRequest& order, AsyncCallback<Order> callback);
+    
     /**
      * @brief Test order creation without actually placing it
      * 
@@ -264,6 +631,15 @@ public:
      */
     bool cancel_order(const std::string& symbol, const std::string& order_id);
     
+    /**
+     * @brief Cancel an order without blocking; the callback runs from poll()
+     * 
+     * @param symbol Trading pair (e.g., "SOL-USDC")
+     * @param order_id Order ID to cancel
+     * @param callback Receives true, or false with the error
+     */
+    void cancel_order_async(const std::string& symbol, const std::string& order_id, AsyncCallback<bool> callback);
+    
     /**
      * @brief Cancel an order by client order ID
      * 
@@ -343,24 +719,208 @@ public:
     std::vector<Trade> get_account_trades(const std::string& symbol, int limit = 100,
                                          const std::string& from_id = "");
 
+#ifdef BACKPACK_ENABLE_COROUTINES
+    // Coroutine API (C++20, BACKPACK_ENABLE_COROUTINES)
+    
+    /**
+     * @brief Get server time; co_await resumes from the poll() that completes it
+     */
+    AsyncOp<int64_t> get_server_time_async();
+    
+    /**
+     * @brief Create a new order; co_await resumes from the poll() that completes it
+     * 
+     * @param order Order to create
+     * @return Awaitable yielding the created order or throwing the error
+     */
+    AsyncOp<Order> create_order_async(const OrderRequest& order);
+    
+    /**
+     * @brief Cancel an order; co_await resumes from the poll() that completes it
+     * 
+     * @param symbol Trading pair (e.g., "SOL-USDC")
+     * @param order_id Order ID to cancel
+     * @return Awaitable yielding true if the order was cancelled
+     */
+    AsyncOp<bool> cancel_order_async(const std::string& symbol, const std::string& order_id);
+    
+    /**
+     * @brief Subscribe to ticker updates as a stream
+     * 
+     * Replaces any callback registered with subscribe_ticker() for the symbol.
+     * 
+     * @param symbol Trading pair (e.g., "SOL-USDC")
+     * @param capacity Events buffered while the consumer is busy
+     * @param overflow What to do when the buffer is full; by default the oldest ticker is dropped
+     * @return Stream to read with co_await stream.next()
+     */
+    EventStream<Ticker> tickers(const std::string& symbol,
+                                size_t capacity = EventStream<Ticker>::DEFAULT_CAPACITY,
+                                StreamOverflow overflow = StreamOverflow::DROP_OLDEST);
+    
+    /**
+     * @brief Subscribe to trade updates as a stream
+     * 
+     * Replaces any callback registered with subscribe_trades() for the symbol.
+     * 
+     * @param symbol Trading pair (e.g., "SOL-USDC")
+     * @param capacity Events buffered while the consumer is busy
+     * @param overflow What to do when the buffer is full; by default next() throws StreamOverflowError
+     * @return Stream to read with co_await stream.next()
+     */
+    EventStream<Trade> trades(const std::string& symbol,
+                              size_t capacity = EventStream<Trade>::DEFAULT_CAPACITY,
+                              StreamOverflow overflow = StreamOverflow::CLOSE);
+    
+    /**
+     * @brief Subscribe to order book updates as a stream
+     * 
+     * @param symbol Trading pair (e.g., "SOL-USDC")
+     * @param capacity Events buffered while the consumer is busy
+     * @param overflow What to do when the buffer is full; by default next() throws StreamOverflowError
+     * @return Stream to read with co_await stream.next()
+     */
+    EventStream<OrderBook> depth(const std::string& symbol,
+                                 size_t capacity = EventStream<OrderBook>::DEFAULT_CAPACITY,
+                                 StreamOverflow overflow = StreamOverflow::CLOSE);
+    
+    /**
+     * @brief Subscribe to the account's order updates as a stream (requires authentication)
+     * 
+     * @param capacity Events buffered while the consumer is busy
+     * @param overflow What to do when the buffer is full; by default next() throws StreamOverflowError
+     * @return Stream to read with co_await stream.next()
+     */
+    EventStream<Order> user_orders(size_t capacity = EventStream<Order>::DEFAULT_CAPACITY,
+                                   StreamOverflow overflow = StreamOverflow::CLOSE);
+#endif
+
 private:
+    // A table entry: one indirect call into a thunk instantiated for the binding's types
+    struct BoundHandler {
+        void (*invoke)(void* binding, const nlohmann::json& data);
+        std::shared_ptr<void> binding;
+        StreamWatchdog::Stream* watch = nullptr;
+        FeedLatencyMonitor::Stream* latency = nullptr;
+        
+        void operator()(const nlohmann::json& data) const { invoke(binding.get(), data); }
+    };
+    
+    // Decoder state plus the user's handler, shared so table copies and handed-off events stay cheap
+    template<typename T, typename Handler>
+    struct Binding : std::enable_shared_from_this<Binding<T, Handler>> {
+        Binding(BackpackClient* client, Counter* messages, ShardedExecutor::Shard* shard, Handler handler)
+            : client(client), messages(messages), shard(shard), handler(std::move(handler)) {}
+        
+        static void invoke(void* binding, const nlohmann::json& data) {
+            static_cast<Binding*>(binding)->dispatch(data);
+        }
+        
+        void dispatch(const nlohmann::json& data);
+        
+        BackpackClient* client;
+        Counter* messages;
+        ShardedExecutor::Shard* shard;
+        Handler handler;
+    };
+    
+    // pmr event types decode into resource; the others ignore it
+    template<typename T>
+    static T decode(const nlohmann::json& data, std::pmr::memory_resource* resource) {
+        if constexpr (decodes_into_resource<T>::value) {
+            return T::from_json(data, resource);
+        } else {
+            return T::from_json(data);
+        }
+    }
+    
+    Counter& stream_messages(const std::string& key);
+    ShardedExecutor::Shard* stream_shard(const std::string& channel, const std::string& symbol);
+    bool add_handler(const std::string& channel, const std::string& symbol, BoundHandler handler);
+    void dispatch_data(std::string_view key, const nlohmann::json& data, int64_t receive_ns);
+    void flush_subscriptions();
+    void on_timer();
+    void require_no_handlers(const char* method) const;
+    static void log_handler_error(const std::exception& e);
+    
+#ifdef BACKPACK_ENABLE_COROUTINES
     template<typename T>
-    bool subscribe_to_channel(Channel channel, const std::string& symbol, std::function<void(const T&)> callback) {
-        // Implementation in source file
-        return false;
+    EventStream<T> open_stream(Channel channel, const std::string& symbol, size_t capacity,
+                               StreamOverflow overflow);
+#endif
+    void register_metric_collectors();
+    std::pmr::memory_resource* event_resource() const {
+        return event_resource_ ? event_resource_ : std::pmr::get_default_resource();
     }
 
-    std::unique_ptr<WebSocketClient> ws_client_;
-    std::unique_ptr<RestClient> rest_client_;
     std::string websocket_url_;
     std::string rest_url_;
+    std::unique_ptr<WebSocketClient> ws_client_;
+    std::unique_ptr<RestClient> rest_client_;
+    std::unique_ptr<ShardedExecutor> executor_;
+    std::unique_ptr<StreamWatchdog> watchdog_;
+    std::unique_ptr<FeedLatencyMonitor> feed_latency_;
+    std::shared_ptr<LatencyTracer> latency_tracer_;
+    std::unique_ptr<FrameArena> frame_arena_;
+    std::pmr::memory_resource* event_resource_ = nullptr;
     std::string api_key_;
     std::string api_secret_;
     bool connected_ = false;
     bool authenticated_ = false;
     std::mutex mutex_;
     
-    std::map<std::string, std::function<void(const nlohmann::json&)>> message_handlers_;
+    // Transparent comparator so dispatch can look up by string_view without building a std::string
+    using HandlerMap = std::map<std::string, BoundHandler, std::less<>>;
+    
+    // Dispatch reads without locking; subscribe, unsubscribe and disconnect publish new versions
+    RcuCell<HandlerMap> message_handlers_;
+    
+    // Streams wanted by the handlers above, batched into SUBSCRIBE/UNSUBSCRIBE frames
+    std::unique_ptr<SubscriptionManager> subscriptions_;
+    std::atomic<int> subscription_batches_{0};
+    
+    std::shared_ptr<MetricsRegistry> metrics_;
+    Counter* ws_connects_;
+    Counter* ws_disconnects_;
+    Counter* parse_errors_;
+    Gauge* ws_connected_;
+    Gauge* ws_subscriptions_;
+    Counter* stream_resubscribes_;
+    HdrHistogram* parse_time_ns_;
+    std::unique_ptr<MetricsExporter> metrics_exporter_;
 };
 
+template<typename T, typename Handler>
+bool BackpackClient::subscribe(Channel channel, const std::string& symbol, Handler&& handler) {
+    using Bound = Binding<T, std::decay_t<Handler>>;
+    std::string channel_str = channel_to_string(channel);
+    auto binding = std::make_shared<Bound>(this, &stream_messages(channel_str + ":" + symbol),
+                                           stream_shard(channel_str, symbol), std::forward<Handler>(handler));
+    return add_handler(channel_str, symbol, BoundHandler{&Bound::invoke, std::move(binding)});
+}
+
+template<typename T, typename Handler>
+void BackpackClient::Binding<T, Handler>::dispatch(const nlohmann::json& data) {
+    messages->inc();
+    try {
+        if (shard) {
+            // The event outlives this frame, so it cannot come from the arena
+            T event = decode<T>(data, std::pmr::get_default_resource());
+            // Carry the frame's trace to the worker so the handler's stages still count from the socket read
+            client->executor_->post(shard, [self = this->shared_from_this(), event = std::move(event),
+                                            origin = LatencyTracer::current()]() {
+                LatencyTracer::Scope trace(origin);
+                LatencyTracer::mark(LatencyStage::HANDLER_ENTRY);
+                self->handler(event);
+            });
+            return;
+        }
+        T event = decode<T>(data, client->event_resource());
+        LatencyTracer::mark(LatencyStage::HANDLER_ENTRY);
+        handler(static_cast<const T&>(event));
+    } catch (const std::exception& e) {
+        log_handler_error(e);
+    }
+}
+
 } // namespace backpack
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BACKPACK_HAS_TSC 1
+#endif
+
+namespace backpack {
+
+/**
+ * @brief Process-wide nanosecond clock backed by the CPU timestamp counter
+ *
+ * Disabled by default, in which case now_ns() and wall_ns() simply read
+ * steady_clock and system_clock. enable() calibrates the TSC against
+ * steady_clock; from then on a read is one rdtsc plus a multiply-add instead
+ * of a clock_gettime call. Every reanchor interval the first reader to notice
+ * re-anchors wall time to system_clock and refines the tick rate over the
+ * whole interval since calibration, so wall_ns() follows NTP adjustments and
+ * now_ns() stays monotonic.
+ *
+ * Requires an invariant TSC (constant rate, synchronized across cores);
+ * enable() refuses to switch on without one. All functions are thread-safe.
+ */
+class TscClock {
+public:
+    /**
+     * @brief Whether this CPU has an invariant TSC
+     */
+    static bool supported();
+
+    /**
+     * @brief Calibrate and switch to the TSC
+     *
+     * Blocks for the calibration period. Calling it again recalibrates.
+     *
+     * @param calibration How long to measure the tick rate (default: 20 ms)
+     * @param reanchor_interval How often to re-anchor to wall time (default: 1 s)
+     * @return false if the TSC is not usable, leaving the clock on std::chrono
+     */
+    static bool enable(std::chrono::milliseconds calibration = std::chrono::milliseconds(20),
+                       std::chrono::milliseconds reanchor_interval = std::chrono::seconds(1));
+
+    /**
+     * @brief Go back to std::chrono clocks
+     */
+    static void disable();
+
+    static bool enabled() { return state_.enabled.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Monotonic nanoseconds (steady_clock epoch when enabled from the start)
+     */
+    static int64_t now_ns() {
+#ifdef BACKPACK_HAS_TSC
+        if (enabled()) {
+            uint64_t tsc = __rdtsc();
+            Anchor anchor = load_anchor();
+            if (tsc - anchor.tsc > anchor.reanchor_ticks) {
+                maybe_reanchor();
+            }
+            return anchor.mono_ns + static_cast<int64_t>(static_cast<double>(tsc - anchor.tsc) * anchor.ns_per_tick);
+        }
+#endif
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    /**
+     * @brief Wall-clock nanoseconds since the Unix epoch
+     */
+    static int64_t wall_ns() {
+#ifdef BACKPACK_HAS_TSC
+        if (enabled()) {
+            uint64_t tsc = __rdtsc();
+            Anchor anchor = load_anchor();
+            if (tsc - anchor.tsc > anchor.reanchor_ticks) {
+                maybe_reanchor();
+            }
+            return anchor.wall_ns + static_cast<int64_t>(static_cast<double>(tsc - anchor.tsc) * anchor.ns_per_tick);
+        }
+#endif
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    /**
+     * @brief Wall-clock milliseconds since the Unix epoch
+     */
+    static int64_t wall_ms() { return wall_ns() / 1000000; }
+
+    /**
+     * @brief Calibrated TSC rate in ticks per second, or 0 when disabled
+     */
+    static double tsc_hz();
+
+    /**
+     * @brief Re-anchor to wall time now instead of waiting for the interval
+     */
+    static void reanchor();
+
+private:
+    // Snapshot of the TSC-to-time mapping
+    struct Anchor {
+        uint64_t tsc;
+        int64_t mono_ns;
+        int64_t wall_ns;
+        double ns_per_tick;
+        uint64_t reanchor_ticks;
+    };
+
+    // The mapping is published under a seqlock so readers never block
+    struct State {
+        std::atomic<bool> enabled{false};
+        std::atomic<uint64_t> sequence{0};
+        std::atomic<uint64_t> tsc{0};
+        std::atomic<int64_t> mono_ns{0};
+        std::atomic<int64_t> wall_ns{0};
+        std::atomic<double> ns_per_tick{0.0};
+        std::atomic<uint64_t> reanchor_ticks{0};
+        // Calibration origin, used to refine the rate over ever longer baselines
+        uint64_t origin_tsc = 0;
+        int64_t origin_steady_ns = 0;
+    };
+
+    static Anchor load_anchor() {
+        Anchor anchor;
+        uint64_t before;
+        uint64_t after;
+        do {
+            before = state_.sequence.load(std::memory_order_acquire);
+            anchor.tsc = state_.tsc.load(std::memory_order_relaxed);
+            anchor.mono_ns = state_.mono_ns.load(std::memory_order_relaxed);
+            anchor.wall_ns = state_.wall_ns.load(std::memory_order_relaxed);
+            anchor.ns_per_tick = state_.ns_per_tick.load(std::memory_order_relaxed);
+            anchor.reanchor_ticks = state_.reanchor_ticks.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            after = state_.sequence.load(std::memory_order_relaxed);
+        } while (before != after || (before & 1));
+        return anchor;
+    }
+
+    static void maybe_reanchor();
+    static void reanchor_locked();
+
+    static State state_;
+};
+
+} // namespace backpack
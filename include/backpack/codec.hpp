@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace backpack {
+namespace codec {
+
+/*
+ * Base64 (RFC 4648, padded), lowercase hex and URL (RFC 3986 percent)
+ * encoding into caller-provided buffers. Base64 and hex use SSSE3 when the
+ * CPU supports it (checked once at runtime) and fall back to table-driven
+ * scalar code otherwise; both paths produce identical output. Decoders throw
+ * std::invalid_argument on malformed input.
+ */
+
+/**
+ * @brief Output size of base64_encode for len input bytes
+ */
+constexpr size_t base64_encoded_size(size_t len) {
+    return (len + 2) / 3 * 4;
+}
+
+/**
+ * @brief Upper bound on the output size of base64_decode for len input characters
+ */
+constexpr size_t base64_decoded_max_size(size_t len) {
+    return (len + 3) / 4 * 3;
+}
+
+/**
+ * @brief Base64 encode with padding
+ *
+ * @param in Input bytes
+ * @param len Number of input bytes
+ * @param out Destination with room for base64_encoded_size(len) characters; not NUL-terminated
+ * @return Number of characters written
+ */
+size_t base64_encode(const void* in, size_t len, char* out);
+
+/**
+ * @brief Base64 decode; padding is optional, whitespace is not accepted
+ *
+ * @param in Input characters
+ * @param len Number of input characters
+ * @param out Destination with room for base64_decoded_max_size(len) bytes
+ * @return Number of bytes written
+ */
+size_t base64_decode(const char* in, size_t len, unsigned char* out);
+
+/**
+ * @brief Lowercase hex encode; writes exactly 2 * len characters
+ */
+size_t hex_encode(const void* in, size_t len, char* out);
+
+/**
+ * @brief Hex decode (either case); len must be even, writes len / 2 bytes
+ */
+size_t hex_decode(const char* in, size_t len, unsigned char* out);
+
+/**
+ * @brief Percent-encode everything except RFC 3986 unreserved characters
+ *
+ * @param out Destination with room for 3 * len characters
+ * @return Number of characters written
+ */
+size_t url_encode(const char* in, size_t len, char* out);
+
+/**
+ * @brief Append the percent-encoded form of in to out
+ */
+void url_encode_append(std::string_view in, std::string& out);
+
+inline std::string base64_encode(std::string_view in) {
+    std::string out(base64_encoded_size(in.size()), '\0');
+    base64_encode(in.data(), in.size(), &out[0]);
+    return out;
+}
+
+inline std::vector<unsigned char> base64_decode(std::string_view in) {
+    std::vector<unsigned char> out(base64_decoded_max_size(in.size()));
+    out.resize(base64_decode(in.data(), in.size(), out.data()));
+    return out;
+}
+
+inline std::string hex_encode(std::string_view in) {
+    std::string out(in.size() * 2, '\0');
+    hex_encode(in.data(), in.size(), &out[0]);
+    return out;
+}
+
+inline std::string url_encode(std::string_view in) {
+    std::string out;
+    url_encode_append(in, out);
+    return out;
+}
+
+} // namespace codec
+} // namespace backpack
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <curl/curl.h>
+
+#include "rest_engine.hpp"
+#include "rest_metrics.hpp"
+
+namespace backpack {
+
+/**
+ * @brief Keepalive settings for ConnectionPool
+ */
+struct KeepaliveOptions {
+    size_t connections = 2;                                               // Connections to keep open
+    std::chrono::milliseconds interval{std::chrono::seconds(15)};         // Time between keepalive rounds
+    std::chrono::seconds idle_timeout{std::chrono::seconds(60)};          // Never reuse a connection idle this long
+    std::chrono::seconds max_connection_age{std::chrono::seconds(0)};     // Retire connections this old (0: no limit)
+    std::string path = "/api/v1/time";                                    // Cheap endpoint to hit
+};
+
+/**
+ * @brief A RestClient's connection cache, with warm-up and keepalive
+ *
+ * Every request the client sends, blocking or asynchronous, runs on the
+ * pool's curl multi handle, so connections live in that multi's cache and
+ * a connection opened by warm_up() or the keepalive thread is the one the
+ * client's next order picks up. Only DNS results and TLS sessions are shared
+ * with other clients, through the RestEngine; connections are never shared
+ * between threads.
+ *
+ * Keepalive rounds send one cheap request per connection, concurrently and
+ * without multiplexing, which touches every idle connection before the
+ * server's idle timeout and replaces any the server has closed or that
+ * reached max_connection_age, so an order after a quiet period does not pay
+ * for the handshake. The keepalive thread and the client's thread take
+ * turns on the multi handle; the client's thread always goes first.
+ */
+class ConnectionPool {
+public:
+    /**
+     * @brief Construct a new ConnectionPool object
+     *
+     * @param base_url Base API URL the connections go to
+     * @param engine Engine sharing DNS results and TLS sessions
+     * @param stats Counters to record warm-up and keepalive requests into
+     */
+    ConnectionPool(std::string base_url, std::shared_ptr<RestEngine> engine, ConnectionStats& stats);
+
+    /**
+     * @brief Stop the keepalive thread
+     */
+    ~ConnectionPool();
+
+    ConnectionPool(const ConnectionPool&) = delete;
+    ConnectionPool& operator=(const ConnectionPool&) = delete;
+
+    /**
+     * @brief Verify the pool's own requests against a PEM CA bundle instead of the system one
+     */
+    void set_ca_file(const std::string& path);
+
+    /**
+     * @brief Make a handle use the shared caches and connection limits; call after every curl_easy_reset
+     */
+    void attach(CURL* handle) const;
+
+    /**
+     * @brief Run a transfer on the pool's connections and wait for it
+     */
+    CURLcode perform(CURL* handle);
+
+    /**
+     * @brief Start a transfer on the pool's connections; collect() reports when it is done
+     */
+    void start(CURL* handle);
+
+    /**
+     * @brief Advance every transfer without blocking
+     *
+     * @param done Receives each finished start() transfer, which is no longer in the pool
+     */
+    void collect(std::vector<std::pair<CURL*, CURLcode>>& done);
+
+    /**
+     * @brief Abandon a start() transfer that has not finished
+     */
+    void remove(CURL* handle);
+
+    /**
+     * @brief Open connections ahead of time
+     *
+     * @param connections Number of connections that should be open afterwards
+     * @return Number of new connections opened
+     */
+    size_t warm_up(size_t connections);
+
+    /**
+     * @brief Keep connections open from a background thread
+     *
+     * Restarts the thread if already running.
+     */
+    void start_keepalive(KeepaliveOptions options);
+
+    /**
+     * @brief Stop and join the keepalive thread
+     */
+    void stop_keepalive();
+
+private:
+    /**
+     * @brief Lock the multi handle, interrupting the keepalive thread if it is waiting on it
+     */
+    std::unique_lock<std::mutex> lock_transfers();
+
+    /**
+     * @brief Advance every transfer and move finished ones to finished_; requires transfer_mutex_
+     */
+    CURLMcode drive();
+
+    void run_keepalive();
+
+    /**
+     * @brief Send count requests in parallel, each on its own connection
+     *
+     * @return Number of new connections opened
+     */
+    size_t run_batch(size_t count, std::atomic<uint64_t>& requests);
+
+    std::string base_url_;
+    std::string ca_file_;
+    std::shared_ptr<RestEngine> engine_;
+    ConnectionStats& stats_;
+    KeepaliveOptions options_;
+
+    // The connection cache; transfer_mutex_ guards it, finished_ and batch_
+    CURLM* multi_;
+    std::mutex transfer_mutex_;
+    std::atomic<int> waiters_{0};                // Client calls waiting for transfer_mutex_
+    std::map<CURL*, CURLcode> finished_;         // Finished transfers nobody has picked up yet
+    std::vector<CURL*> batch_;                   // The warm-up or keepalive round in flight
+
+    std::thread thread_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool running_ = false;
+};
+
+} // namespace backpack
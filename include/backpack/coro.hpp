@@ -0,0 +1,414 @@
+#pragma once
+
+#if !defined(__cpp_impl_coroutine)
+#error "backpack/coro.hpp needs C++20 coroutines; configure with -DBACKPACK_ENABLE_COROUTINES=ON"
+#endif
+
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "rest_client.hpp"
+
+namespace backpack {
+
+template<typename T = void>
+class Task;
+
+namespace detail {
+
+template<typename T>
+struct TaskPromiseBase {
+    struct FinalAwaiter {
+        bool await_ready() noexcept { return false; }
+
+        template<typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+            std::coroutine_handle<> continuation = handle.promise().continuation;
+            return continuation ? continuation : std::noop_coroutine();
+        }
+
+        void await_resume() noexcept {}
+    };
+
+    Task<T> get_return_object() noexcept;
+    std::suspend_always initial_suspend() noexcept { return {}; }
+    FinalAwaiter final_suspend() noexcept { return {}; }
+    void unhandled_exception() noexcept { error = std::current_exception(); }
+
+    std::coroutine_handle<> continuation;
+    std::exception_ptr error;
+};
+
+template<typename T>
+struct TaskPromise : TaskPromiseBase<T> {
+    template<typename U>
+    void return_value(U&& value) { result.emplace(std::forward<U>(value)); }
+
+    T take() {
+        if (this->error) {
+            std::rethrow_exception(this->error);
+        }
+        return std::move(*result);
+    }
+
+    std::optional<T> result;
+};
+
+template<>
+struct TaskPromise<void> : TaskPromiseBase<void> {
+    void return_void() noexcept {}
+
+    void take() {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+};
+
+} // namespace detail
+
+/**
+ * @brief Lazily started coroutine returning T
+ *
+ * The body runs when the task is first awaited, on the awaiting thread, and
+ * the awaiting coroutine continues on whichever thread the task finishes
+ * on. Exceptions propagate to the awaiter. Use spawn() to start a top-level
+ * task.
+ */
+template<typename T>
+class [[nodiscard]] Task {
+public:
+    using promise_type = detail::TaskPromise<T>;
+    using handle_type = std::coroutine_handle<promise_type>;
+
+    explicit Task(handle_type handle) noexcept : handle_(handle) {}
+    Task(Task&& other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            if (handle_) {
+                handle_.destroy();
+            }
+            handle_ = std::exchange(other.handle_, {});
+        }
+        return *this;
+    }
+    ~Task() {
+        if (handle_) {
+            handle_.destroy();
+        }
+    }
+
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    auto operator co_await() && noexcept {
+        struct Awaiter {
+            handle_type handle;
+
+            bool await_ready() const noexcept { return handle.done(); }
+
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+                handle.promise().continuation = awaiting;
+                return handle;
+            }
+
+            T await_resume() { return handle.promise().take(); }
+        };
+        return Awaiter{handle_};
+    }
+
+private:
+    handle_type handle_;
+};
+
+template<typename T>
+Task<T> detail::TaskPromiseBase<T>::get_return_object() noexcept {
+    return Task<T>(Task<T>::handle_type::from_promise(static_cast<TaskPromise<T>&>(*this)));
+}
+
+namespace detail {
+
+// Self-destroying frame that owns a spawned task
+struct Detached {
+    struct promise_type {
+        Detached get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept {
+            try {
+                throw;
+            } catch (const std::exception& e) {
+                std::cerr << "Unhandled exception in spawned task: " << e.what() << std::endl;
+            } catch (...) {
+                std::cerr << "Unhandled exception in spawned task" << std::endl;
+            }
+        }
+    };
+};
+
+inline Detached run_detached(Task<void> task) {
+    co_await std::move(task);
+}
+
+} // namespace detail
+
+/**
+ * @brief Start a task without awaiting it
+ *
+ * Runs on the calling thread up to its first suspension. The frame frees
+ * itself when the task finishes; an escaping exception is logged.
+ */
+inline void spawn(Task<void> task) {
+    detail::run_detached(std::move(task));
+}
+
+/**
+ * @brief Awaitable wrapper around one of the *_async REST calls
+ *
+ * The request is sent when the operation is awaited, and the awaiting
+ * coroutine resumes inside the poll() call that completes it. Failures are
+ * rethrown from co_await, as the blocking call would have thrown them.
+ */
+template<typename T>
+class [[nodiscard]] AsyncOp {
+public:
+    using Initiator = std::function<void(AsyncCallback<T>)>;
+
+    explicit AsyncOp(Initiator initiate) : initiate_(std::move(initiate)) {}
+
+    bool await_ready() const noexcept { return false; }
+
+    bool await_suspend(std::coroutine_handle<> awaiting) {
+        awaiting_ = awaiting;
+        Initiator initiate = std::move(initiate_);
+        initiate([this](T result, std::exception_ptr error) {
+            if (error) {
+                error_ = error;
+            } else {
+                result_.emplace(std::move(result));
+            }
+            // Whichever of the callback and await_suspend finishes second resumes
+            if (done_.exchange(true, std::memory_order_acq_rel)) {
+                awaiting_.resume();
+            }
+        });
+        return !done_.exchange(true, std::memory_order_acq_rel);
+    }
+
+    T await_resume() {
+        if (error_) {
+            std::rethrow_exception(error_);
+        }
+        return std::move(*result_);
+    }
+
+private:
+    Initiator initiate_;
+    std::coroutine_handle<> awaiting_;
+    std::optional<T> result_;
+    std::exception_ptr error_;
+    std::atomic<bool> done_{false};
+};
+
+/**
+ * @brief What an EventStream does when its queue is full
+ */
+enum class StreamOverflow {
+    DROP_OLDEST,  // Discard the oldest queued event; for snapshots such as tickers
+    CLOSE         // End the stream with StreamOverflowError; for feeds where a lost event corrupts state
+};
+
+/**
+ * @brief Thrown from EventStream::next() after a StreamOverflow::CLOSE stream overflowed
+ */
+class StreamOverflowError : public std::runtime_error {
+public:
+    explicit StreamOverflowError(size_t capacity)
+        : std::runtime_error("Event stream overflowed its capacity of " + std::to_string(capacity)) {}
+};
+
+/**
+ * @brief Subscription read with co_await
+ *
+ * Events are copied out of the handler into a bounded queue. A coroutine
+ * waiting in next() is resumed directly from the handler, on the thread
+ * that read the frame, so no thread hop is needed per event. When the
+ * consumer falls behind, the overflow policy decides: DROP_OLDEST discards
+ * the oldest queued event and counts it, while CLOSE stops accepting
+ * events, and next() throws StreamOverflowError once the queued ones have
+ * been read, so the reader knows to resynchronize.
+ *
+ * @code
+ * auto trades = client.trades("SOL-USDC");
+ * while (auto trade = co_await trades.next()) { ... }
+ * @endcode
+ */
+template<typename T>
+class EventStream {
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 4096;
+
+    explicit EventStream(size_t capacity = DEFAULT_CAPACITY, StreamOverflow overflow = StreamOverflow::DROP_OLDEST)
+        : state_(std::make_shared<State>()) {
+        state_->capacity = capacity > 0 ? capacity : 1;
+        state_->overflow = overflow;
+    }
+
+    EventStream(EventStream&&) noexcept = default;
+    EventStream& operator=(EventStream&&) noexcept = default;
+
+    /**
+     * @brief Stop delivering events
+     *
+     * A coroutine still waiting in next() is not resumed; its frame is
+     * normally the one being destroyed.
+     */
+    ~EventStream() {
+        if (state_) {
+            state_->close(false);
+        }
+    }
+
+    /**
+     * @brief Await the next event, or std::nullopt once the stream is closed
+     *
+     * @throws StreamOverflowError once a CLOSE stream that overflowed has been drained
+     */
+    auto next() {
+        struct Awaiter {
+            std::shared_ptr<State> state;
+            std::optional<T> event;
+            bool overflowed = false;
+
+            bool await_ready() const noexcept { return false; }
+
+            bool await_suspend(std::coroutine_handle<> awaiting) {
+                // Held locally: a push on another thread may resume and destroy us before we return
+                std::shared_ptr<State> keep = state;
+                std::lock_guard<std::mutex> lock(keep->mutex);
+                if (!keep->queue.empty()) {
+                    event.emplace(std::move(keep->queue.front()));
+                    keep->queue.pop_front();
+                    return false;
+                }
+                if (keep->closed) {
+                    overflowed = keep->overflowed;
+                    return false;
+                }
+                keep->waiter = awaiting;
+                keep->slot = &event;
+                return true;
+            }
+
+            std::optional<T> await_resume() {
+                if (overflowed) {
+                    throw StreamOverflowError(state->capacity);
+                }
+                return std::move(event);
+            }
+        };
+        return Awaiter{state_, std::nullopt};
+    }
+
+    /**
+     * @brief Deliver an event; called from the subscription handler
+     */
+    void push(const T& event) { state_->push(event); }
+
+    /**
+     * @brief Handler that feeds this stream, safe to outlive it
+     */
+    std::function<void(const T&)> handler() const {
+        return [state = state_](const T& event) { state->push(event); };
+    }
+
+    /**
+     * @brief End the stream and wake a pending next()
+     */
+    void close() { state_->close(true); }
+
+    /**
+     * @brief Events discarded because the queue was full
+     */
+    uint64_t dropped() const {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        return state_->dropped;
+    }
+
+    /**
+     * @brief Whether a CLOSE stream was closed because the queue was full
+     */
+    bool overflowed() const {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        return state_->overflowed;
+    }
+
+private:
+    struct State {
+        void push(const T& event) {
+            std::unique_lock<std::mutex> lock(mutex);
+            if (closed) {
+                return;
+            }
+            if (waiter) {
+                slot->emplace(event);
+                std::coroutine_handle<> resume = std::exchange(waiter, {});
+                lock.unlock();
+                resume.resume();
+                return;
+            }
+            if (queue.size() >= capacity) {
+                ++dropped;
+                if (overflow == StreamOverflow::CLOSE) {
+                    // Keep what is queued; next() throws once it has been read
+                    closed = true;
+                    overflowed = true;
+                    return;
+                }
+                queue.pop_front();
+            }
+            queue.push_back(event);
+        }
+
+        void close(bool wake) {
+            std::unique_lock<std::mutex> lock(mutex);
+            if (closed) {
+                return;
+            }
+            closed = true;
+            queue.clear();
+            std::coroutine_handle<> resume = std::exchange(waiter, {});
+            lock.unlock();
+            if (resume && wake) {
+                resume.resume();
+            }
+        }
+
+        std::mutex mutex;
+        std::deque<T> queue;
+        std::coroutine_handle<> waiter;
+        std::optional<T>* slot = nullptr;
+        size_t capacity = DEFAULT_CAPACITY;
+        StreamOverflow overflow = StreamOverflow::DROP_OLDEST;
+        uint64_t dropped = 0;
+        bool closed = false;
+        bool overflowed = false;
+    };
+
+    std::shared_ptr<State> state_;
+};
+
+} // namespace backpack
@@ -0,0 +1,173 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+#include "histogram.hpp"
+
+namespace backpack {
+
+/**
+ * @brief Percentiles of exchange-to-receive latency
+ */
+struct LatencyPercentiles {
+    uint64_t count = 0;
+    std::chrono::microseconds p50{0};
+    std::chrono::microseconds p90{0};
+    std::chrono::microseconds p99{0};
+    std::chrono::microseconds max{0};
+};
+
+/**
+ * @brief One stream's latency, as reported by FeedLatencyMonitor::snapshot()
+ */
+struct StreamLatency {
+    std::string channel;
+    std::string symbol;
+    LatencyPercentiles latency;
+};
+
+/**
+ * @brief Latency of the current connection and its streams
+ */
+struct FeedLatencySnapshot {
+    std::string connection;               // Options::connection
+    uint64_t connects = 0;                // Connections opened; percentiles cover the latest one
+    bool corrected = false;               // Whether the exchange clock offset was applied
+    int64_t offset_ns = 0;                // Offset applied, exchange minus local
+    uint64_t untimed = 0;                 // Messages without a usable exchange timestamp
+    uint64_t negative = 0;                // Messages received before their exchange time; recorded as 0
+    LatencyPercentiles latency;           // Every stream on the connection
+    std::vector<StreamLatency> streams;
+};
+
+/**
+ * @brief Measures how far behind the exchange each feed message arrives
+ *
+ * Each message's exchange time ("E" in microseconds, else its "timestamp")
+ * is subtracted from the local wall time at which its frame was read,
+ * shifted by the estimated exchange clock offset, so the result is
+ * transport and queueing delay rather than clock disagreement. Without an
+ * offset the raw difference is recorded and snapshot().corrected is false.
+ *
+ * Latencies go into an HDR histogram per stream and one for the whole
+ * connection; both restart on every new connection, so a degraded
+ * connection or region shows up in its own percentiles instead of being
+ * averaged into history. Label each client's monitor with its connection
+ * (e.g. the region or edge it connects to) to compare them side by side.
+ *
+ * record() is lock-free and runs on the read thread; the clock offset is
+ * re-read from the source at most once per offset_refresh.
+ */
+class FeedLatencyMonitor {
+public:
+    /**
+     * @brief Store the exchange minus local clock offset in ns; false if not measured yet
+     */
+    using OffsetSource = std::function<bool(int64_t& offset_ns)>;
+
+    struct Options {
+        std::string connection;                               // Label for this connection, e.g. a region
+        std::chrono::milliseconds offset_refresh{1000};       // How often the clock offset is re-read
+        std::chrono::seconds max_latency{60};                 // Larger latencies are clamped
+    };
+
+    /**
+     * @brief A measured stream; pointers stay valid for the monitor's lifetime
+     */
+    class Stream {
+    private:
+        friend class FeedLatencyMonitor;
+
+        Stream(std::string channel, std::string symbol, int64_t max_latency_us)
+            : channel(std::move(channel)), symbol(std::move(symbol)), histogram(max_latency_us) {}
+
+        const std::string channel;
+        const std::string symbol;
+        HdrHistogram histogram;  // Microseconds
+        bool tracked = true;     // Guarded by the monitor's mutex
+    };
+
+    FeedLatencyMonitor(OffsetSource source, Options options);
+
+    FeedLatencyMonitor(const FeedLatencyMonitor&) = delete;
+    FeedLatencyMonitor& operator=(const FeedLatencyMonitor&) = delete;
+
+    /**
+     * @brief Exchange time of a message payload in ns since the epoch, or 0 if it has none
+     */
+    static int64_t event_time_ns(const nlohmann::json& data);
+
+    /**
+     * @brief Start measuring a stream, or measure it again from scratch
+     */
+    Stream* track(const std::string& channel, const std::string& symbol);
+
+    /**
+     * @brief Stop reporting a stream; its Stream* stays valid, and track() reuses it
+     */
+    void untrack(const std::string& channel, const std::string& symbol);
+
+    /**
+     * @brief Stop reporting every stream
+     */
+    void untrack_all();
+
+    /**
+     * @brief Start a new connection: clear every histogram and re-read the clock offset
+     */
+    void on_connected();
+
+    /**
+     * @brief Record one message
+     *
+     * @param stream Stream from track()
+     * @param data Message payload carrying the exchange time
+     * @param receive_ns Local wall time the frame was read, ns since the epoch
+     */
+    void record(Stream* stream, const nlohmann::json& data, int64_t receive_ns);
+
+    const Options& options() const { return options_; }
+
+    /**
+     * @brief Latency of the whole connection, in microseconds
+     */
+    const HdrHistogram& histogram() const { return *connection_histogram_; }
+
+    /**
+     * @brief Call fn(channel, symbol, histogram) for every tracked stream; histograms are in microseconds
+     */
+    void for_each_stream(const std::function<void(const std::string&, const std::string&,
+                                                  const HdrHistogram&)>& fn) const;
+
+    FeedLatencySnapshot snapshot() const;
+
+private:
+    void refresh_offset(int64_t now_ns);
+
+    OffsetSource source_;
+    Options options_;
+    int64_t max_latency_us_;
+    std::unique_ptr<HdrHistogram> connection_histogram_;
+
+    mutable std::mutex mutex_;
+    std::map<std::string, std::unique_ptr<Stream>> streams_;  // By "channel:symbol"
+
+    // Written by the read thread, and by on_connected() before reads start
+    std::atomic<int64_t> offset_ns_{0};
+    std::atomic<bool> corrected_{false};
+    std::atomic<int64_t> offset_read_ns_{0};
+    std::atomic<uint64_t> connects_{0};
+    std::atomic<uint64_t> untimed_{0};
+    std::atomic<uint64_t> negative_{0};
+};
+
+} // namespace backpack
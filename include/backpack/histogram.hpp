@@ -0,0 +1,108 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+
+namespace backpack {
+
+/**
+ * @brief HDR (high dynamic range) histogram with lock-free recording
+ *
+ * Values are bucketed log-linearly so every recorded value keeps the
+ * requested number of significant decimal digits across the whole range.
+ * record() is wait-free apart from min/max updates and may be called
+ * concurrently from any thread; readers see a consistent-enough view for
+ * monitoring without stopping writers.
+ */
+class HdrHistogram {
+public:
+    /**
+     * @brief Construct a new HdrHistogram
+     *
+     * @param highest_trackable_value Largest value tracked; larger values are clamped (default: 1 hour in ns)
+     * @param significant_figures Decimal digits of precision kept, 1-3 (default: 2)
+     */
+    explicit HdrHistogram(int64_t highest_trackable_value = 3600LL * 1000 * 1000 * 1000,
+                          int significant_figures = 2);
+
+    HdrHistogram(const HdrHistogram&) = delete;
+    HdrHistogram& operator=(const HdrHistogram&) = delete;
+
+    /**
+     * @brief Record a value; negative values are recorded as zero
+     */
+    void record(int64_t value) {
+        if (value < 0) {
+            value = 0;
+        } else if (value > highest_trackable_value_) {
+            value = highest_trackable_value_;
+        }
+
+        counts_[counts_index(value)].fetch_add(1, std::memory_order_relaxed);
+        total_count_.fetch_add(1, std::memory_order_relaxed);
+        sum_.fetch_add(value, std::memory_order_relaxed);
+
+        int64_t current = min_.load(std::memory_order_relaxed);
+        while (value < current && !min_.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+        }
+        current = max_.load(std::memory_order_relaxed);
+        while (value > current && !max_.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+        }
+    }
+
+    uint64_t count() const { return total_count_.load(std::memory_order_relaxed); }
+    int64_t sum() const { return sum_.load(std::memory_order_relaxed); }
+    int64_t min() const;
+    int64_t max() const;
+    double mean() const;
+
+    /**
+     * @brief Value at the given percentile
+     *
+     * @param percentile Percentile in [0, 100]
+     * @return Highest value equivalent to the bucket holding the percentile, 0 when empty
+     */
+    int64_t value_at_percentile(double percentile) const;
+
+    /**
+     * @brief Reset all counts to zero
+     */
+    void reset();
+
+    /**
+     * @brief Write a one-line summary (count, mean, p50/p90/p99/p99.9, max)
+     *
+     * @param os Output stream
+     * @param name Label printed first
+     * @param scale Divisor applied to values (e.g. 1000 to print ns as us)
+     */
+    void print_summary(std::ostream& os, const std::string& name, double scale = 1.0) const;
+
+private:
+    size_t counts_index(int64_t value) const {
+        auto v = static_cast<uint64_t>(value);
+        int bucket_index = (63 - __builtin_clzll(v | sub_bucket_mask_)) - sub_bucket_half_count_magnitude_;
+        auto sub_bucket_index = static_cast<int64_t>(v >> bucket_index);
+        return (static_cast<size_t>(bucket_index + 1) << sub_bucket_half_count_magnitude_)
+            + static_cast<size_t>(sub_bucket_index - sub_bucket_half_count_);
+    }
+
+    int64_t highest_equivalent_value(size_t index) const;
+
+    int64_t highest_trackable_value_;
+    int sub_bucket_half_count_magnitude_;
+    int64_t sub_bucket_half_count_;
+    uint64_t sub_bucket_mask_;
+    size_t counts_len_;
+    std::unique_ptr<std::atomic<uint64_t>[]> counts_;
+
+    std::atomic<uint64_t> total_count_{0};
+    std::atomic<int64_t> sum_{0};
+    std::atomic<int64_t> min_;
+    std::atomic<int64_t> max_{0};
+};
+
+} // namespace backpack
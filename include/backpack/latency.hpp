@@ -0,0 +1,219 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+
+#include "clock.hpp"
+#include "histogram.hpp"
+
+namespace backpack {
+
+/**
+ * @brief Pipeline stages timed by LatencyTracer
+ *
+ * Every stage is measured from the origin of the trace: the socket read of
+ * the frame being handled, or create_order() entry for orders sent outside a
+ * message handler.
+ */
+enum class LatencyStage {
+    SOCKET_READ,    // Frame read and handed to the SDK
+    PARSE_DONE,     // Frame JSON parsed
+    HANDLER_ENTRY,  // Typed event decoded, user handler about to run
+    ORDER_ENCODE,   // Order request serialised
+    SIGN_DONE,      // Request signed
+    WRITE_COMPLETE, // Response received (the blocking call returned, or poll() collected the transfer)
+    COUNT
+};
+
+// Convert LatencyStage to string
+inline const char* latency_stage_to_string(LatencyStage stage) {
+    switch (stage) {
+        case LatencyStage::SOCKET_READ: return "socket_read";
+        case LatencyStage::PARSE_DONE: return "parse_done";
+        case LatencyStage::HANDLER_ENTRY: return "handler_entry";
+        case LatencyStage::ORDER_ENCODE: return "order_encode";
+        case LatencyStage::SIGN_DONE: return "sign_done";
+        case LatencyStage::WRITE_COMPLETE: return "write_complete";
+        default: return "unknown";
+    }
+}
+
+/**
+ * @brief Per-stage tick-to-trade latency histograms
+ *
+ * Tracing is off by default. When enabled, the WebSocket read loop opens a
+ * trace for each frame on the io thread, and every stage reached on that
+ * thread while the trace is open (including a create_order() issued from a
+ * message handler) records its offset from the socket read. With sharded
+ * dispatch the trace travels with the event to the worker thread.
+ */
+class LatencyTracer {
+public:
+    static constexpr size_t STAGE_COUNT = static_cast<size_t>(LatencyStage::COUNT);
+
+    LatencyTracer();
+
+    void set_enabled(bool enabled) { enabled_.store(enabled, std::memory_order_relaxed); }
+    bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Histogram of offsets (ns) from trace origin to the given stage
+     */
+    const HdrHistogram& histogram(LatencyStage stage) const {
+        return *histograms_[static_cast<size_t>(stage)];
+    }
+
+    /**
+     * @brief Clear all stage histograms
+     */
+    void reset();
+
+    /**
+     * @brief Print one summary line per stage, in microseconds
+     */
+    void dump(std::ostream& os) const;
+
+    /**
+     * @brief Monotonic timestamp used for all stage measurements (TSC when enabled)
+     */
+    static int64_t now_ns() {
+        return TscClock::now_ns();
+    }
+
+    /**
+     * @brief Record a stage for the trace open on the calling thread, if any
+     *
+     * Order stages are only recorded while an order is being sent, so REST
+     * queries made from a handler do not pollute them.
+     */
+    static void mark(LatencyStage stage) {
+        ActiveTrace& trace = active_trace();
+        record(trace.tracer, trace.origin_ns, trace.order, stage);
+    }
+
+    /**
+     * @brief The trace open on the calling thread, kept to mark stages after its Scope has closed
+     *
+     * For work that finishes on another call stack, such as an order sent
+     * with create_order_async() whose response is collected by poll(), or an
+     * event handed to a ShardedExecutor worker.
+     */
+    class Origin {
+    public:
+        /**
+         * @brief Record a stage against the trace this was taken from, if any
+         */
+        void mark(LatencyStage stage) const { record(tracer_, origin_ns_, order_, stage); }
+
+    private:
+        friend class LatencyTracer;
+        LatencyTracer* tracer_ = nullptr;
+        int64_t origin_ns_ = 0;
+        bool order_ = false;
+    };
+
+    /**
+     * @brief Capture the trace open on the calling thread (empty if none)
+     */
+    static Origin current() {
+        ActiveTrace& trace = active_trace();
+        Origin origin;
+        origin.tracer_ = trace.tracer;
+        origin.origin_ns_ = trace.origin_ns;
+        origin.order_ = trace.order;
+        return origin;
+    }
+
+    /**
+     * @brief RAII trace on the calling thread
+     *
+     * Opens a trace starting now if the tracer is enabled and no trace is
+     * already open on this thread, so an order sent from inside a message
+     * handler stays attributed to the frame that triggered it.
+     */
+    class Scope {
+    public:
+        /**
+         * @param tracer Tracer to record into; nullptr or disabled makes this a no-op
+         * @param order Whether this scope sends an order, enabling the order stages
+         */
+        explicit Scope(LatencyTracer* tracer, bool order = false) {
+            ActiveTrace& trace = active_trace();
+            if (!trace.tracer) {
+                if (!tracer || !tracer->enabled()) {
+                    return;
+                }
+                trace.tracer = tracer;
+                trace.origin_ns = now_ns();
+                owner_ = true;
+            }
+            if (order && !trace.order) {
+                trace.order = true;
+                order_owner_ = true;
+            }
+        }
+
+        ~Scope() {
+            ActiveTrace& trace = active_trace();
+            if (order_owner_) {
+                trace.order = false;
+            }
+            if (owner_) {
+                trace.tracer = nullptr;
+            }
+        }
+
+        /**
+         * @brief Continue a captured trace on the calling thread
+         *
+         * Stages marked inside, including an order sent from the handler,
+         * are measured from the captured origin. Does nothing if a trace is
+         * already open on this thread or the origin is empty.
+         */
+        explicit Scope(const Origin& origin) {
+            ActiveTrace& trace = active_trace();
+            if (trace.tracer || !origin.tracer_) {
+                return;
+            }
+            trace.tracer = origin.tracer_;
+            trace.origin_ns = origin.origin_ns_;
+            trace.order = origin.order_;
+            owner_ = true;
+            order_owner_ = origin.order_;
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        bool owner_ = false;
+        bool order_owner_ = false;
+    };
+
+private:
+    struct ActiveTrace {
+        LatencyTracer* tracer = nullptr;
+        int64_t origin_ns = 0;
+        bool order = false;
+    };
+
+    static void record(LatencyTracer* tracer, int64_t origin_ns, bool order, LatencyStage stage) {
+        if (tracer && (order || stage < LatencyStage::ORDER_ENCODE)) {
+            tracer->histograms_[static_cast<size_t>(stage)]->record(now_ns() - origin_ns);
+        }
+    }
+
+    static ActiveTrace& active_trace() {
+        static thread_local ActiveTrace trace;
+        return trace;
+    }
+
+    std::atomic<bool> enabled_{false};
+    std::array<std::unique_ptr<HdrHistogram>, STAGE_COUNT> histograms_;
+};
+
+} // namespace backpack
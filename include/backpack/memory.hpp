@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+
+namespace backpack {
+
+/**
+ * @brief Monotonic arena for objects that die together, e.g. everything decoded from one frame
+ *
+ * Allocation is a pointer bump into an owned buffer and deallocation is a
+ * no-op; reset() frees everything at once. If a frame outgrows the buffer the
+ * arena spills to the upstream resource, and the next reset() grows the
+ * buffer to cover it, so steady state never touches the global allocator.
+ *
+ * Not thread-safe: use one arena per thread.
+ */
+class FrameArena {
+public:
+    /**
+     * @brief Construct a new FrameArena
+     *
+     * @param initial_bytes Size of the inline buffer (default: 64 KiB)
+     * @param upstream Resource used for the buffer and for spills (default: new/delete)
+     */
+    explicit FrameArena(size_t initial_bytes = 64 * 1024,
+                        std::pmr::memory_resource* upstream = std::pmr::new_delete_resource());
+
+    ~FrameArena();
+
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    /**
+     * @brief Resource to pass to decoders and pmr containers
+     */
+    std::pmr::memory_resource* resource() { return &*arena_; }
+
+    /**
+     * @brief Release everything allocated since the last reset
+     *
+     * Anything still referring to arena memory dangles afterwards.
+     */
+    void reset();
+
+    /**
+     * @brief Current inline buffer size in bytes
+     */
+    size_t capacity() const { return capacity_; }
+
+    /**
+     * @brief Number of resets that had to grow the buffer after a spill
+     */
+    uint64_t grows() const { return grows_; }
+
+private:
+    // Forwards to the real upstream and counts bytes spilled past the inline buffer
+    class SpillCounter : public std::pmr::memory_resource {
+    public:
+        explicit SpillCounter(std::pmr::memory_resource* upstream) : upstream_(upstream) {}
+
+        std::pmr::memory_resource* upstream() const { return upstream_; }
+        size_t spilled = 0;
+
+    private:
+        void* do_allocate(size_t bytes, size_t alignment) override {
+            spilled += bytes;
+            return upstream_->allocate(bytes, alignment);
+        }
+        void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+            upstream_->deallocate(p, bytes, alignment);
+        }
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+            return this == &other;
+        }
+
+        std::pmr::memory_resource* upstream_;
+    };
+
+    void allocate_buffer();
+
+    SpillCounter spill_;
+    size_t capacity_;
+    std::byte* buffer_ = nullptr;
+    std::optional<std::pmr::monotonic_buffer_resource> arena_;
+    uint64_t grows_ = 0;
+};
+
+/**
+ * @brief Size-class pool for objects with mixed lifetimes inside a batch
+ *
+ * Freed blocks are recycled within the pool instead of going back to the
+ * global allocator, so frees never contend with other threads. reset()
+ * returns all memory to the upstream resource at the end of a batch.
+ *
+ * Not thread-safe: use one pool per thread, or std::pmr::synchronized_pool_resource
+ * when a pool must be shared.
+ */
+class EventPool {
+public:
+    /**
+     * @brief Construct a new EventPool
+     *
+     * @param largest_block Requests larger than this bypass the pools (default: 4 KiB)
+     * @param upstream Resource the pools carve their chunks from (default: new/delete)
+     */
+    explicit EventPool(size_t largest_block = 4096,
+                       std::pmr::memory_resource* upstream = std::pmr::new_delete_resource())
+        : pool_(std::pmr::pool_options{0, largest_block}, upstream) {}
+
+    EventPool(const EventPool&) = delete;
+    EventPool& operator=(const EventPool&) = delete;
+
+    std::pmr::memory_resource* resource() { return &pool_; }
+
+    /**
+     * @brief Release every block back to the upstream resource
+     */
+    void reset() { pool_.release(); }
+
+private:
+    std::pmr::unsynchronized_pool_resource pool_;
+};
+
+} // namespace backpack
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "histogram.hpp"
+
+namespace backpack {
+
+using MetricLabels = std::vector<std::pair<std::string, std::string>>;
+
+/**
+ * @brief Monotonic counter; inc() is a single relaxed atomic add
+ */
+class Counter {
+public:
+    void inc(uint64_t n = 1) { value_.fetch_add(n, std::memory_order_relaxed); }
+    uint64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> value_{0};
+};
+
+/**
+ * @brief Point-in-time value that can go up and down
+ */
+class Gauge {
+public:
+    void set(int64_t value) { value_.store(value, std::memory_order_relaxed); }
+    void add(int64_t delta) { value_.fetch_add(delta, std::memory_order_relaxed); }
+    int64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<int64_t> value_{0};
+};
+
+/**
+ * @brief Builds a Prometheus text exposition (format 0.0.4)
+ *
+ * Samples are grouped by metric family, so collectors may emit series of
+ * different families in any order.
+ */
+class MetricsWriter {
+public:
+    void counter(const std::string& name, const std::string& help, const MetricLabels& labels, uint64_t value);
+    void gauge(const std::string& name, const std::string& help, const MetricLabels& labels, double value);
+
+    /**
+     * @brief Write a histogram as a summary with 0.5/0.9/0.99/0.999 quantiles
+     *
+     * @param scale Divisor applied to recorded values (e.g. 1e9 for ns to seconds)
+     */
+    void summary(const std::string& name, const std::string& help, const MetricLabels& labels,
+                 const HdrHistogram& histogram, double scale = 1.0);
+
+    std::string str() const;
+
+private:
+    struct Family {
+        std::string help;
+        std::string type;
+        std::string samples;
+    };
+
+    Family& family(const std::string& name, const std::string& help, const char* type);
+    static void append_sample(std::string& out, const std::string& name, const MetricLabels& labels, double value,
+                              const char* extra_label = nullptr, const char* extra_value = nullptr);
+
+    std::map<std::string, Family> families_;
+};
+
+/**
+ * @brief Registry of SDK counters, gauges and latency summaries
+ *
+ * Registration takes a lock and returns a reference that stays valid for the
+ * life of the registry; callers keep it and update it lock-free on the hot
+ * path. Nothing is formatted until render() is called, so an idle registry
+ * costs only the atomic updates themselves.
+ */
+class MetricsRegistry {
+public:
+    using Collector = std::function<void(MetricsWriter&)>;
+
+    /**
+     * @brief Get or create a counter
+     *
+     * @param name Metric name, e.g. backpack_ws_messages_total
+     * @param help Help text, used the first time the family is registered
+     * @param labels Label set identifying the series
+     */
+    Counter& counter(const std::string& name, const std::string& help, const MetricLabels& labels = {});
+
+    /**
+     * @brief Get or create a gauge
+     */
+    Gauge& gauge(const std::string& name, const std::string& help, const MetricLabels& labels = {});
+
+    /**
+     * @brief Get or create a latency summary backed by an HDR histogram
+     *
+     * @param scale Divisor applied on render (e.g. 1e9 to record ns and expose seconds)
+     */
+    HdrHistogram& summary(const std::string& name, const std::string& help, const MetricLabels& labels = {},
+                          double scale = 1.0);
+
+    /**
+     * @brief Register a callback that writes metrics kept elsewhere at render time
+     */
+    void add_collector(Collector collector);
+
+    /**
+     * @brief Render every metric in Prometheus text format
+     */
+    std::string render() const;
+
+private:
+    template<typename T>
+    struct Series {
+        std::string name;
+        std::string help;
+        MetricLabels labels;
+        std::unique_ptr<T> metric;
+        double scale = 1.0;
+    };
+
+    static std::string series_key(const std::string& name, const MetricLabels& labels);
+
+    mutable std::mutex mutex_;
+    std::map<std::string, Series<Counter>> counters_;
+    std::map<std::string, Series<Gauge>> gauges_;
+    std::map<std::string, Series<HdrHistogram>> summaries_;
+    std::vector<Collector> collectors_;
+};
+
+} // namespace backpack
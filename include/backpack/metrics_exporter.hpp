@@ -0,0 +1,60 @@
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/steady_timer.hpp>
+
+#include "metrics.hpp"
+
+namespace backpack {
+
+/**
+ * @brief Minimal HTTP server exposing a MetricsRegistry for Prometheus
+ *
+ * Serves GET /metrics on its own thread. The registry is only rendered when
+ * a scrape arrives, so the exporter costs nothing between scrapes. If
+ * accepting fails (e.g. the process is out of file descriptors), the
+ * exporter waits before trying again, starting at 100ms and doubling up to
+ * one second, instead of spinning on the error.
+ */
+class MetricsExporter {
+public:
+    /**
+     * @brief Construct a new MetricsExporter object
+     *
+     * @param registry Registry to render on each scrape
+     * @param port Port to listen on (0 picks a free port)
+     * @param address Address to bind (default: loopback only)
+     */
+    MetricsExporter(std::shared_ptr<MetricsRegistry> registry, unsigned short port,
+                    const std::string& address = "127.0.0.1");
+
+    /**
+     * @brief Stop the server and join its thread
+     */
+    ~MetricsExporter();
+
+    MetricsExporter(const MetricsExporter&) = delete;
+    MetricsExporter& operator=(const MetricsExporter&) = delete;
+
+    /**
+     * @brief Port the exporter is listening on
+     */
+    unsigned short port() const;
+
+private:
+    void do_accept();
+
+    std::shared_ptr<MetricsRegistry> registry_;
+    boost::asio::io_context ioc_;
+    boost::asio::ip::tcp::acceptor acceptor_;
+    boost::asio::steady_timer accept_timer_;
+    std::chrono::milliseconds accept_backoff_;
+    std::thread thread_;
+};
+
+} // namespace backpack
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+
+namespace backpack {
+
+/**
+ * @brief Read-copy-update cell with one reader at a time
+ *
+ * Writers copy the current value, modify the copy and publish it with a
+ * pointer swap, serialized by a mutex. The reader never locks. read() is an
+ * acquire load, and the pointer stays valid until the reader calls
+ * quiescent(), which marks that it holds no references (quiescent-state
+ * based reclamation). Since only the reader can know when an old version
+ * is unused, the reader also frees the versions writers retired. Usually
+ * there are none, and quiescent() is a single load.
+ *
+ * Reads must not overlap each other. They may move between threads when
+ * the handoff synchronizes, as on a strand or a single io thread. Versions
+ * retired while nothing reads are freed at the next quiescent() or by the
+ * destructor.
+ */
+template<typename T>
+class RcuCell {
+public:
+    RcuCell() : current_(new T()) {}
+
+    ~RcuCell() {
+        reclaim();
+        delete current_.load(std::memory_order_relaxed);
+    }
+
+    RcuCell(const RcuCell&) = delete;
+    RcuCell& operator=(const RcuCell&) = delete;
+
+    /**
+     * @brief Current version; valid until this reader's next quiescent()
+     */
+    const T* read() const {
+        return current_.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Declare that the reader holds no pointer from read()
+     */
+    void quiescent() {
+        if (retired_.load(std::memory_order_relaxed)) {
+            reclaim();
+        }
+    }
+
+    /**
+     * @brief Reader scope that calls quiescent() on exit
+     */
+    class ReadGuard {
+    public:
+        explicit ReadGuard(RcuCell& cell) : cell_(cell), value_(cell.read()) {}
+        ~ReadGuard() { cell_.quiescent(); }
+
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+
+        const T& operator*() const { return *value_; }
+        const T* operator->() const { return value_; }
+
+    private:
+        RcuCell& cell_;
+        const T* value_;
+    };
+
+    /**
+     * @brief Publish a modified copy of the current version
+     *
+     * @param mutate Called with the copy; batch related changes into one call
+     * @return Whatever mutate returns
+     */
+    template<typename F>
+    auto update(F&& mutate) {
+        std::lock_guard<std::mutex> lock(write_mutex_);
+        auto next = std::make_unique<T>(*current_.load(std::memory_order_relaxed));
+        if constexpr (std::is_void_v<decltype(mutate(*next))>) {
+            mutate(*next);
+            publish(std::move(next));
+        } else {
+            auto result = mutate(*next);
+            publish(std::move(next));
+            return result;
+        }
+    }
+
+    /**
+     * @brief Read the current version from a writer's thread, excluding writers
+     */
+    template<typename F>
+    auto inspect(F&& visit) const {
+        std::lock_guard<std::mutex> lock(write_mutex_);
+        return visit(*current_.load(std::memory_order_relaxed));
+    }
+
+private:
+    struct Retired {
+        const T* value;
+        Retired* next;
+    };
+
+    void publish(std::unique_ptr<T> next) {
+        const T* old = current_.exchange(next.release(), std::memory_order_acq_rel);
+        // Release: a reader that takes this node also sees the new version
+        Retired* node = new Retired{old, retired_.load(std::memory_order_relaxed)};
+        while (!retired_.compare_exchange_weak(node->next, node, std::memory_order_release,
+                                               std::memory_order_relaxed)) {
+        }
+    }
+
+    void reclaim() {
+        Retired* node = retired_.exchange(nullptr, std::memory_order_acquire);
+        while (node) {
+            Retired* next = node->next;
+            delete node->value;
+            delete node;
+            node = next;
+        }
+    }
+
+    std::atomic<const T*> current_;
+    std::atomic<Retired*> retired_{nullptr};
+    mutable std::mutex write_mutex_;
+};
+
+} // namespace backpack
@@ -2,11 +2,20 @@
 
 #include <string>
 #include <map>
+#include <chrono>
+#include <exception>
 #include <functional>
 #include <memory>
+#include <vector>
 #include <curl/curl.h>
 #include <nlohmann/json.hpp>
 
+#include "connection_pool.hpp"
+#include "latency.hpp"
+#include "rest_engine.hpp"
+#include "rest_metrics.hpp"
+#include "server_clock.hpp"
+#include "trade_sequencer.hpp"
 #include "types.hpp"
 #include "utils.hpp"
 
@@ -24,6 +33,15 @@ enum class HttpMethod {
     DELETE
 };
 
+/**
+ * @brief Completion callback for a request started with one of the *_async methods
+ * 
+ * Runs inside RestClient::poll(). On failure result is default-constructed
+ * and error holds the exception the blocking call would have thrown.
+ */
+template<typename T>
+using AsyncCallback = std::function<void(T result, std::exception_ptr error)>;
+
 /**
  * @brief REST API client for Backpack Exchange
  * 
@@ -36,8 +54,10 @@ public:
      * @brief Construct a new RestClient object
      * 
      * @param base_url Base API URL (default: https://api.backpack.exchange)
+     * @param engine Shared curl state; nullptr creates one for this client alone
      */
-    explicit RestClient(const std::string& base_url = "https://api.backpack.exchange");
+    explicit RestClient(const std::string& base_url = "https://api.backpack.exchange",
+                        std::shared_ptr<RestEngine> engine = nullptr);
     
     /**
      * @brief Destroy the RestClient object
@@ -59,6 +79,122 @@ public:
      */
     bool has_credentials() const;
     
+    /**
+     * @brief Verify TLS peers against a PEM CA bundle instead of the system one
+     * 
+     * The file replaces the system trust store (CURLOPT_CAINFO), so it must
+     * hold every CA the exchange's certificates chain to.
+     * 
+     * @param path Path to a PEM file (e.g. a local mock exchange certificate)
+     */
+    void set_ca_file(const std::string& path);
+    
+    /**
+     * @brief Set the total timeout applied to every request
+     * 
+     * @param timeout Maximum time for a request including connect; zero disables the timeout (default)
+     */
+    void set_request_timeout(std::chrono::milliseconds timeout);
+    
+    /**
+     * @brief Record order encode, sign and write stages into a latency tracer
+     * 
+     * @param tracer Tracer shared with the WebSocket side (nullptr disables)
+     */
+    void set_latency_tracer(std::shared_ptr<LatencyTracer> tracer);
+    
+    /**
+     * @brief Per-endpoint request metrics
+     * 
+     * Every request records curl's DNS, connect, TLS, first-byte and total
+     * times, the response size and the status code under "METHOD /path".
+     * 
+     * @return Metrics registry owned by this client
+     */
+    RestMetrics& metrics();
+    
+    /**
+     * @brief Sign requests with timestamps corrected to the exchange clock
+     * 
+     * Starts a ServerClockEstimator that polls /api/v1/time on its own
+     * connection. Once it has a sample, X-BPX-TS is local wall time plus the
+     * estimated offset, so local drift no longer causes signature-window
+     * rejections. Until then the local clock is used; call
+     * server_clock()->sync() to wait for the first sample.
+     * 
+     * Call once. Signing, the metrics exporter and the feed latency monitor
+     * read the estimator from other threads, so it is kept until the client
+     * is destroyed; server_clock()->stop() ends sampling and keeps the last
+     * estimate.
+     * 
+     * @param options Sampling interval, burst size, window and smoothing
+     * @throws std::runtime_error if already enabled
+     */
+    void enable_server_clock(ServerClockEstimator::Options options = {});
+    
+    /**
+     * @brief Server clock estimator, or nullptr if not enabled
+     */
+    ServerClockEstimator* server_clock();
+    
+    /**
+     * @brief Fill gaps in trade streams from GET /api/v1/historicalTrades
+     * 
+     * Starts a TradeSequencer whose fetches use a connection of their own,
+     * with the credentials and CA file set so far (the endpoint is signed).
+     * Call once; handlers from trade_sequencer()->track() refer to it.
+     * 
+     * @param options Largest gap to fetch, page size and trades held meanwhile
+     * @throws std::runtime_error if already enabled
+     */
+    void enable_trade_recovery(TradeSequencer::Options options = {});
+    
+    /**
+     * @brief Trade sequencer, or nullptr if not enabled
+     */
+    TradeSequencer* trade_sequencer();
+    
+    /**
+     * @brief Open connections ahead of the first request
+     * 
+     * Every request runs on the pool's connections, so a request made
+     * after this skips the handshake.
+     * 
+     * @param connections Number of connections that should be open afterwards
+     * @return Number of new connections opened
+     */
+    size_t warm_up(size_t connections = 1);
+    
+    /**
+     * @brief Keep connections open from a background thread
+     * 
+     * Orders that still had to open a connection are counted in
+     * metrics().connections().cold_orders.
+     * 
+     * @param options Number of connections, ping interval and connection age limits
+     */
+    void enable_keepalive(KeepaliveOptions options = {});
+    
+    /**
+     * @brief Stop the keepalive thread
+     */
+    void disable_keepalive();
+    
+    /**
+     * @brief Run finished asynchronous requests' callbacks on the calling thread
+     * 
+     * Advances every in-flight transfer without blocking. Requests started
+     * with the *_async methods only make progress inside poll().
+     * 
+     * @return Number of requests completed
+     */
+    size_t poll();
+    
+    /**
+     * @brief Number of asynchronous requests still in flight
+     */
+    size_t pending_requests() const;
+    
     // Public API Endpoints
     
     /**
@@ -68,6 +204,11 @@ public:
      */
     int64_t get_server_time();
     
+    /**
+     * @brief Get server time without blocking; the callback runs from poll()
+     */
+    void get_server_time_async(AsyncCallback<int64_t> callback);
+    
     /**
      * @brief Get exchange information
      * 
@@ -141,6 +282,14 @@ public:
      */
     Order create_order(const OrderRequest& order);
     
+    /**
+     * @brief Create a new order without blocking; the callback runs from poll()
+     * 
+     * @param order Order to create
+     * @param callback Receives the created order or the error
+     */
+    void create_order_async(const OrderRequest& order, AsyncCallback<Order> callback);
+    
     /**
      * @brief Test creating an order without actually placing it
      * 
@@ -158,6 +307,15 @@ public:
      */
     bool cancel_order(const std::string& symbol, const std::string& order_id);
     
+    /**
+     * @brief Cancel an order without blocking; the callback runs from poll()
+     * 
+     * @param symbol Trading pair (e.g., "SOL-USDC")
+     * @param order_id Order ID to cancel
+     * @param callback Receives true, or false with the error
+     */
+    void cancel_order_async(const std::string& symbol, const std::string& order_id, AsyncCallback<bool> callback);
+    
     /**
      * @brief Cancel an order by client order ID
      * 
@@ -237,11 +395,37 @@ public:
     std::vector<Trade> get_account_trades(const std::string& symbol, int limit = 100,
                                          const std::string& from_id = "");
     
+    /**
+     * @brief Sign a request
+     * 
+     * Only the body and the timestamp are signed, so the endpoint and query
+     * parameters are not needed.
+     * 
+     * @param method HTTP method
+     * @param timestamp Request timestamp
+     * @param body Request body
+     * @return Base64 encoded ED25519 signature
+     */
+    std::string sign_request(HttpMethod method, int64_t timestamp, const std::string& body);
+    
 private:
     std::string base_url_;
     Credentials credentials_;
+    std::string ca_file_;
+    std::chrono::milliseconds request_timeout_{0};
+    std::shared_ptr<LatencyTracer> latency_tracer_;
+    RestMetrics metrics_;
+    std::shared_ptr<RestEngine> engine_;
+    std::unique_ptr<ServerClockEstimator> server_clock_;
+    std::unique_ptr<TradeSequencer> trade_sequencer_;
+    std::unique_ptr<ConnectionPool> pool_;
     CURL* curl_;
     
+    // Asynchronous requests, driven by poll() on pool_'s multi handle
+    struct AsyncRequest;
+    std::map<CURL*, std::unique_ptr<AsyncRequest>> async_requests_;
+    std::vector<CURL*> idle_handles_;
+    
     /**
      * @brief Send a request to the API
      * 
@@ -257,17 +441,26 @@ private:
                      const std::string& body = "", bool auth_required = false);
     
     /**
-     * @brief Sign a request
+     * @brief Set every curl option for a request on handle, signing it if needed
      * 
-     * @param method HTTP method
-     * @param endpoint API endpoint
-     * @param timestamp Request timestamp
-     * @param params Query parameters
-     * @param body Request body
-     * @return Signature
+     * @param response_data String the response body is written to
+     * @return Header list to free once the transfer is done
      */
-    std::string sign_request(HttpMethod method, const std::string& endpoint, int64_t timestamp,
-                           const std::map<std::string, std::string>& params, const std::string& body);
+    struct curl_slist* prepare_request(CURL* handle, const std::string& endpoint, HttpMethod method,
+                                       const std::map<std::string, std::string>& params,
+                                       const std::string& body, bool auth_required, std::string& response_data);
+    
+    /**
+     * @brief Turn a finished transfer into JSON, throwing on transport, HTTP or parse errors
+     */
+    json parse_response(CURL* handle, CURLcode result, const std::string& response_data);
+    
+    /**
+     * @brief Start a request on the pool's multi handle; on_response runs from poll()
+     */
+    void send_request_async(const std::string& endpoint, HttpMethod method,
+                            const std::map<std::string, std::string>& params, std::string body,
+                            bool auth_required, std::function<void(json response, std::exception_ptr error)> on_response);
     
     /**
      * @brief Convert HTTP method to string
@@ -277,6 +470,18 @@ private:
      */
     std::string http_method_to_string(HttpMethod method);
     
+    /**
+     * @brief Record curl timings of the last transfer into metrics_
+     * 
+     * @param handle Handle that ran the transfer
+     * @param endpoint API endpoint
+     * @param method HTTP method
+     * @param result Result of curl_easy_perform
+     * @param response_bytes Size of the response body
+     */
+    void record_request_metrics(CURL* handle, const std::string& endpoint, HttpMethod method, CURLcode result,
+                                size_t response_bytes);
+    
     /**
      * @brief CURL write callback
      */
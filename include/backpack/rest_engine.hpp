@@ -0,0 +1,45 @@
+#pragma once
+
+#include <array>
+#include <mutex>
+#include <curl/curl.h>
+
+namespace backpack {
+
+/**
+ * @brief curl state shared by any number of RestClients
+ *
+ * Owns one curl_global_init()/curl_global_cleanup() pair and a curl share
+ * holding DNS results and TLS sessions. Clients that talk to the same
+ * exchange through one engine resolve once and resume each other's TLS
+ * sessions, whatever account they sign for. Connections are not shared:
+ * libcurl does not support a connection cache used from several threads at
+ * once, so each client keeps its own in its ConnectionPool.
+ * A RestClient constructed without an engine creates a private one.
+ */
+class RestEngine {
+public:
+    RestEngine();
+
+    /**
+     * @brief Release the share; every client using it must be destroyed first
+     */
+    ~RestEngine();
+
+    RestEngine(const RestEngine&) = delete;
+    RestEngine& operator=(const RestEngine&) = delete;
+
+    /**
+     * @brief Make a handle use the shared caches; call after every curl_easy_reset
+     */
+    void attach(CURL* handle) const;
+
+private:
+    static void lock(CURL* handle, curl_lock_data data, curl_lock_access access, void* userptr);
+    static void unlock(CURL* handle, curl_lock_data data, void* userptr);
+
+    CURLSH* share_;
+    std::array<std::mutex, CURL_LOCK_DATA_LAST> locks_;
+};
+
+} // namespace backpack
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "histogram.hpp"
+
+namespace backpack {
+
+/**
+ * @brief Timing and outcome of a single REST request, taken from curl
+ *
+ * Phase durations are in microseconds and are already split out of curl's
+ * cumulative timers, so they add up to roughly the total.
+ */
+struct RequestTiming {
+    int64_t dns_us = 0;        // Name lookup
+    int64_t connect_us = 0;    // TCP connect after name lookup
+    int64_t tls_us = 0;        // TLS handshake after TCP connect
+    int64_t first_byte_us = 0; // Request sent to first response byte (exchange time)
+    int64_t total_us = 0;      // Whole transfer
+    int64_t response_bytes = 0;
+    long status_code = 0;      // 0 when the transfer itself failed
+    bool new_connection = false;
+};
+
+/**
+ * @brief Latency histograms and outcome counters for one REST endpoint
+ *
+ * The connection phases (DNS, connect, TLS) are only recorded for requests
+ * that opened a new connection, so reused connections do not hide handshake
+ * cost behind a pile of zeros.
+ */
+struct EndpointStats {
+    static constexpr int64_t MAX_TIME_US = 60LL * 1000 * 1000;
+    static constexpr int64_t MAX_RESPONSE_BYTES = 64LL * 1024 * 1024;
+
+    HdrHistogram dns_us{MAX_TIME_US};
+    HdrHistogram connect_us{MAX_TIME_US};
+    HdrHistogram tls_us{MAX_TIME_US};
+    HdrHistogram first_byte_us{MAX_TIME_US};
+    HdrHistogram total_us{MAX_TIME_US};
+    HdrHistogram response_bytes{MAX_RESPONSE_BYTES};
+
+    std::atomic<uint64_t> requests{0};
+    std::atomic<uint64_t> new_connections{0};
+    std::atomic<uint64_t> transport_errors{0};
+    std::array<std::atomic<uint64_t>, 600> status_codes{};
+
+    /**
+     * @brief Number of responses with the given HTTP status code
+     */
+    uint64_t status_count(long code) const {
+        return code >= 0 && code < static_cast<long>(status_codes.size())
+            ? status_codes[static_cast<size_t>(code)].load(std::memory_order_relaxed) : 0;
+    }
+
+    void record(const RequestTiming& timing);
+    void reset();
+};
+
+/**
+ * @brief Connection warm-up, keepalive and cold-order counters
+ *
+ * An order is cold when curl had to open a new connection to send it, i.e.
+ * it paid for DNS, TCP and TLS on the critical path.
+ */
+struct ConnectionStats {
+    std::atomic<uint64_t> warm_up_requests{0};    // Requests sent by warm_up()
+    std::atomic<uint64_t> keepalive_requests{0};  // Requests sent by the keepalive thread
+    std::atomic<uint64_t> pool_failures{0};       // Warm-up or keepalive requests that failed
+    std::atomic<uint64_t> pool_connects{0};       // Connections opened by warm-up or keepalive
+    std::atomic<uint64_t> orders{0};              // Order placement and cancel requests, not test orders
+    std::atomic<uint64_t> cold_orders{0};         // Orders that opened a new connection
+
+    void reset();
+};
+
+/**
+ * @brief Per-endpoint REST metrics, keyed by "METHOD /path"
+ *
+ * Recording takes a short lock to find the endpoint, then updates its
+ * histograms lock-free. Endpoint entries are never removed, so references
+ * returned by find() stay valid for the lifetime of the registry.
+ */
+class RestMetrics {
+public:
+    /**
+     * @brief Record a finished request against its endpoint
+     *
+     * @param endpoint Key in the form "METHOD /path"
+     * @param timing Timing and outcome of the request
+     */
+    void record(const std::string& endpoint, const RequestTiming& timing);
+
+    /**
+     * @brief Stats for an endpoint
+     *
+     * @return Pointer to the stats, or nullptr if nothing was recorded for it
+     */
+    const EndpointStats* find(const std::string& endpoint) const;
+
+    /**
+     * @brief Keys of every endpoint seen so far, sorted
+     */
+    std::vector<std::string> endpoints() const;
+
+    /**
+     * @brief Warm-up, keepalive and cold-order counters
+     */
+    ConnectionStats& connections() { return connections_; }
+    const ConnectionStats& connections() const { return connections_; }
+
+    /**
+     * @brief Clear every endpoint's histograms and counters
+     */
+    void reset();
+
+    /**
+     * @brief Print per-endpoint phase latencies (ms), sizes and status codes
+     */
+    void dump(std::ostream& os) const;
+
+private:
+    mutable std::mutex mutex_;
+    std::map<std::string, std::unique_ptr<EndpointStats>> endpoints_;
+    ConnectionStats connections_;
+};
+
+} // namespace backpack
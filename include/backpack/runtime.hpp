@@ -0,0 +1,84 @@
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ssl/context.hpp>
+
+#include "rest_engine.hpp"
+
+namespace backpack {
+
+/**
+ * @brief Threads, TLS context and curl state shared by many clients
+ *
+ * By default every BackpackClient owns an io_context with its own io thread,
+ * a TLS context and curl state. Clients constructed with a runtime instead
+ * run their WebSocket I/O and heartbeats on the runtime's io_context, each
+ * on its own strand so one client's handlers never run concurrently, and
+ * send REST requests through the runtime's RestEngine. Hundreds of accounts
+ * then cost a handful of threads, one TLS context and one DNS and TLS
+ * session cache.
+ *
+ * The runtime must outlive its clients; clients hold a reference to it.
+ */
+class ClientRuntime {
+public:
+    /**
+     * @brief Construct a new ClientRuntime object
+     *
+     * @param io_threads Threads running the io_context; 0 runs nothing until poll() is called
+     */
+    explicit ClientRuntime(size_t io_threads = 1);
+
+    /**
+     * @brief Stop the io_context and join its threads
+     */
+    ~ClientRuntime();
+
+    ClientRuntime(const ClientRuntime&) = delete;
+    ClientRuntime& operator=(const ClientRuntime&) = delete;
+
+    boost::asio::io_context& io_context() { return ioc_; }
+    boost::asio::ssl::context& ssl_context() { return ssl_ctx_; }
+    const std::shared_ptr<RestEngine>& rest_engine() const { return rest_engine_; }
+
+    /**
+     * @brief Verify every client's connections against a PEM CA bundle instead of the system one
+     *
+     * The file replaces the system trust store. The runtime's TLS context is
+     * shared, so this is the only way to set it for runtime clients. Call it
+     * before creating clients: REST connections pick the file up when a
+     * client is constructed.
+     */
+    void set_ca_file(const std::string& path);
+
+    /**
+     * @brief CA bundle set with set_ca_file(), or empty
+     */
+    const std::string& ca_file() const { return ca_file_; }
+
+    /**
+     * @brief Run ready handlers on the calling thread without blocking (for io_threads == 0)
+     *
+     * @param budget Time after which to stop (zero: one handler at most)
+     * @return Number of handlers run
+     */
+    size_t poll(std::chrono::microseconds budget = std::chrono::microseconds::zero());
+
+    size_t io_threads() const { return threads_.size(); }
+
+private:
+    boost::asio::io_context ioc_;
+    boost::asio::ssl::context ssl_ctx_;
+    boost::asio::executor_work_guard<boost::asio::io_context::executor_type> work_;
+    std::shared_ptr<RestEngine> rest_engine_;
+    std::string ca_file_;
+    std::vector<std::thread> threads_;
+};
+
+} // namespace backpack
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace backpack {
+
+/**
+ * @brief Estimate of the exchange clock relative to local wall time
+ */
+struct ServerClockState {
+    bool synchronized = false;   // At least one sample has been taken
+    int64_t offset_ns = 0;       // Server minus local, as of now
+    int64_t uncertainty_ns = 0;  // Half the best round trip plus server rounding and skew since
+    double skew_ppm = 0.0;       // Drift of the server clock relative to ours
+    int64_t min_rtt_ns = 0;      // Best round trip in the sample window
+    uint64_t samples = 0;        // Successful rounds
+    uint64_t failures = 0;       // Rounds where every query failed
+};
+
+/**
+ * @brief Tracks the offset between the local and the exchange clock
+ *
+ * Each round queries the server time a few times back to back and keeps the
+ * reply with the shortest round trip, since its midpoint is the one least
+ * skewed by queueing (NTP's minimum-delay selection). The last few rounds
+ * form a window: the minimum-RTT sample in the window gives the offset,
+ * which is folded into an exponentially smoothed estimate, and a least
+ * squares fit over the window gives the skew used to extrapolate between
+ * rounds.
+ *
+ * Rounds run on a background thread after start(), or on demand with
+ * sync(). Reads are a short lock and never block on the network.
+ */
+class ServerClockEstimator {
+public:
+    /**
+     * @brief Returns the server time in milliseconds; throws on failure
+     */
+    using TimeSource = std::function<int64_t()>;
+
+    struct Options {
+        std::chrono::milliseconds interval{std::chrono::seconds(30)};  // Time between rounds
+        int burst = 4;                                                 // Queries per round
+        size_t window = 8;                                             // Rounds kept for selection and skew
+        double smoothing = 0.25;                                       // Weight of a new offset
+    };
+
+    explicit ServerClockEstimator(TimeSource source);
+    ServerClockEstimator(TimeSource source, Options options);
+
+    /**
+     * @brief Stop the background thread if running
+     */
+    ~ServerClockEstimator();
+
+    ServerClockEstimator(const ServerClockEstimator&) = delete;
+    ServerClockEstimator& operator=(const ServerClockEstimator&) = delete;
+
+    /**
+     * @brief Run a round now and then every interval on a background thread
+     */
+    void start();
+
+    /**
+     * @brief Stop and join the background thread
+     */
+    void stop();
+
+    /**
+     * @brief Run one round on the calling thread
+     *
+     * @return true if at least one query succeeded
+     */
+    bool sync();
+
+    /**
+     * @brief Server minus local wall time in nanoseconds, extrapolated to now (0 before the first sample)
+     */
+    int64_t offset_ns() const;
+
+    /**
+     * @brief Local wall time corrected to the server clock, in milliseconds
+     */
+    int64_t now_ms() const;
+
+    /**
+     * @brief Snapshot of the estimate
+     */
+    ServerClockState state() const;
+
+private:
+    struct Sample {
+        int64_t local_ns;   // Local wall time at the midpoint of the query
+        int64_t offset_ns;  // Server minus local at local_ns
+        int64_t rtt_ns;
+    };
+
+    void run();
+    void update(const Sample& sample);
+    int64_t offset_at(int64_t local_ns) const;
+
+    TimeSource source_;
+    Options options_;
+
+    mutable std::mutex mutex_;
+    std::deque<Sample> window_;
+    bool synchronized_ = false;
+    int64_t anchor_local_ns_ = 0;
+    int64_t anchor_offset_ns_ = 0;
+    double skew_ = 0.0;                 // ns of offset change per ns of local time
+    Sample best_{0, 0, 0};              // Minimum-RTT sample in the window
+    uint64_t samples_ = 0;
+    uint64_t failures_ = 0;
+
+    std::thread thread_;
+    std::condition_variable cv_;
+    std::atomic<bool> running_{false};
+};
+
+} // namespace backpack
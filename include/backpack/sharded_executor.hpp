@@ -0,0 +1,115 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "lockfree_queue.hpp"
+
+namespace backpack {
+
+/**
+ * @brief Counters for ShardedExecutor
+ */
+struct ShardedExecutorStats {
+    uint64_t executed = 0;        // Tasks run
+    uint64_t steals = 0;          // Shards run by a worker other than their home worker
+    uint64_t producer_waits = 0;  // Times post() found a shard queue full and had to wait
+    uint64_t handler_errors = 0;  // Tasks that threw
+    size_t shards = 0;            // Keys seen so far
+};
+
+/**
+ * @brief Runs tasks on a worker pool, in order per key and in parallel across keys
+ *
+ * Each key (a symbol) gets a shard: a single-producer ring of pending tasks
+ * and a flag saying whether the shard is scheduled. Posting to an idle shard
+ * puts it on its home worker's run queue, picked by hashing the key. A
+ * worker drains up to a batch from the shard, then releases it or requeues it
+ * if more arrived. A shard is held by at most one worker, which keeps its
+ * tasks in order. Idle workers steal from other workers' run queues. Those
+ * queues hold only shards that are waiting, so a shard that is running is
+ * never moved.
+ *
+ * post() for a given shard must come from one thread at a time, as it does
+ * from a connection's read loop; different shards may be posted to
+ * concurrently.
+ */
+class ShardedExecutor {
+public:
+    using Task = std::function<void()>;
+
+    struct Options {
+        size_t workers = 2;           // Worker threads
+        size_t queue_capacity = 1024; // Pending tasks per shard before post() waits
+        size_t batch = 64;            // Tasks run from a shard before others get a turn
+        size_t max_shards = 4096;     // Bounds the run queues
+    };
+
+    class Shard;
+
+    ShardedExecutor();
+    explicit ShardedExecutor(Options options);
+
+    /**
+     * @brief Stop and join the workers; tasks still queued are discarded
+     */
+    ~ShardedExecutor();
+
+    ShardedExecutor(const ShardedExecutor&) = delete;
+    ShardedExecutor& operator=(const ShardedExecutor&) = delete;
+
+    /**
+     * @brief Get or create the shard for a key
+     *
+     * Takes a lock; look shards up once (e.g. at subscribe time) and keep the
+     * pointer, which stays valid for the executor's lifetime.
+     */
+    Shard* shard(std::string_view key);
+
+    /**
+     * @brief Queue a task behind every task posted to the same shard
+     *
+     * Waits if the shard's queue is full.
+     */
+    void post(Shard* shard, Task task);
+
+    size_t workers() const { return workers_.size(); }
+
+    ShardedExecutorStats stats() const;
+
+private:
+    struct Worker;
+
+    void run_worker(size_t index);
+    bool next_shard(size_t index, Shard*& shard);
+    void run_shard(Shard* shard);
+    void schedule(Shard* shard);
+    bool has_work() const;
+
+    Options options_;
+    std::vector<std::unique_ptr<Worker>> workers_;
+
+    mutable std::mutex shards_mutex_;
+    std::unordered_map<std::string, std::unique_ptr<Shard>> shards_;
+
+    std::mutex idle_mutex_;
+    std::condition_variable idle_cv_;
+    std::atomic<size_t> idle_{0};
+    std::atomic<bool> running_{true};
+
+    std::atomic<uint64_t> executed_{0};
+    std::atomic<uint64_t> steals_{0};
+    std::atomic<uint64_t> producer_waits_{0};
+    std::atomic<uint64_t> handler_errors_{0};
+};
+
+} // namespace backpack
@@ -0,0 +1,213 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace backpack {
+
+/**
+ * @brief A stream crossed its staleness SLA, or recovered after doing so
+ */
+struct StaleStreamEvent {
+    std::string channel;
+    std::string symbol;
+    std::chrono::milliseconds silence{0};  // Time since the stream's last message
+    std::chrono::milliseconds sla{0};      // Silence allowed before the stream counts as stale
+    bool recovered = false;                // false: went stale; true: a message arrived again
+};
+
+/**
+ * @brief One stream's state, as reported by StreamWatchdog::snapshot()
+ */
+struct StreamHealth {
+    std::string channel;
+    std::string symbol;
+    std::chrono::milliseconds silence{0};
+    std::chrono::milliseconds sla{0};
+    std::chrono::microseconds typical_gap{0};  // Smoothed time between messages; 0 until measured
+    bool stale = false;
+};
+
+/**
+ * @brief Counters for StreamWatchdog
+ */
+struct StreamWatchdogStats {
+    uint64_t stale_events = 0;  // Times a stream went stale
+    uint64_t recoveries = 0;    // Times a stale stream got a message again
+    size_t streams = 0;         // Streams being watched
+    size_t stale = 0;           // Streams stale right now
+};
+
+/**
+ * @brief Tells a quiet stream from a stuck one
+ *
+ * Every watched stream records the time of its last message and a smoothed
+ * gap between messages. Its SLA is that gap times the channel's
+ * multiplier, clamped to the channel's [min_sla, max_sla]; max_sla applies
+ * until enough messages have arrived to measure the gap. So a busy depth
+ * stream is flagged after a short silence, and a sparse trades stream only
+ * after a long one.
+ *
+ * Deadlines live in one hashed timer wheel, driven by advance() from a
+ * single periodic timer. A message only stores two timestamps. The wheel
+ * is checked lazily: when a stream's slot comes up, its deadline is worked
+ * out again from the latest message. The stream moves to a later slot if
+ * messages arrived, or is reported if not. Checks cost O(streams per slot)
+ * per tick, however many messages arrive.
+ *
+ * touch() is lock-free and may run concurrently with everything else. The
+ * other methods take a lock; the callback runs after it is released.
+ */
+class StreamWatchdog {
+public:
+    /**
+     * @brief Staleness SLA for one channel
+     */
+    struct Policy {
+        std::chrono::milliseconds min_sla{std::chrono::seconds(2)};   // Never flag a shorter silence
+        std::chrono::milliseconds max_sla{std::chrono::seconds(60)};  // SLA until the gap is measured, and its cap
+        double multiplier = 10.0;                                     // SLA in typical gaps between messages
+    };
+
+    struct Options {
+        std::chrono::milliseconds tick{100};   // Wheel resolution; how often advance() is driven
+        Policy default_policy;
+        std::map<std::string, Policy> channels; // Per-channel overrides, e.g. {"trades", {...}}
+        bool resubscribe = false;               // Resubscribe a stream when it goes stale (BackpackClient)
+    };
+
+    using Callback = std::function<void(const StaleStreamEvent& event)>;
+
+    /**
+     * @brief A watched stream; pointers stay valid for the watchdog's lifetime
+     */
+    class Stream {
+    public:
+        /**
+         * @brief Record a message; lock-free, called for every message on the stream
+         */
+        void touch(int64_t now_ns) {
+            int64_t previous = last_ns.load(std::memory_order_relaxed);
+            last_ns.store(now_ns, std::memory_order_relaxed);
+            int64_t gap = now_ns - previous;
+            if (previous == 0 || gap <= 0) {
+                return;
+            }
+            // Only this stream's dispatch thread writes these
+            int64_t average = gap_ns.load(std::memory_order_relaxed);
+            gap_ns.store(average == 0 ? gap : average + (gap - average) / 8, std::memory_order_relaxed);
+            uint32_t count = samples.load(std::memory_order_relaxed);
+            if (count < MIN_SAMPLES) {
+                samples.store(count + 1, std::memory_order_relaxed);
+            }
+        }
+
+    private:
+        friend class StreamWatchdog;
+
+        // Gaps needed before the measured rate replaces max_sla
+        static constexpr uint32_t MIN_SAMPLES = 8;
+
+        Stream(std::string channel, std::string symbol, const Policy& policy)
+            : channel(std::move(channel)), symbol(std::move(symbol)), policy(policy) {}
+
+        std::atomic<int64_t> last_ns{0};
+        std::atomic<int64_t> gap_ns{0};
+        std::atomic<uint32_t> samples{0};
+
+        // Guarded by the watchdog's mutex
+        const std::string channel;
+        const std::string symbol;
+        const Policy policy;
+        bool tracked = true;
+        bool scheduled = false;  // In a wheel slot
+        bool stale = false;
+        int64_t stale_last_ns = 0;  // last_ns when it went stale; any later message is a recovery
+    };
+
+    StreamWatchdog();
+    explicit StreamWatchdog(Options options);
+
+    StreamWatchdog(const StreamWatchdog&) = delete;
+    StreamWatchdog& operator=(const StreamWatchdog&) = delete;
+
+    /**
+     * @brief Steady clock in ns, the time base for touch() and advance()
+     */
+    static int64_t now_ns() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    /**
+     * @brief Called with each stale and recovered event, from advance()
+     */
+    void set_callback(Callback callback);
+
+    /**
+     * @brief Start watching a stream, or watch it again; its silence counts from now
+     */
+    Stream* track(const std::string& channel, const std::string& symbol);
+
+    /**
+     * @brief Stop watching a stream; its Stream* stays valid, and track() reuses it
+     */
+    void untrack(const std::string& channel, const std::string& symbol);
+
+    /**
+     * @brief Stop watching every stream
+     */
+    void untrack_all();
+
+    /**
+     * @brief Suspend checks, e.g. while disconnected
+     */
+    void pause();
+
+    /**
+     * @brief Resume checks, restarting every stream's silence from now
+     */
+    void resume(int64_t now_ns);
+
+    /**
+     * @brief Check the wheel slots due by now and report streams that crossed their SLA
+     */
+    void advance(int64_t now_ns);
+
+    const Options& options() const { return options_; }
+
+    std::vector<StreamHealth> snapshot(int64_t now_ns) const;
+
+    StreamWatchdogStats stats() const;
+
+private:
+    // 512 slots of 100ms cover 51s; longer deadlines are rechecked once per lap
+    static constexpr size_t WHEEL_SLOTS = 512;
+
+    int64_t sla_ns(const Stream& stream) const;
+    void schedule_locked(Stream* stream, int64_t deadline_ns);
+    void check_locked(Stream* stream, int64_t now_ns, std::vector<StaleStreamEvent>& events);
+
+    Options options_;
+    int64_t tick_ns_;
+    Callback callback_;
+
+    mutable std::mutex mutex_;
+    std::map<std::string, std::unique_ptr<Stream>> streams_;  // By "channel:symbol"
+    std::vector<std::vector<Stream*>> wheel_;
+    int64_t origin_ns_;
+    uint64_t current_tick_ = 0;
+    bool paused_ = false;
+    size_t stale_count_ = 0;
+    uint64_t stale_events_ = 0;
+    uint64_t recoveries_ = 0;
+};
+
+} // namespace backpack
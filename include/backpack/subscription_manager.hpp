@@ -0,0 +1,160 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+#include "types.hpp"
+
+namespace backpack {
+
+/**
+ * @brief Counters for SubscriptionManager
+ */
+struct SubscriptionStats {
+    uint64_t frames = 0;      // SUBSCRIBE and UNSUBSCRIBE frames sent
+    uint64_t streams = 0;     // Streams carried by those frames
+    uint64_t acks = 0;        // Frames the server confirmed
+    uint64_t errors = 0;      // Frames the server rejected
+    uint64_t timeouts = 0;    // Frames with no reply within the ack timeout
+    size_t desired = 0;       // Streams we want
+    size_t active = 0;        // Streams the server confirmed
+    size_t in_flight = 0;     // Streams waiting for a reply
+    size_t rejected = 0;      // Streams the server refused; not retried until requested again
+    size_t unconfirmed = 0;   // Streams given up on after max_retries timeouts; retried when requested again or on reconnect
+};
+
+/**
+ * @brief Keeps the server's stream subscriptions in line with a desired set
+ *
+ * Callers edit the desired set, one stream at a time or as a whole with
+ * set_desired(). flush() then compares it with what the server has
+ * confirmed and sends the difference as SUBSCRIBE and UNSUBSCRIBE frames,
+ * each with up to max_streams_per_frame streams and a request id.
+ * Replies matching those ids move streams to active, or to rejected if the
+ * server refused them. Frames with no reply within ack_timeout are sent
+ * again on the next flush(), up to max_retries times per stream; after
+ * that the stream counts as unconfirmed and is left alone, so a server
+ * that never echoes ids is not flooded with frames. After a reconnect,
+ * on_connected() forgets what the old connection had, so the next flush()
+ * subscribes everything desired again.
+ *
+ * Thread-safe; replies usually arrive on the io thread while edits come
+ * from the application.
+ */
+class SubscriptionManager {
+public:
+    /**
+     * @brief Sends one text frame; returns false if it could not be queued
+     */
+    using Sender = std::function<bool(const std::string& frame)>;
+
+    struct Options {
+        size_t max_streams_per_frame = 100;
+        std::chrono::milliseconds ack_timeout{std::chrono::seconds(5)};
+        unsigned max_retries = 3;   // Resends after a timeout before a stream is given up on
+    };
+
+    explicit SubscriptionManager(Sender sender);
+    SubscriptionManager(Sender sender, Options options);
+
+    SubscriptionManager(const SubscriptionManager&) = delete;
+    SubscriptionManager& operator=(const SubscriptionManager&) = delete;
+
+    /**
+     * @brief Add a stream to the desired set
+     */
+    void subscribe(const std::string& stream);
+
+    /**
+     * @brief Remove a stream from the desired set
+     */
+    void unsubscribe(const std::string& stream);
+
+    /**
+     * @brief Replace the desired set
+     */
+    void set_desired(const std::set<std::string>& streams);
+
+    /**
+     * @brief Cycle one stream with an UNSUBSCRIBE and a SUBSCRIBE, leaving the rest alone
+     *
+     * For a stream that went silent on a connection that is otherwise fine.
+     *
+     * @return false if disconnected, the stream is not desired, a reply is
+     *         already awaited for it, or the frames could not be sent
+     */
+    bool resubscribe(const std::string& stream);
+
+    /**
+     * @brief Drop the desired set and everything known about the connection, sending nothing
+     */
+    void clear();
+
+    /**
+     * @brief Send the difference between the desired and confirmed sets
+     *
+     * Does nothing while disconnected.
+     *
+     * @return Frames sent
+     */
+    size_t flush();
+
+    /**
+     * @brief A new connection is open and has no subscriptions yet
+     */
+    void on_connected();
+
+    /**
+     * @brief The connection is gone; frames are held until on_connected()
+     */
+    void on_disconnected();
+
+    /**
+     * @brief Handle a server reply ({"id":N,"result":...} or {"id":N,"error":...})
+     *
+     * @return true if the reply answered one of our frames
+     */
+    bool on_response(const nlohmann::json& message);
+
+    /**
+     * @brief Whether the server has confirmed the stream
+     */
+    bool is_active(const std::string& stream) const;
+
+    SubscriptionStats stats() const;
+
+private:
+    struct Batch {
+        EventType method;
+        std::vector<std::string> streams;
+        std::chrono::steady_clock::time_point sent;
+    };
+
+    void expire_locked(std::chrono::steady_clock::time_point now);
+    size_t send_locked(EventType method, const std::vector<std::string>& streams,
+                       std::chrono::steady_clock::time_point now);
+
+    Sender sender_;
+    Options options_;
+
+    mutable std::mutex mutex_;
+    bool connected_ = false;
+    uint64_t next_id_ = 1;
+    std::set<std::string> desired_;
+    std::set<std::string> active_;
+    std::set<std::string> rejected_;
+    std::set<std::string> unconfirmed_;
+    std::map<std::string, uint64_t> pending_;   // Stream -> id of the frame it is waiting on
+    std::map<std::string, unsigned> timeouts_;  // Stream -> timeouts since its last reply
+    std::map<uint64_t, Batch> in_flight_;
+    SubscriptionStats stats_;
+};
+
+} // namespace backpack
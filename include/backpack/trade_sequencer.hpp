@@ -0,0 +1,126 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "types.hpp"
+
+namespace backpack {
+
+/**
+ * @brief Counters for TradeSequencer
+ */
+struct TradeSequencerStats {
+    uint64_t gaps = 0;               // Times a trade id skipped ahead
+    uint64_t missing = 0;            // Trade ids missing from the stream
+    uint64_t recovered = 0;          // Missing trades fetched over REST and delivered
+    uint64_t lost = 0;               // Missing trades that could not be fetched
+    uint64_t duplicates = 0;         // Trades at or below the last delivered id, dropped
+    uint64_t backfill_requests = 0;  // REST pages requested
+    uint64_t backfill_failures = 0;  // REST pages that threw
+};
+
+/**
+ * @brief Delivers each symbol's trades in id order, fetching gaps over REST
+ *
+ * Trade ids are consecutive per symbol. When a live trade skips ids, the
+ * sequencer holds it and any trades after it, fetches the missing range
+ * with the fetcher (GET /api/v1/historicalTrades?fromId=, which returns
+ * trades after that id), and delivers the
+ * recovered trades before the held ones. Trades at or below the last
+ * delivered id (replays after a reconnect) are dropped. Trades whose id is
+ * not a number pass through unchecked.
+ *
+ * Fetches run on a thread of the sequencer's own so the read loop never
+ * waits for REST. Recovered trades and the held trades after them are
+ * delivered from that thread, under a per-symbol lock that also covers
+ * live delivery, so a symbol's handler never runs twice at once and always
+ * sees ids in order.
+ */
+class TradeSequencer {
+public:
+    /**
+     * @brief Fetch up to limit trades with id > after_id, oldest first
+     *
+     * A fetcher that also returns after_id itself is tolerated; it is dropped.
+     */
+    using Fetcher = std::function<std::vector<Trade>(const std::string& symbol, const std::string& after_id, int limit)>;
+    using Handler = std::function<void(const Trade&)>;
+
+    struct Options {
+        uint64_t max_backfill = 10000;  // Larger gaps are counted as lost instead of fetched
+        int page_size = 1000;           // Trades per REST request
+        size_t max_held = 100000;       // Live trades held per symbol while a gap is fetched
+    };
+
+    explicit TradeSequencer(Fetcher fetcher);
+    TradeSequencer(Fetcher fetcher, Options options);
+
+    /**
+     * @brief Stop the fetch thread; gaps still being fetched are abandoned
+     */
+    ~TradeSequencer();
+
+    TradeSequencer(const TradeSequencer&) = delete;
+    TradeSequencer& operator=(const TradeSequencer&) = delete;
+
+    /**
+     * @brief Route a symbol's trades through the sequencer
+     *
+     * Tracking a symbol again replaces its handler and keeps its position.
+     * The handler must not call track() itself.
+     *
+     * @param symbol Trading pair, as passed to the fetcher
+     * @param handler Receives the symbol's trades in id order
+     * @return Handler to subscribe with in place of handler
+     */
+    Handler track(const std::string& symbol, Handler handler);
+
+    /**
+     * @brief Last delivered trade id for a symbol, or 0 if none
+     */
+    uint64_t last_id(const std::string& symbol) const;
+
+    TradeSequencerStats stats() const;
+
+private:
+    struct Stream;
+
+    void on_trade(Stream& stream, const Trade& trade);
+    void accept_locked(Stream& stream, const Trade& trade);
+    void drain_locked(Stream& stream);
+    void deliver_locked(Stream& stream, const Trade& trade);
+    std::vector<Trade> fetch(const Stream& stream, uint64_t from, uint64_t to);
+    void run();
+
+    Fetcher fetcher_;
+    Options options_;
+
+    mutable std::mutex streams_mutex_;
+    std::map<std::string, std::unique_ptr<Stream>> streams_;
+
+    std::mutex queue_mutex_;
+    std::condition_variable queue_cv_;
+    std::deque<Stream*> queue_;       // Streams waiting for a backfill
+    bool running_ = true;
+    std::thread thread_;
+
+    std::atomic<uint64_t> gaps_{0};
+    std::atomic<uint64_t> missing_{0};
+    std::atomic<uint64_t> recovered_{0};
+    std::atomic<uint64_t> lost_{0};
+    std::atomic<uint64_t> duplicates_{0};
+    std::atomic<uint64_t> backfill_requests_{0};
+    std::atomic<uint64_t> backfill_failures_{0};
+};
+
+} // namespace backpack
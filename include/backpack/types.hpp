@@ -1,6 +1,10 @@
 #pragma once
 
+#include <algorithm>
+#include <memory_resource>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <vector>
 #include <map>
 #include <unordered_map>
@@ -13,6 +17,45 @@ namespace backpack {
 
 using json = nlohmann::json;
 
+// Parse a decimal string field in place, without copying it out of the json value
+inline double json_to_double(const json& j) {
+    return std::stod(j.get_ref<const std::string&>());
+}
+
+// Copy a json string into out, allocating with out's own allocator
+template<typename String>
+inline void json_to_string(String& out, const json& j) {
+    const std::string& value = j.get_ref<const std::string&>();
+    out.assign(value.data(), value.size());
+}
+
+/*
+ * Streamed events (Ticker, Trade, Candle, OrderBook, Order, Balance,
+ * Position) are templates over the allocator of their strings and vectors.
+ * The plain names use std::allocator, so their fields are std::string and
+ * std::vector. The same names in backpack::pmr use polymorphic_allocator;
+ * their from_json() takes the memory resource to decode into, e.g. a
+ * FrameArena from memory.hpp. Copying a pmr event allocates from the
+ * default resource, so copying is the way to keep it beyond the lifetime of
+ * the arena it came from.
+ */
+template<typename Allocator>
+using event_string = std::basic_string<char, std::char_traits<char>, Allocator>;
+
+template<typename T, typename Allocator>
+using event_vector = std::vector<T, typename std::allocator_traits<Allocator>::template rebind_alloc<T>>;
+
+using pmr_allocator = std::pmr::polymorphic_allocator<char>;
+
+// Whether T::from_json can decode into a memory resource (the backpack::pmr event types)
+template<typename T, typename = void>
+struct decodes_into_resource : std::false_type {};
+
+template<typename T>
+struct decodes_into_resource<T, std::void_t<decltype(T::from_json(std::declval<const json&>(),
+                                                                  std::declval<std::pmr::memory_resource*>()))>>
+    : std::true_type {};
+
 // Subscription channels
 enum class Channel {
     TICKER,
@@ -110,6 +153,43 @@ inline std::optional<EventType> string_to_event_type(const std::string& str) {
     return std::nullopt;
 }
 
+// Stream name used in SUBSCRIBE params: "ticker.SOL_USDC", or the bare channel for private streams
+inline std::string stream_name(const std::string& channel, const std::string& symbol) {
+    if (symbol.empty()) {
+        return channel;
+    }
+    std::string stream = channel + "." + symbol;
+    std::replace(stream.begin() + static_cast<std::ptrdiff_t>(channel.size()) + 1, stream.end(), '-', '_');
+    return stream;
+}
+
+// Offset of the '.' before the symbol in a stream name, or npos if the stream has no symbol
+inline size_t stream_symbol_separator(std::string_view stream) {
+    // Some channel names contain a dot themselves
+    if (stream == "user.trades" || (stream.substr(0, 7) == "candle." && stream.find('.', 7) == std::string_view::npos)) {
+        return std::string_view::npos;
+    }
+    return stream.rfind('.');
+}
+
+// Batched stream request: {"method":"SUBSCRIBE","params":[...],"id":N}
+struct StreamRequest {
+    EventType method = EventType::SUBSCRIBE;  // SUBSCRIBE or UNSUBSCRIBE
+    std::vector<std::string> streams;
+    uint64_t id = 0;                          // Echoed in the server's reply; 0 asks for none
+
+    json to_json() const {
+        json j = {
+            {"method", method == EventType::UNSUBSCRIBE ? "UNSUBSCRIBE" : "SUBSCRIBE"},
+            {"params", streams}
+        };
+        if (id != 0) {
+            j["id"] = id;
+        }
+        return j;
+    }
+};
+
 // Subscription request
 struct SubscriptionRequest {
     Channel channel;
@@ -117,24 +197,7 @@ struct SubscriptionRequest {
     bool auth_required = false;
 
     json to_json() const {
-        // Convert symbol format from SOL-USDC to SOL_USDC
-        std::string formatted_symbol = symbol;
-        if (!symbol.empty()) {
-            std::replace(formatted_symbol.begin(), formatted_symbol.end(), '-', '_');
-        }
-
-        // Create the stream name
-        std::string stream = channel_to_string(channel);
-        if (!formatted_symbol.empty()) {
-            stream += "." + formatted_symbol;
-        }
-
-        json j = {
-            {"method", "SUBSCRIBE"},
-            {"params", json::array({stream})}
-        };
-
-        return j;
+        return StreamRequest{EventType::SUBSCRIBE, {stream_name(channel_to_string(channel), symbol)}}.to_json();
     }
 };
 
@@ -144,24 +207,7 @@ struct UnsubscriptionRequest {
     std::string symbol;
 
     json to_json() const {
-        // Convert symbol format from SOL-USDC to SOL_USDC
-        std::string formatted_symbol = symbol;
-        if (!symbol.empty()) {
-            std::replace(formatted_symbol.begin(), formatted_symbol.end(), '-', '_');
-        }
-
-        // Create the stream name
-        std::string stream = channel_to_string(channel);
-        if (!formatted_symbol.empty()) {
-            stream += "." + formatted_symbol;
-        }
-
-        json j = {
-            {"method", "UNSUBSCRIBE"},
-            {"params", json::array({stream})}
-        };
-
-        return j;
+        return StreamRequest{EventType::UNSUBSCRIBE, {stream_name(channel_to_string(channel), symbol)}}.to_json();
     }
 };
 
@@ -179,28 +225,39 @@ struct Credentials {
 using MessageCallback = std::function<void(json)>;
 
 // Ticker data structure
-struct Ticker {
-    std::string symbol;
-    std::string timestamp;
+template<typename Allocator = std::allocator<char>>
+struct BasicTicker {
+    event_string<Allocator> symbol;
+    event_string<Allocator> timestamp;
     double last_price;
     double best_bid;
     double best_ask;
     double volume_24h;
     double price_change_24h;
     
-    static Ticker from_json(const json& j) {
-        Ticker ticker;
-        ticker.symbol = j.at("symbol");
-        ticker.timestamp = j.at("timestamp");
-        ticker.last_price = std::stod(j.at("lastPrice").get<std::string>());
-        ticker.best_bid = std::stod(j.at("bestBid").get<std::string>());
-        ticker.best_ask = std::stod(j.at("bestAsk").get<std::string>());
-        ticker.volume_24h = std::stod(j.at("volume24h").get<std::string>());
-        ticker.price_change_24h = std::stod(j.at("priceChange24h").get<std::string>());
+    BasicTicker() = default;
+    explicit BasicTicker(const Allocator& alloc)
+        : symbol(alloc), timestamp(alloc) {}
+    
+    static BasicTicker from_json(const json& j, const Allocator& alloc = Allocator()) {
+        BasicTicker ticker(alloc);
+        json_to_string(ticker.symbol, j.at("symbol"));
+        json_to_string(ticker.timestamp, j.at("timestamp"));
+        ticker.last_price = json_to_double(j.at("lastPrice"));
+        ticker.best_bid = json_to_double(j.at("bestBid"));
+        ticker.best_ask = json_to_double(j.at("bestAsk"));
+        ticker.volume_24h = json_to_double(j.at("volume24h"));
+        ticker.price_change_24h = json_to_double(j.at("priceChange24h"));
         return ticker;
     }
 };
 
+using Ticker = BasicTicker<>;
+
+namespace pmr {
+using Ticker = BasicTicker<pmr_allocator>;
+} // namespace pmr
+
 // Order book level
 struct OrderBookLevel {
     double price;
@@ -208,27 +265,37 @@ struct OrderBookLevel {
     
     static OrderBookLevel from_json(const json& j) {
         OrderBookLevel level;
-        level.price = std::stod(j[0].get<std::string>());
-        level.quantity = std::stod(j[1].get<std::string>());
+        level.price = json_to_double(j[0]);
+        level.quantity = json_to_double(j[1]);
         return level;
     }
 };
 
 // Order book
-struct OrderBook {
-    std::string symbol;
-    std::vector<OrderBookLevel> bids;
-    std::vector<OrderBookLevel> asks;
+template<typename Allocator = std::allocator<char>>
+struct BasicOrderBook {
+    event_string<Allocator> symbol;
+    event_vector<OrderBookLevel, Allocator> bids;
+    event_vector<OrderBookLevel, Allocator> asks;
     
-    static OrderBook from_json(const json& j) {
-        OrderBook book;
-        book.symbol = j.at("symbol");
+    BasicOrderBook() = default;
+    explicit BasicOrderBook(const Allocator& alloc)
+        : symbol(alloc), bids(alloc), asks(alloc) {}
+    
+    static BasicOrderBook from_json(const json& j, const Allocator& alloc = Allocator()) {
+        BasicOrderBook book(alloc);
+        json_to_string(book.symbol, j.at("symbol"));
+        
+        const json& bids = j.at("bids");
+        const json& asks = j.at("asks");
+        book.bids.reserve(bids.size());
+        book.asks.reserve(asks.size());
         
-        for (const auto& bid : j.at("bids")) {
+        for (const auto& bid : bids) {
             book.bids.push_back(OrderBookLevel::from_json(bid));
         }
         
-        for (const auto& ask : j.at("asks")) {
+        for (const auto& ask : asks) {
             book.asks.push_back(OrderBookLevel::from_json(ask));
         }
         
@@ -236,50 +303,78 @@ struct OrderBook {
     }
 };
 
+using OrderBook = BasicOrderBook<>;
+
+namespace pmr {
+using OrderBook = BasicOrderBook<pmr_allocator>;
+} // namespace pmr
+
 // Trade
-struct Trade {
-    std::string symbol;
-    std::string id;
-    std::string timestamp;
+template<typename Allocator = std::allocator<char>>
+struct BasicTrade {
+    event_string<Allocator> symbol;
+    event_string<Allocator> id;
+    event_string<Allocator> timestamp;
     double price;
     double quantity;
     bool is_buyer_maker;
     
-    static Trade from_json(const json& j) {
-        Trade trade;
-        trade.symbol = j.at("symbol");
-        trade.id = j.at("id");
-        trade.timestamp = j.at("timestamp");
-        trade.price = std::stod(j.at("price").get<std::string>());
-        trade.quantity = std::stod(j.at("quantity").get<std::string>());
+    BasicTrade() = default;
+    explicit BasicTrade(const Allocator& alloc)
+        : symbol(alloc), id(alloc), timestamp(alloc) {}
+    
+    static BasicTrade from_json(const json& j, const Allocator& alloc = Allocator()) {
+        BasicTrade trade(alloc);
+        json_to_string(trade.symbol, j.at("symbol"));
+        json_to_string(trade.id, j.at("id"));
+        json_to_string(trade.timestamp, j.at("timestamp"));
+        trade.price = json_to_double(j.at("price"));
+        trade.quantity = json_to_double(j.at("quantity"));
         trade.is_buyer_maker = j.at("isBuyerMaker").get<bool>();
         return trade;
     }
 };
 
+using Trade = BasicTrade<>;
+
+namespace pmr {
+using Trade = BasicTrade<pmr_allocator>;
+} // namespace pmr
+
 // Candle
-struct Candle {
-    std::string symbol;
-    std::string timestamp;
+template<typename Allocator = std::allocator<char>>
+struct BasicCandle {
+    event_string<Allocator> symbol;
+    event_string<Allocator> timestamp;
     double open;
     double high;
     double low;
     double close;
     double volume;
     
-    static Candle from_json(const json& j) {
-        Candle candle;
-        candle.symbol = j.at("symbol");
-        candle.timestamp = j.at("timestamp");
-        candle.open = std::stod(j.at("open").get<std::string>());
-        candle.high = std::stod(j.at("high").get<std::string>());
-        candle.low = std::stod(j.at("low").get<std::string>());
-        candle.close = std::stod(j.at("close").get<std::string>());
-        candle.volume = std::stod(j.at("volume").get<std::string>());
+    BasicCandle() = default;
+    explicit BasicCandle(const Allocator& alloc)
+        : symbol(alloc), timestamp(alloc) {}
+    
+    static BasicCandle from_json(const json& j, const Allocator& alloc = Allocator()) {
+        BasicCandle candle(alloc);
+        json_to_string(candle.symbol, j.at("symbol"));
+        json_to_string(candle.timestamp, j.at("timestamp"));
+        candle.open = json_to_double(j.at("open"));
+        candle.high = json_to_double(j.at("high"));
+        candle.low = json_to_double(j.at("low"));
+        candle.close = json_to_double(j.at("close"));
+        candle.volume = json_to_double(j.at("volume"));
         return candle;
     }
 };
 
+using Candle = BasicCandle<>;
+
+namespace pmr {
+using Candle = BasicCandle<pmr_allocator>;
+} // namespace pmr
+
 // Order types
 enum class OrderType {
     LIMIT,
@@ -362,79 +457,113 @@ inline std::optional<OrderStatus> string_to_order_status(const std::string& str)
 }
 
 // Order
-struct Order {
-    std::string id;
-    std::string client_order_id;
-    std::string symbol;
+template<typename Allocator = std::allocator<char>>
+struct BasicOrder {
+    event_string<Allocator> id;
+    event_string<Allocator> client_order_id;
+    event_string<Allocator> symbol;
     OrderSide side;
     OrderType type;
     double price;
     double quantity;
     double executed_quantity;
     OrderStatus status;
-    std::string timestamp;
+    event_string<Allocator> timestamp;
+    
+    BasicOrder() = default;
+    explicit BasicOrder(const Allocator& alloc)
+        : id(alloc), client_order_id(alloc), symbol(alloc), timestamp(alloc) {}
     
-    static Order from_json(const json& j) {
-        Order order;
-        order.id = j.at("orderId");
-        order.client_order_id = j.value("clientOrderId", "");
-        order.symbol = j.at("symbol");
+    static BasicOrder from_json(const json& j, const Allocator& alloc = Allocator()) {
+        BasicOrder order(alloc);
+        json_to_string(order.id, j.at("orderId"));
+        auto client_order_id = j.find("clientOrderId");
+        if (client_order_id != j.end() && client_order_id->is_string()) {
+            json_to_string(order.client_order_id, *client_order_id);
+        }
+        json_to_string(order.symbol, j.at("symbol"));
         
-        auto side_str = j.at("side").get<std::string>();
+        const auto& side_str = j.at("side").get_ref<const std::string&>();
         auto side_opt = string_to_order_side(side_str);
         order.side = side_opt.value_or(OrderSide::BUY);
         
-        auto type_str = j.at("type").get<std::string>();
+        const auto& type_str = j.at("type").get_ref<const std::string&>();
         auto type_opt = string_to_order_type(type_str);
         order.type = type_opt.value_or(OrderType::LIMIT);
         
-        order.price = std::stod(j.at("price").get<std::string>());
-        order.quantity = std::stod(j.at("quantity").get<std::string>());
-        order.executed_quantity = std::stod(j.at("executedQty").get<std::string>());
+        order.price = json_to_double(j.at("price"));
+        order.quantity = json_to_double(j.at("quantity"));
+        order.executed_quantity = json_to_double(j.at("executedQty"));
         
-        auto status_str = j.at("status").get<std::string>();
+        const auto& status_str = j.at("status").get_ref<const std::string&>();
         auto status_opt = string_to_order_status(status_str);
         order.status = status_opt.value_or(OrderStatus::NEW);
         
-        order.timestamp = j.at("timestamp");
+        json_to_string(order.timestamp, j.at("timestamp"));
         return order;
     }
 };
 
+using Order = BasicOrder<>;
+
+namespace pmr {
+using Order = BasicOrder<pmr_allocator>;
+} // namespace pmr
+
 // Balance
-struct Balance {
-    std::string asset;
+template<typename Allocator = std::allocator<char>>
+struct BasicBalance {
+    event_string<Allocator> asset;
     double free;
     double locked;
     
-    static Balance from_json(const json& j) {
-        Balance balance;
-        balance.asset = j.at("asset");
-        balance.free = std::stod(j.at("free").get<std::string>());
-        balance.locked = std::stod(j.at("locked").get<std::string>());
+    BasicBalance() = default;
+    explicit BasicBalance(const Allocator& alloc) : asset(alloc) {}
+    
+    static BasicBalance from_json(const json& j, const Allocator& alloc = Allocator()) {
+        BasicBalance balance(alloc);
+        json_to_string(balance.asset, j.at("asset"));
+        balance.free = json_to_double(j.at("free"));
+        balance.locked = json_to_double(j.at("locked"));
         return balance;
     }
 };
 
+using Balance = BasicBalance<>;
+
+namespace pmr {
+using Balance = BasicBalance<pmr_allocator>;
+} // namespace pmr
+
 // Position
-struct Position {
-    std::string symbol;
+template<typename Allocator = std::allocator<char>>
+struct BasicPosition {
+    event_string<Allocator> symbol;
     double size;
     double entry_price;
     double mark_price;
     double unrealized_pnl;
     
-    static Position from_json(const json& j) {
-        Position position;
-        position.symbol = j.at("symbol");
-        position.size = std::stod(j.at("size").get<std::string>());
-        position.entry_price = std::stod(j.at("entryPrice").get<std::string>());
-        position.mark_price = std::stod(j.at("markPrice").get<std::string>());
-        position.unrealized_pnl = std::stod(j.at("unrealizedPnl").get<std::string>());
+    BasicPosition() = default;
+    explicit BasicPosition(const Allocator& alloc) : symbol(alloc) {}
+    
+    static BasicPosition from_json(const json& j, const Allocator& alloc = Allocator()) {
+        BasicPosition position(alloc);
+        json_to_string(position.symbol, j.at("symbol"));
+        position.size = json_to_double(j.at("size"));
+        position.entry_price = json_to_double(j.at("entryPrice"));
+        position.mark_price = json_to_double(j.at("markPrice"));
+        position.unrealized_pnl = json_to_double(j.at("unrealizedPnl"));
         return position;
     }
 };
 
+using Position = BasicPosition<>;
+
+namespace pmr {
+using Position = BasicPosition<pmr_allocator>;
+} // namespace pmr
+
 // Time in force (TIF)
 enum class TimeInForce {
     GTC,  // Good Till Canceled
@@ -510,12 +639,12 @@ struct SymbolInfo {
         info.base_asset = j.at("baseAsset");
         info.quote_asset = j.at("quoteAsset");
         info.is_active = j.at("isActive").get<bool>();
-        info.min_price = std::stod(j.at("minPrice").get<std::string>());
-        info.max_price = std::stod(j.at("maxPrice").get<std::string>());
-        info.tick_size = std::stod(j.at("tickSize").get<std::string>());
-        info.min_qty = std::stod(j.at("minQty").get<std::string>());
-        info.max_qty = std::stod(j.at("maxQty").get<std::string>());
-        info.step_size = std::stod(j.at("stepSize").get<std::string>());
+        info.min_price = json_to_double(j.at("minPrice"));
+        info.max_price = json_to_double(j.at("maxPrice"));
+        info.tick_size = json_to_double(j.at("tickSize"));
+        info.min_qty = json_to_double(j.at("minQty"));
+        info.max_qty = json_to_double(j.at("maxQty"));
+        info.step_size = json_to_double(j.at("stepSize"));
         return info;
     }
 };
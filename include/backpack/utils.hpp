@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <chrono>
 #include <vector>
 #include <openssl/hmac.h>
@@ -10,36 +11,63 @@
 #include <ctime>
 #include <nlohmann/json.hpp>
 
+#include "clock.hpp"
+#include "codec.hpp"
+
 namespace backpack {
 
 using json = nlohmann::json;
 
 /**
  * @brief Get current timestamp in milliseconds since epoch
+ *
+ * Reads the TSC clock when TscClock::enable() has been called, system_clock otherwise.
+ *
  * @return Current timestamp in milliseconds
  */
 inline int64_t get_current_timestamp_ms() {
-    return std::chrono::duration_cast<std::chrono::milliseconds>(
-        std::chrono::system_clock::now().time_since_epoch()
-    ).count();
+    return TscClock::wall_ms();
 }
 
+/**
+ * @brief Length of an ISO8601 timestamp with milliseconds, e.g. 2024-06-11T14:32:00.358Z
+ */
+constexpr size_t ISO8601_MS_LENGTH = 24;
+
+/**
+ * @brief Format a timestamp as ISO8601 UTC with milliseconds into a fixed buffer
+ *
+ * Thread-safe and allocation-free. The date and time prefix is cached per
+ * thread for the current second, so consecutive calls within a second only
+ * write the milliseconds.
+ *
+ * @param timestamp_ms Timestamp in milliseconds since epoch
+ * @param out Destination for exactly ISO8601_MS_LENGTH characters (not NUL-terminated)
+ * @return Number of characters written (always ISO8601_MS_LENGTH)
+ */
+size_t format_iso8601(int64_t timestamp_ms, char* out);
+
+/**
+ * @brief Parse an ISO8601 timestamp into milliseconds since epoch
+ *
+ * Accepts YYYY-MM-DDTHH:MM:SS with an optional fraction of 1-9 digits
+ * (truncated to milliseconds) and an optional Z or +HH:MM/-HH:MM offset;
+ * a timestamp without a zone is taken as UTC. A space may replace the T.
+ *
+ * @param timestamp ISO8601 timestamp, e.g. 2024-06-11T14:32:00.358Z
+ * @return Milliseconds since epoch
+ * @throws std::invalid_argument if the timestamp is malformed
+ */
+int64_t parse_iso8601_ms(std::string_view timestamp);
+
 /**
  * @brief Convert timestamp milliseconds to ISO8601 string
  * @param timestamp_ms Timestamp in milliseconds
  * @return ISO8601 formatted timestamp string
  */
 inline std::string timestamp_to_iso8601(int64_t timestamp_ms) {
-    char buffer[30];
-    time_t seconds = timestamp_ms / 1000;
-    int milliseconds = timestamp_ms % 1000;
-    
-    std::tm* tm_info = std::gmtime(&seconds);
-    strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%S", tm_info);
-    
-    std::ostringstream oss;
-    oss << buffer << '.' << std::setfill('0') << std::setw(3) << milliseconds << 'Z';
-    return oss.str();
+    char buffer[ISO8601_MS_LENGTH];
+    return std::string(buffer, format_iso8601(timestamp_ms, buffer));
 }
 
 /**
@@ -56,13 +84,9 @@ inline std::string generate_hmac_sha256(const std::string& message, const std::s
          reinterpret_cast<const unsigned char*>(message.c_str()), message.length(),
          hash, &hash_len);
     
-    std::ostringstream oss;
-    oss << std::hex << std::setfill('0');
-    for (unsigned int i = 0; i < hash_len; ++i) {
-        oss << std::setw(2) << static_cast<unsigned int>(hash[i]);
-    }
-    
-    return oss.str();
+    std::string hex(2 * hash_len, '\0');
+    codec::hex_encode(hash, hash_len, &hex[0]);
+    return hex;
 }
 
 /**
@@ -109,19 +133,7 @@ inline json generate_auth_payload(const std::string& api_key, const std::string&
  * @return URL encoded string
  */
 inline std::string url_encode(const std::string& str) {
-    std::ostringstream escaped;
-    escaped.fill('0');
-    escaped << std::hex;
-    
-    for (char c : str) {
-        if (isalnum(c) || c == '-' || c == '_' || c == '.' || c == '~') {
-            escaped << c;
-        } else {
-            escaped << '%' << std::setw(2) << int(static_cast<unsigned char>(c));
-        }
-    }
-    
-    return escaped.str();
+    return codec::url_encode(str);
 }
 
 /**
@@ -130,18 +142,20 @@ inline std::string url_encode(const std::string& str) {
  * @return URL encoded query string
  */
 inline std::string build_query_string(const std::map<std::string, std::string>& params) {
-    std::ostringstream oss;
+    std::string query;
     bool first = true;
     
     for (const auto& param : params) {
         if (!first) {
-            oss << "&";
+            query += '&';
         }
-        oss << url_encode(param.first) << "=" << url_encode(param.second);
+        codec::url_encode_append(param.first, query);
+        query += '=';
+        codec::url_encode_append(param.second, query);
         first = false;
     }
     
-    return oss.str();
+    return query;
 }
 
 /**
@@ -150,50 +164,7 @@ inline std::string build_query_string(const std::map<std::string, std::string>&
  * @return Base64 encoded string
  */
 inline std::string base64_encode(const std::string& input) {
-    const char base64_chars[] = 
-        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
-    
-    std::string result;
-    int i = 0;
-    unsigned char char_array_3[3], char_array_4[4];
-    
-    const unsigned char* bytes_to_encode = reinterpret_cast<const unsigned char*>(input.c_str());
-    size_t in_len = input.length();
-    
-    while (in_len--) {
-        char_array_3[i++] = *(bytes_to_encode++);
-        if (i == 3) {
-            char_array_4[0] = (char_array_3[0] & 0xfc) >> 2;
-            char_array_4[1] = ((char_array_3[0] & 0x03) << 4) + ((char_array_3[1] & 0xf0) >> 4);
-            char_array_4[2] = ((char_array_3[1] & 0x0f) << 2) + ((char_array_3[2] & 0xc0) >> 6);
-            char_array_4[3] = char_array_3[2] & 0x3f;
-            
-            for (i = 0; i < 4; i++) {
-                result += base64_chars[char_array_4[i]];
-            }
-            i = 0;
-        }
-    }
-    
-    if (i) {
-        for (int j = i; j < 3; j++) {
-            char_array_3[j] = '\0';
-        }
-        
-        char_array_4[0] = (char_array_3[0] & 0xfc) >> 2;
-        char_array_4[1] = ((char_array_3[0] & 0x03) << 4) + ((char_array_3[1] & 0xf0) >> 4);
-        char_array_4[2] = ((char_array_3[1] & 0x0f) << 2) + ((char_array_3[2] & 0xc0) >> 6);
-        
-        for (int j = 0; j < i + 1; j++) {
-            result += base64_chars[char_array_4[j]];
-        }
-        
-        while (i++ < 3) {
-            result += '=';
-        }
-    }
-    
-    return result;
+    return codec::base64_encode(input);
 }
 
 } // namespace backpack
@@ -13,16 +13,16 @@
 #include <boost/beast/ssl.hpp>
 #include <boost/beast/websocket.hpp>
 #include <boost/beast/websocket/ssl.hpp>
+#include <boost/asio/steady_timer.hpp>
 #include <boost/asio/strand.hpp>
 #include <openssl/evp.h>
 #include <vector>
 #include <stdexcept>
 
-namespace backpack {
+#include "latency.hpp"
+#include "runtime.hpp"
 
-// Base64 helpers
-inline std::string base64_encode(const unsigned char* buf, std::size_t len);
-inline std::string base64_decode(const std::string& in);
+namespace backpack {
 
 namespace beast = boost::beast;
 namespace http = beast::http;
@@ -54,6 +54,11 @@ private:
 class WebSocketClient {
 public:
     WebSocketClient();
+    
+    // Run on a shared runtime's io_context and TLS context instead of an own io thread.
+    // The destructor waits for this client's handlers, so it must not run on a
+    // runtime thread (e.g. inside a callback); doing so aborts instead of deadlocking
+    explicit WebSocketClient(std::shared_ptr<ClientRuntime> runtime);
     ~WebSocketClient();
     
     bool connect(const std::string& uri);
@@ -65,22 +70,55 @@ public:
     void set_open_handler(std::function<void()> handler);
     void set_close_handler(std::function<void()> handler);
     void set_fail_handler(std::function<void(const std::string&)> handler);
+    
+    // Verify against a PEM CA bundle (e.g. a local mock exchange certificate)
+    // instead of the system trust store; throws std::runtime_error when using
+    // a shared runtime, whose TLS context is set with ClientRuntime::set_ca_file()
+    void set_ca_file(const std::string& path);
+    
+    // Run handler every interval on this client's strand while connected, alongside
+    // the read loop; throws std::runtime_error if already connected
+    void set_timer_handler(std::chrono::milliseconds interval, std::function<void()> handler);
+    
+    // Record per-frame latency stages into this tracer (nullptr disables)
+    void set_latency_tracer(std::shared_ptr<LatencyTracer> tracer);
+    
+    // Start no threads; the owner runs I/O and the heartbeat by calling poll() (call before connect)
+    void set_poll_mode(bool enabled);
+    
+    // Run ready I/O completions and timers on the calling thread without blocking,
+    // until none are ready or the budget is used up; returns the number of handlers run
+    // (always 0 on a shared runtime, whose threads or poll() do this instead)
+    size_t poll(std::chrono::microseconds budget = std::chrono::microseconds::zero());
 
 private:
     std::string ed25519_sign_b64(const std::string& msg, const std::string& secret_b64);
     void async_read();
     void handle_disconnect();
-    void start_heartbeat();
+    void schedule_heartbeat();
+    void schedule_timer();
     void cleanup();
     void process_message_queue();
+    
+    // Outstanding handlers that capture this; cleanup() on a shared runtime waits for them
+    void begin_op() { m_pending_ops.fetch_add(1, std::memory_order_relaxed); }
+    void end_op();
+    bool wait_for_ops(std::chrono::milliseconds timeout);
+    struct OpGuard {
+        WebSocketClient* client;
+        ~OpGuard() { client->end_op(); }
+    };
 
-    net::io_context m_ioc;
-    ssl::context m_ssl_ctx;
+    std::shared_ptr<ClientRuntime> m_runtime;
+    std::shared_ptr<net::io_context> m_ioc;
+    std::shared_ptr<ssl::context> m_ssl_ctx;
     websocket::stream<beast::ssl_stream<beast::tcp_stream>> m_ws;
     tcp::resolver m_resolver;
     beast::flat_buffer m_buffer;
+    std::string m_frame;
+    net::steady_timer m_heartbeat_timer;
+    net::steady_timer m_timer;
     std::shared_ptr<std::thread> m_thread;
-    std::shared_ptr<std::thread> m_heartbeat_thread;
     
     std::queue<std::string> m_message_queue;
     std::mutex m_queue_mutex;
@@ -90,12 +128,21 @@ private:
     std::function<void()> m_open_handler;
     std::function<void()> m_close_handler;
     std::function<void(const std::string&)> m_fail_handler;
+    std::function<void()> m_timer_handler;
+    std::chrono::milliseconds m_timer_interval{0};
+    std::shared_ptr<LatencyTracer> m_latency_tracer;
     
     std::string m_last_uri;
     std::atomic<bool> m_connected{false};
     std::atomic<bool> m_running{true};
+    bool m_poll_mode = false;
+    std::atomic<int> m_pending_ops{0};
+    std::mutex m_ops_mutex;
+    std::condition_variable m_ops_cv;
+    std::atomic<uint64_t> m_connect_count{0};
     
     static constexpr int HEARTBEAT_INTERVAL = 30; // seconds
+    static constexpr int CLOSE_TIMEOUT = 5; // seconds
     static constexpr int MAX_RECONNECT_ATTEMPTS = 5;
     static constexpr int QUEUE_MAX_SIZE = 1000;
 };
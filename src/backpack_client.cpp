@@ -1,20 +1,308 @@
 #include "backpack/backpack_client.hpp"
+#include "tracepoints.hpp"
+#include <algorithm>
+#include <cstring>
 #include <iostream>
+#include <stdexcept>
+#include <string_view>
 #include <nlohmann/json.hpp>
 
 namespace backpack {
 
 using json = nlohmann::json;
 
+namespace {
+
+// How often frames the server never answered are sent again, when the watchdog does not tick faster
+constexpr std::chrono::milliseconds SUBSCRIPTION_RETRY_INTERVAL{500};
+
+// Handler key "channel:symbol" built without touching the heap for typical stream names
+class StreamKey {
+public:
+    StreamKey(std::string_view channel, std::string_view symbol) {
+        size_t size = channel.size() + 1 + symbol.size();
+        char* out = buffer_;
+        if (size > sizeof(buffer_)) {
+            overflow_.resize(size);
+            out = overflow_.data();
+        }
+        std::memcpy(out, channel.data(), channel.size());
+        out[channel.size()] = ':';
+        std::memcpy(out + channel.size() + 1, symbol.data(), symbol.size());
+        view_ = std::string_view(out, size);
+    }
+
+    // From a stream name: "ticker.SOL_USDC" -> "ticker:SOL-USDC", "orders" -> "orders:"
+    explicit StreamKey(std::string_view stream) {
+        size_t sep = stream_symbol_separator(stream);
+        std::string_view channel = stream.substr(0, sep);
+        std::string_view symbol = sep == std::string_view::npos ? std::string_view() : stream.substr(sep + 1);
+        size_t size = channel.size() + 1 + symbol.size();
+        char* out = buffer_;
+        if (size > sizeof(buffer_)) {
+            overflow_.resize(size);
+            out = overflow_.data();
+        }
+        std::memcpy(out, channel.data(), channel.size());
+        out[channel.size()] = ':';
+        char* symbol_out = out + channel.size() + 1;
+        std::replace_copy(symbol.begin(), symbol.end(), symbol_out, '_', '-');
+        view_ = std::string_view(out, size);
+    }
+
+    StreamKey(const StreamKey&) = delete;
+    StreamKey& operator=(const StreamKey&) = delete;
+
+    std::string_view view() const { return view_; }
+
+private:
+    char buffer_[64];
+    std::string overflow_;
+    std::string_view view_;
+};
+
+// Releases the frame arena once every handler for the frame has returned
+class ArenaReset {
+public:
+    explicit ArenaReset(FrameArena* arena) : arena_(arena) {}
+    ~ArenaReset() {
+        if (arena_) {
+            arena_->reset();
+        }
+    }
+
+    ArenaReset(const ArenaReset&) = delete;
+    ArenaReset& operator=(const ArenaReset&) = delete;
+
+private:
+    FrameArena* arena_;
+};
+
+} // namespace
+
 BackpackClient::BackpackClient(const std::string& websocket_url, const std::string& rest_url)
+    : BackpackClient(nullptr, websocket_url, rest_url) {}
+
+BackpackClient::BackpackClient(std::shared_ptr<ClientRuntime> runtime, const std::string& websocket_url,
+                               const std::string& rest_url)
     : websocket_url_(websocket_url)
     , rest_url_(rest_url)
-    , ws_client_(std::make_unique<WebSocketClient>())
-    , rest_client_(std::make_unique<RestClient>(rest_url)) {
+    , ws_client_(std::make_unique<WebSocketClient>(runtime))
+    , rest_client_(std::make_unique<RestClient>(rest_url, runtime ? runtime->rest_engine() : nullptr))
+    , latency_tracer_(std::make_shared<LatencyTracer>())
+    , metrics_(std::make_shared<MetricsRegistry>()) {
+    ws_client_->set_latency_tracer(latency_tracer_);
+    rest_client_->set_latency_tracer(latency_tracer_);
+    if (runtime && !runtime->ca_file().empty()) {
+        rest_client_->set_ca_file(runtime->ca_file());
+    }
+    subscriptions_ = std::make_unique<SubscriptionManager>([this](const std::string& frame) {
+        try {
+            ws_client_->send(frame);
+            return true;
+        } catch (const std::exception& e) {
+            std::cerr << "Subscription error: " << e.what() << std::endl;
+            return false;
+        }
+    });
+    register_metric_collectors();
+}
+
+void BackpackClient::register_metric_collectors() {
+    ws_connects_ = &metrics_->counter("backpack_ws_connects_total", "WebSocket connections opened");
+    ws_disconnects_ = &metrics_->counter("backpack_ws_disconnects_total", "WebSocket connections closed or lost");
+    parse_errors_ = &metrics_->counter("backpack_ws_parse_errors_total", "WebSocket frames that failed to parse");
+    ws_connected_ = &metrics_->gauge("backpack_ws_connected", "Whether the WebSocket is connected");
+    ws_subscriptions_ = &metrics_->gauge("backpack_ws_subscriptions", "WebSocket streams with a handler");
+    stream_resubscribes_ = &metrics_->counter("backpack_ws_stream_resubscribes_total",
+                                              "Stale streams resubscribed by the watchdog");
+    parse_time_ns_ = &metrics_->summary("backpack_ws_parse_seconds", "Time to parse a WebSocket frame", {}, 1e9);
+    
+    metrics_->add_collector([this](MetricsWriter& writer) {
+        RestMetrics& rest = rest_client_->metrics();
+        for (const std::string& endpoint : rest.endpoints()) {
+            const EndpointStats* stats = rest.find(endpoint);
+            static const std::pair<const char*, const HdrHistogram EndpointStats::*> phases[] = {
+                {"dns", &EndpointStats::dns_us},
+                {"connect", &EndpointStats::connect_us},
+                {"tls", &EndpointStats::tls_us},
+                {"first_byte", &EndpointStats::first_byte_us},
+                {"total", &EndpointStats::total_us}
+            };
+            for (const auto& phase : phases) {
+                writer.summary("backpack_rest_request_seconds", "REST request time by phase",
+                               {{"endpoint", endpoint}, {"phase", phase.first}}, stats->*phase.second, 1e6);
+            }
+            writer.summary("backpack_rest_response_bytes", "REST response body size",
+                           {{"endpoint", endpoint}}, stats->response_bytes);
+            writer.counter("backpack_rest_requests_total", "REST requests sent",
+                           {{"endpoint", endpoint}}, stats->requests.load(std::memory_order_relaxed));
+            writer.counter("backpack_rest_new_connections_total", "REST requests that opened a new connection",
+                           {{"endpoint", endpoint}}, stats->new_connections.load(std::memory_order_relaxed));
+            writer.counter("backpack_rest_transport_errors_total", "REST requests that failed without a response",
+                           {{"endpoint", endpoint}}, stats->transport_errors.load(std::memory_order_relaxed));
+            writer.counter("backpack_rest_rate_limited_total", "REST requests rejected with 429 Too Many Requests",
+                           {{"endpoint", endpoint}}, stats->status_count(429));
+            for (size_t code = 100; code < stats->status_codes.size(); ++code) {
+                uint64_t count = stats->status_codes[code].load(std::memory_order_relaxed);
+                if (count > 0) {
+                    writer.counter("backpack_rest_responses_total", "REST responses by status code",
+                                   {{"endpoint", endpoint}, {"code", std::to_string(code)}}, count);
+                }
+            }
+        }
+        
+        const ConnectionStats& connections = rest.connections();
+        writer.counter("backpack_rest_orders_total", "Order placement and cancel requests sent",
+                       {}, connections.orders.load(std::memory_order_relaxed));
+        writer.counter("backpack_rest_cold_orders_total", "Orders that had to open a new connection",
+                       {}, connections.cold_orders.load(std::memory_order_relaxed));
+        writer.counter("backpack_rest_pool_requests_total", "Requests sent to open or keep connections warm",
+                       {{"kind", "warm_up"}}, connections.warm_up_requests.load(std::memory_order_relaxed));
+        writer.counter("backpack_rest_pool_requests_total", "Requests sent to open or keep connections warm",
+                       {{"kind", "keepalive"}}, connections.keepalive_requests.load(std::memory_order_relaxed));
+        writer.counter("backpack_rest_pool_connects_total", "Connections opened by warm-up and keepalive",
+                       {}, connections.pool_connects.load(std::memory_order_relaxed));
+        writer.counter("backpack_rest_pool_failures_total", "Warm-up and keepalive requests that failed",
+                       {}, connections.pool_failures.load(std::memory_order_relaxed));
+    });
+    
+    metrics_->add_collector([this](MetricsWriter& writer) {
+        ServerClockEstimator* clock = rest_client_->server_clock();
+        if (!clock) {
+            return;
+        }
+        ServerClockState state = clock->state();
+        writer.gauge("backpack_server_clock_synchronized", "Whether the exchange clock offset has been measured",
+                     {}, state.synchronized ? 1 : 0);
+        writer.gauge("backpack_server_clock_offset_seconds", "Exchange clock minus local clock",
+                     {}, static_cast<double>(state.offset_ns) / 1e9);
+        writer.gauge("backpack_server_clock_uncertainty_seconds", "Error bound of the exchange clock offset",
+                     {}, static_cast<double>(state.uncertainty_ns) / 1e9);
+        writer.gauge("backpack_server_clock_skew_ppm", "Exchange clock drift relative to the local clock",
+                     {}, state.skew_ppm);
+        writer.gauge("backpack_server_clock_min_rtt_seconds", "Shortest server time round trip in the sample window",
+                     {}, static_cast<double>(state.min_rtt_ns) / 1e9);
+        writer.counter("backpack_server_clock_samples_total", "Server time sampling rounds that succeeded",
+                       {}, state.samples);
+        writer.counter("backpack_server_clock_failures_total", "Server time sampling rounds that failed",
+                       {}, state.failures);
+    });
+    
+    metrics_->add_collector([this](MetricsWriter& writer) {
+        if (!watchdog_) {
+            return;
+        }
+        StreamWatchdogStats stats = watchdog_->stats();
+        writer.counter("backpack_ws_stale_events_total", "Times a stream went silent for longer than its SLA",
+                       {}, stats.stale_events);
+        writer.counter("backpack_ws_stale_recoveries_total", "Times a stale stream got a message again",
+                       {}, stats.recoveries);
+        writer.gauge("backpack_ws_stale_streams", "Streams silent for longer than their SLA", {},
+                     static_cast<double>(stats.stale));
+        for (const StreamHealth& health : watchdog_->snapshot(StreamWatchdog::now_ns())) {
+            MetricLabels labels = {{"stream", health.channel + ":" + health.symbol}};
+            writer.gauge("backpack_ws_stream_silence_seconds", "Time since the stream's last message",
+                         labels, static_cast<double>(health.silence.count()) / 1e3);
+            writer.gauge("backpack_ws_stream_sla_seconds", "Silence allowed before the stream counts as stale",
+                         labels, static_cast<double>(health.sla.count()) / 1e3);
+        }
+    });
+    
+    metrics_->add_collector([this](MetricsWriter& writer) {
+        if (!feed_latency_) {
+            return;
+        }
+        FeedLatencySnapshot snapshot = feed_latency_->snapshot();
+        MetricLabels connection = {{"connection", snapshot.connection}};
+        writer.summary("backpack_ws_feed_latency_seconds", "Exchange event time to local receive time",
+                       connection, feed_latency_->histogram(), 1e6);
+        feed_latency_->for_each_stream([&](const std::string& channel, const std::string& symbol,
+                                           const HdrHistogram& histogram) {
+            writer.summary("backpack_ws_stream_feed_latency_seconds",
+                           "Exchange event time to local receive time per stream",
+                           {{"connection", snapshot.connection}, {"stream", channel + ":" + symbol}},
+                           histogram, 1e6);
+        });
+        writer.gauge("backpack_ws_feed_latency_corrected",
+                     "Whether feed latency is corrected by the exchange clock offset",
+                     connection, snapshot.corrected ? 1 : 0);
+        writer.counter("backpack_ws_feed_latency_untimed_total", "Feed messages without an exchange timestamp",
+                       connection, snapshot.untimed);
+        writer.counter("backpack_ws_feed_latency_negative_total",
+                       "Feed messages received before their exchange time", connection, snapshot.negative);
+    });
+    
+    metrics_->add_collector([this](MetricsWriter& writer) {
+        TradeSequencer* sequencer = rest_client_->trade_sequencer();
+        if (!sequencer) {
+            return;
+        }
+        TradeSequencerStats stats = sequencer->stats();
+        writer.counter("backpack_trade_gaps_total", "Times a trade stream skipped ids", {}, stats.gaps);
+        writer.counter("backpack_trade_missing_total", "Trade ids missing from the stream", {}, stats.missing);
+        writer.counter("backpack_trade_recovered_total", "Missing trades fetched over REST", {}, stats.recovered);
+        writer.counter("backpack_trade_lost_total", "Missing trades that could not be fetched", {}, stats.lost);
+        writer.counter("backpack_trade_duplicates_total", "Replayed trades dropped", {}, stats.duplicates);
+        writer.counter("backpack_trade_backfill_requests_total", "Trade history pages requested",
+                       {}, stats.backfill_requests);
+        writer.counter("backpack_trade_backfill_failures_total", "Trade history requests that failed",
+                       {}, stats.backfill_failures);
+    });
+    
+    metrics_->add_collector([this](MetricsWriter& writer) {
+        if (!executor_) {
+            return;
+        }
+        ShardedExecutorStats stats = executor_->stats();
+        writer.counter("backpack_dispatch_tasks_total", "Events run on the sharded executor", {}, stats.executed);
+        writer.counter("backpack_dispatch_steals_total", "Symbols run by a worker other than their home worker",
+                       {}, stats.steals);
+        writer.counter("backpack_dispatch_producer_waits_total", "Times the read loop waited on a full symbol queue",
+                       {}, stats.producer_waits);
+        writer.counter("backpack_dispatch_handler_errors_total", "Callbacks on the sharded executor that threw",
+                       {}, stats.handler_errors);
+    });
+    
+    metrics_->add_collector([this](MetricsWriter& writer) {
+        SubscriptionStats stats = subscriptions_->stats();
+        writer.counter("backpack_ws_subscription_frames_total", "SUBSCRIBE and UNSUBSCRIBE frames sent",
+                       {}, stats.frames);
+        writer.counter("backpack_ws_subscription_streams_total", "Streams carried by subscription frames",
+                       {}, stats.streams);
+        writer.counter("backpack_ws_subscription_replies_total", "Replies to subscription frames",
+                       {{"result", "ok"}}, stats.acks);
+        writer.counter("backpack_ws_subscription_replies_total", "Replies to subscription frames",
+                       {{"result", "error"}}, stats.errors);
+        writer.counter("backpack_ws_subscription_timeouts_total", "Subscription frames with no reply in time",
+                       {}, stats.timeouts);
+        static const char* const STATES[] = {"active", "in_flight", "rejected", "unconfirmed"};
+        const size_t counts[] = {stats.active, stats.in_flight, stats.rejected, stats.unconfirmed};
+        for (size_t i = 0; i < 4; ++i) {
+            writer.gauge("backpack_ws_subscription_streams", "Streams by subscription state",
+                         {{"state", STATES[i]}}, static_cast<double>(counts[i]));
+        }
+    });
+    
+    metrics_->add_collector([this](MetricsWriter& writer) {
+        if (!latency_tracer_->enabled()) {
+            return;
+        }
+        for (size_t i = 0; i < LatencyTracer::STAGE_COUNT; ++i) {
+            auto stage = static_cast<LatencyStage>(i);
+            writer.summary("backpack_latency_stage_seconds", "Time from socket read to each pipeline stage",
+                           {{"stage", latency_stage_to_string(stage)}}, latency_tracer_->histogram(stage), 1e9);
+        }
+    });
 }
 
 BackpackClient::~BackpackClient() {
+    stop_metrics_exporter();
     disconnect();
+    // Close the socket before the members its handlers use; with a shared
+    // runtime they may be running on another thread right now
+    ws_client_.reset();
+    executor_.reset();
 }
 
 void BackpackClient::set_credentials(const std::string& api_key, const std::string& api_secret) {
@@ -23,6 +311,11 @@ void BackpackClient::set_credentials(const std::string& api_key, const std::stri
     rest_client_->set_credentials(api_key, api_secret);
 }
 
+void BackpackClient::set_ca_file(const std::string& path) {
+    ws_client_->set_ca_file(path);
+    rest_client_->set_ca_file(path);
+}
+
 bool BackpackClient::connect() {
     if (connected_) {
         return true;
@@ -32,52 +325,135 @@ bool BackpackClient::connect() {
     ws_client_->set_open_handler([this]() {
         std::lock_guard<std::mutex> lock(mutex_);
         connected_ = true;
+        ws_connects_->inc();
+        ws_connected_->set(1);
+        if (feed_latency_) {
+            feed_latency_->on_connected();
+        }
     });
 
     ws_client_->set_close_handler([this]() {
         std::lock_guard<std::mutex> lock(mutex_);
         connected_ = false;
         authenticated_ = false;
+        ws_disconnects_->inc();
+        ws_connected_->set(0);
+        subscriptions_->on_disconnected();
+        if (watchdog_) {
+            watchdog_->pause();
+        }
     });
 
     ws_client_->set_message_handler([this](const std::string& message) {
-        try {
-            json j = json::parse(message);
-            if (j.contains("type")) {
-                std::string type = j["type"];
-                if (type == "error") {
-                    std::cerr << "WebSocket error: " << j["message"].get<std::string>() << std::endl;
-                    return;
-                }
-                
-                if (type == "authenticated") {
-                    std::lock_guard<std::mutex> lock(mutex_);
-                    authenticated_ = true;
-                    return;
-                }
-                
-                if (type == "subscribed" || type == "unsubscribed") {
-                    return;
-                }
-                
-                if (j.contains("data")) {
-                    std::string channel = j["channel"].get<std::string>();
-                    std::string symbol = j.value("symbol", "");
-                    std::string key = channel + ":" + symbol;
-                    
-                    auto it = message_handlers_.find(key);
-                    if (it != message_handlers_.end()) {
-                        it->second(j["data"]);
-                    }
+        dispatch_message(message);
+    });
+
+    // One timer on the io_context retries subscription frames and drives the watchdog
+    std::chrono::milliseconds tick = SUBSCRIPTION_RETRY_INTERVAL;
+    if (watchdog_) {
+        tick = std::min(tick, watchdog_->options().tick);
+    }
+    ws_client_->set_timer_handler(tick, [this]() { on_timer(); });
+
+    // Connect to WebSocket server
+    if (!ws_client_->connect(websocket_url_)) {
+        return false;
+    }
+    
+    if (watchdog_) {
+        watchdog_->resume(StreamWatchdog::now_ns());
+    }
+    
+    // Send subscriptions that were registered while disconnected
+    subscriptions_->on_connected();
+    flush_subscriptions();
+    
+    return true;
+}
+
+void BackpackClient::dispatch_message(const std::string& message) {
+    ArenaReset arena_reset(frame_arena_.get());
+    // Taken before parsing, so parse time counts towards feed latency
+    int64_t receive_ns = feed_latency_ ? TscClock::wall_ns() : 0;
+    try {
+        BACKPACK_TRACE1(parse_begin, message.size());
+        int64_t parse_start = LatencyTracer::now_ns();
+        json j = json::parse(message);
+        parse_time_ns_->record(LatencyTracer::now_ns() - parse_start);
+        BACKPACK_TRACE1(parse_end, message.size());
+        LatencyTracer::mark(LatencyStage::PARSE_DONE);
+        
+        // {"stream":"ticker.SOL_USDC","data":{...}}
+        auto stream_it = j.find("stream");
+        if (stream_it != j.end()) {
+            StreamKey key(std::string_view(stream_it->get_ref<const std::string&>()));
+            dispatch_data(key.view(), j["data"], receive_ns);
+            return;
+        }
+        
+        // {"id":N,"result":null} or {"id":N,"error":{...}}
+        if (subscriptions_->on_response(j)) {
+            // Streams changed while the reply was outstanding go out now
+            flush_subscriptions();
+            return;
+        }
+        
+        if (j.contains("type")) {
+            const std::string& type = j["type"].get_ref<const std::string&>();
+            if (type == "error") {
+                std::cerr << "WebSocket error: " << j["message"].get<std::string>() << std::endl;
+                return;
+            }
+            
+            if (type == "authenticated") {
+                std::lock_guard<std::mutex> lock(mutex_);
+                authenticated_ = true;
+                return;
+            }
+            
+            if (type == "subscribed" || type == "unsubscribed") {
+                return;
+            }
+            
+            if (j.contains("data")) {
+                const std::string& channel = j["channel"].get_ref<const std::string&>();
+                auto symbol_it = j.find("symbol");
+                std::string_view symbol;
+                if (symbol_it != j.end()) {
+                    symbol = symbol_it->get_ref<const std::string&>();
                 }
+                StreamKey key(channel, symbol);
+                dispatch_data(key.view(), j["data"], receive_ns);
             }
-        } catch (const std::exception& e) {
-            std::cerr << "Error processing message: " << e.what() << std::endl;
         }
-    });
+    } catch (const std::exception& e) {
+        parse_errors_->inc();
+        std::cerr << "Error processing message: " << e.what() << std::endl;
+    }
+}
 
-    // Connect to WebSocket server
-    return ws_client_->connect(websocket_url_);
+void BackpackClient::dispatch_data(std::string_view key, const json& data, int64_t receive_ns) {
+    RcuCell<HandlerMap>::ReadGuard handlers(message_handlers_);
+    auto it = handlers->find(key);
+    if (it != handlers->end()) {
+        BACKPACK_TRACE1(dispatch, it->first.c_str());
+        if (it->second.watch) {
+            it->second.watch->touch(StreamWatchdog::now_ns());
+        }
+        if (it->second.latency) {
+            feed_latency_->record(it->second.latency, data, receive_ns);
+        }
+        it->second(data);
+    }
+}
+
+void BackpackClient::enable_poll_mode(bool enabled) {
+    ws_client_->set_poll_mode(enabled);
+}
+
+size_t BackpackClient::poll(std::chrono::microseconds budget) {
+    size_t handled = rest_client_->poll();
+    return handled + ws_client_->poll(budget);
 }
 
 void BackpackClient::disconnect() {
@@ -88,7 +464,16 @@ void BackpackClient::disconnect() {
     std::lock_guard<std::mutex> lock(mutex_);
     connected_ = false;
     authenticated_ = false;
-    message_handlers_.clear();
+    message_handlers_.update([](HandlerMap& handlers) { handlers.clear(); });
+    if (watchdog_) {
+        watchdog_->untrack_all();
+    }
+    if (feed_latency_) {
+        feed_latency_->untrack_all();
+    }
+    subscriptions_->clear();
+    subscriptions_->on_disconnected();
+    ws_subscriptions_->set(0);
 }
 
 bool BackpackClient::is_connected() const {
@@ -115,67 +500,138 @@ bool BackpackClient::authenticate() {
     }
 }
 
-template<typename T>
-bool BackpackClient::subscribe_to_channel(Channel channel, const std::string& symbol, std::function<void(const T&)> callback) {
-    if (!connected_) {
-        return false;
+Counter& BackpackClient::stream_messages(const std::string& key) {
+    return metrics_->counter("backpack_ws_messages_total", "WebSocket messages dispatched per stream",
+                             {{"stream", key}});
+}
+
+ShardedExecutor::Shard* BackpackClient::stream_shard(const std::string& channel, const std::string& symbol) {
+    return executor_ ? executor_->shard(symbol.empty() ? channel : symbol) : nullptr;
+}
+
+void BackpackClient::log_handler_error(const std::exception& e) {
+    std::cerr << "Error parsing message: " << e.what() << std::endl;
+}
+
+bool BackpackClient::add_handler(const std::string& channel, const std::string& symbol, BoundHandler handler) {
+    std::string key = channel + ":" + symbol;
+    if (watchdog_) {
+        handler.watch = watchdog_->track(channel, symbol);
+    }
+    if (feed_latency_) {
+        handler.latency = feed_latency_->track(channel, symbol);
     }
     
-    try {
-        std::string channel_str = channel_to_string(channel);
-        std::string key = channel_str + ":" + symbol;
-        
-        // Store message handler
-        message_handlers_[key] = [callback](const json& data) {
-            try {
-                T obj = T::from_json(data);
-                callback(obj);
-            } catch (const std::exception& e) {
-                std::cerr << "Error parsing message: " << e.what() << std::endl;
-            }
-        };
-        
-        // Send subscription request
-        json sub = {
-            {"type", "subscribe"},
-            {"channel", channel_str}
-        };
-        
-        if (!symbol.empty()) {
-            sub["symbol"] = symbol;
-        }
-        
-        ws_client_->send(sub.dump());
-        return true;
-    } catch (const std::exception& e) {
-        std::cerr << "Subscription error: " << e.what() << std::endl;
-        return false;
+    // Store message handler; subscriptions made before connect() are sent on connect
+    size_t count = message_handlers_.update([&key, &handler](HandlerMap& handlers) {
+        handlers[key] = std::move(handler);
+        return handlers.size();
+    });
+    ws_subscriptions_->set(static_cast<int64_t>(count));
+    
+    subscriptions_->subscribe(stream_name(channel, symbol));
+    flush_subscriptions();
+    return true;
+}
+
+void BackpackClient::require_no_handlers(const char* method) const {
+    // Every handler's stream is in the desired set until it is unsubscribed
+    if (subscriptions_->stats().desired > 0) {
+        throw std::runtime_error(std::string(method) + " must be called before subscribing");
     }
 }
 
-bool BackpackClient::unsubscribe(Channel channel, const std::string& symbol) {
-    if (!connected_) {
-        return false;
+void BackpackClient::on_timer() {
+    if (watchdog_) {
+        watchdog_->advance(StreamWatchdog::now_ns());
     }
-    
+    // Frames that timed out or could not be sent only go out again from flush()
+    flush_subscriptions();
+}
+
+void BackpackClient::flush_subscriptions() {
+    if (subscription_batches_.load(std::memory_order_acquire) == 0) {
+        subscriptions_->flush();
+    }
+}
+
+BackpackClient::SubscriptionBatch::SubscriptionBatch(BackpackClient& client) : client_(client) {
+    client_.subscription_batches_.fetch_add(1, std::memory_order_acq_rel);
+}
+
+BackpackClient::SubscriptionBatch::~SubscriptionBatch() {
+    if (client_.subscription_batches_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        client_.subscriptions_->flush();
+    }
+}
+
+BackpackClient::SubscriptionBatch BackpackClient::batch_subscriptions() {
+    return SubscriptionBatch(*this);
+}
+
+SubscriptionManager& BackpackClient::subscriptions() {
+    return *subscriptions_;
+}
+
+bool BackpackClient::subscribe_ticker(const std::string& symbol, std::function<void(const Ticker&)> callback) {
+    return subscribe<Ticker>(Channel::TICKER, symbol, std::move(callback));
+}
+
+bool BackpackClient::subscribe_trades(const std::string& symbol, std::function<void(const Trade&)> callback) {
+    if (TradeSequencer* sequencer = rest_client_->trade_sequencer()) {
+        callback = sequencer->track(symbol, std::move(callback));
+    }
+    return subscribe<Trade>(Channel::TRADES, symbol, std::move(callback));
+}
+
+bool BackpackClient::subscribe_candles(const std::string& symbol, Channel interval, std::function<void(const Candle&)> callback) {
+    return subscribe<Candle>(interval, symbol, std::move(callback));
+}
+
+bool BackpackClient::subscribe_depth(const std::string& symbol, std::function<void(const OrderBook&)> callback) {
+    return subscribe<OrderBook>(Channel::DEPTH, symbol, std::move(callback));
+}
+
+bool BackpackClient::subscribe_depth_snapshot(const std::string& symbol, std::function<void(const OrderBook&)> callback) {
+    return subscribe<OrderBook>(Channel::DEPTH_SNAPSHOT, symbol, std::move(callback));
+}
+
+bool BackpackClient::subscribe_user_orders(std::function<void(const Order&)> callback) {
+    return subscribe<Order>(Channel::USER_ORDERS, "", std::move(callback));
+}
+
+bool BackpackClient::subscribe_user_trades(std::function<void(const Trade&)> callback) {
+    return subscribe<Trade>(Channel::USER_TRADES, "", std::move(callback));
+}
+
+bool BackpackClient::subscribe_user_positions(std::function<void(const Position&)> callback) {
+    return subscribe<Position>(Channel::USER_POSITIONS, "", std::move(callback));
+}
+
+bool BackpackClient::subscribe_user_balances(std::function<void(const Balance&)> callback) {
+    return subscribe<Balance>(Channel::USER_BALANCES, "", std::move(callback));
+}
+
+bool BackpackClient::unsubscribe(Channel channel, const std::string& symbol) {
     try {
         std::string channel_str = channel_to_string(channel);
         std::string key = channel_str + ":" + symbol;
         
         // Remove message handler
-        message_handlers_.erase(key);
-        
-        // Send unsubscription request
-        json unsub = {
-            {"type", "unsubscribe"},
-            {"channel", channel_str}
-        };
-        
-        if (!symbol.empty()) {
-            unsub["symbol"] = symbol;
+        size_t count = message_handlers_.update([&key](HandlerMap& handlers) {
+            handlers.erase(key);
+            return handlers.size();
+        });
+        ws_subscriptions_->set(static_cast<int64_t>(count));
+        if (watchdog_) {
+            watchdog_->untrack(channel_str, symbol);
+        }
+        if (feed_latency_) {
+            feed_latency_->untrack(channel_str, symbol);
         }
         
-        ws_client_->send(unsub.dump());
+        subscriptions_->unsubscribe(stream_name(channel_str, symbol));
+        flush_subscriptions();
         return true;
     } catch (const std::exception& e) {
         std::cerr << "Unsubscription error: " << e.what() << std::endl;
@@ -183,6 +639,139 @@ bool BackpackClient::unsubscribe(Channel channel, const std::string& symbol) {
     }
 }
 
+void BackpackClient::enable_latency_tracing(bool enabled) {
+    latency_tracer_->set_enabled(enabled);
+}
+
+void BackpackClient::enable_frame_arena(size_t initial_bytes) {
+    if (initial_bytes == 0) {
+        frame_arena_.reset();
+        event_resource_ = nullptr;
+        return;
+    }
+    frame_arena_ = std::make_unique<FrameArena>(initial_bytes);
+    event_resource_ = frame_arena_->resource();
+}
+
+void BackpackClient::set_event_memory_resource(std::pmr::memory_resource* resource) {
+    frame_arena_.reset();
+    event_resource_ = resource;
+}
+
+void BackpackClient::enable_sharded_dispatch(ShardedExecutor::Options options) {
+    // Bindings keep raw pointers to the executor's shards, so it is never replaced
+    if (executor_) {
+        throw std::runtime_error("Sharded dispatch is already enabled");
+    }
+    require_no_handlers("enable_sharded_dispatch()");
+    executor_ = std::make_unique<ShardedExecutor>(options);
+}
+
+ShardedExecutor* BackpackClient::sharded_executor() {
+    return executor_.get();
+}
+
+void BackpackClient::enable_stream_watchdog(StreamWatchdog::Options options,
+                                            std::function<void(const StaleStreamEvent&)> callback) {
+    // Handlers point at the watchdog's streams, and connect() sizes the timer from its tick
+    if (watchdog_) {
+        throw std::runtime_error("Stream watchdog is already enabled");
+    }
+    if (connected_) {
+        throw std::runtime_error("enable_stream_watchdog() must be called before connect()");
+    }
+    require_no_handlers("enable_stream_watchdog()");
+    watchdog_ = std::make_unique<StreamWatchdog>(options);
+    watchdog_->set_callback([this, resubscribe = options.resubscribe, callback = std::move(callback)](
+                                const StaleStreamEvent& event) {
+        if (!event.recovered && resubscribe &&
+            subscriptions_->resubscribe(stream_name(event.channel, event.symbol))) {
+            stream_resubscribes_->inc();
+        }
+        if (callback) {
+            callback(event);
+        } else if (!event.recovered) {
+            std::cerr << "Stream " << event.channel << ":" << event.symbol << " silent for "
+                      << event.silence.count() << "ms (SLA " << event.sla.count() << "ms)" << std::endl;
+        }
+    });
+}
+
+StreamWatchdog* BackpackClient::stream_watchdog() {
+    return watchdog_.get();
+}
+
+void BackpackClient::enable_feed_latency(FeedLatencyMonitor::Options options) {
+    // Handlers point at the monitor's streams, so it is never replaced
+    if (feed_latency_) {
+        throw std::runtime_error("Feed latency is already enabled");
+    }
+    require_no_handlers("enable_feed_latency()");
+    if (options.connection.empty()) {
+        options.connection = websocket_url_;
+    }
+    RestClient* rest = rest_client_.get();
+    feed_latency_ = std::make_unique<FeedLatencyMonitor>([rest](int64_t& offset_ns) {
+        ServerClockEstimator* clock = rest->server_clock();
+        if (!clock) {
+            return false;
+        }
+        ServerClockState state = clock->state();
+        offset_ns = state.offset_ns;
+        return state.synchronized;
+    }, std::move(options));
+}
+
+FeedLatencyMonitor* BackpackClient::feed_latency() {
+    return feed_latency_.get();
+}
+
+void BackpackClient::enable_server_clock(ServerClockEstimator::Options options) {
+    rest_client_->enable_server_clock(options);
+}
+
+ServerClockEstimator* BackpackClient::server_clock() {
+    return rest_client_->server_clock();
+}
+
+void BackpackClient::enable_trade_recovery(TradeSequencer::Options options) {
+    require_no_handlers("enable_trade_recovery()");
+    rest_client_->enable_trade_recovery(options);
+}
+
+TradeSequencer* BackpackClient::trade_sequencer() {
+    return rest_client_->trade_sequencer();
+}
+
+size_t BackpackClient::warm_up(size_t connections) {
+    return rest_client_->warm_up(connections);
+}
+
+void BackpackClient::enable_keepalive(KeepaliveOptions options) {
+    rest_client_->enable_keepalive(std::move(options));
+}
+
+LatencyTracer& BackpackClient::latency_tracer() {
+    return *latency_tracer_;
+}
+
+RestMetrics& BackpackClient::rest_metrics() {
+    return rest_client_->metrics();
+}
+
+MetricsRegistry& BackpackClient::metrics() {
+    return *metrics_;
+}
+
+unsigned short BackpackClient::start_metrics_exporter(unsigned short port, const std::string& address) {
+    metrics_exporter_ = std::make_unique<MetricsExporter>(metrics_, port, address);
+    return metrics_exporter_->port();
+}
+
+void BackpackClient::stop_metrics_exporter() {
+    metrics_exporter_.reset();
+}
+
 void BackpackClient::ping() {
     if (connected_) {
         ws_client_->send(R"({"type":"ping"})");
@@ -194,6 +783,10 @@ int64_t BackpackClient::get_server_time() {
     return rest_client_->get_server_time();
 }
 
+void BackpackClient::get_server_time_async(AsyncCallback<int64_t> callback) {
+    rest_client_->get_server_time_async(std::move(callback));
+}
+
 ExchangeInfo BackpackClient::get_exchange_info() {
     return rest_client_->get_exchange_info();
 }
@@ -227,6 +820,10 @@ Order BackpackClient::create_order(const OrderRequest& order) {
     return rest_client_->create_order(order);
 }
 
+void BackpackClient::create_order_async(const OrderRequest& order, AsyncCallback<Order> callback) {
+    rest_client_->create_order_async(order, std::move(callback));
+}
+
 bool BackpackClient::test_order(const OrderRequest& order) {
     return rest_client_->test_order(order);
 }
@@ -235,6 +832,11 @@ bool BackpackClient::cancel_order(const std::string& symbol, const std::string&
     return rest_client_->cancel_order(symbol, order_id);
 }
 
+void BackpackClient::cancel_order_async(const std::string& symbol, const std::string& order_id,
+                                        AsyncCallback<bool> callback) {
+    rest_client_->cancel_order_async(symbol, order_id, std::move(callback));
+}
+
 bool BackpackClient::cancel_order_by_client_id(const std::string& symbol, const std::string& client_order_id) {
     return rest_client_->cancel_order_by_client_id(symbol, client_order_id);
 }
@@ -271,4 +873,58 @@ std::vector<Trade> BackpackClient::get_account_trades(const std::string& symbol,
     return rest_client_->get_account_trades(symbol, limit, from_id);
 }
 
+#ifdef BACKPACK_ENABLE_COROUTINES
+AsyncOp<int64_t> BackpackClient::get_server_time_async() {
+    return AsyncOp<int64_t>([this](AsyncCallback<int64_t> callback) {
+        rest_client_->get_server_time_async(std::move(callback));
+    });
+}
+
+AsyncOp<Order> BackpackClient::create_order_async(const OrderRequest& order) {
+    return AsyncOp<Order>([this, order](AsyncCallback<Order> callback) {
+        rest_client_->create_order_async(order, std::move(callback));
+    });
+}
+
+AsyncOp<bool> BackpackClient::cancel_order_async(const std::string& symbol, const std::string& order_id) {
+    return AsyncOp<bool>([this, symbol, order_id](AsyncCallback<bool> callback) {
+        rest_client_->cancel_order_async(symbol, order_id, std::move(callback));
+    });
+}
+
+template<typename T>
+EventStream<T> BackpackClient::open_stream(Channel channel, const std::string& symbol, size_t capacity,
+                                           StreamOverflow overflow) {
+    EventStream<T> stream(capacity, overflow);
+    if (!subscribe<T>(channel, symbol, stream.handler())) {
+        stream.close();
+    }
+    return stream;
+}
+
+EventStream<Ticker> BackpackClient::tickers(const std::string& symbol, size_t capacity, StreamOverflow overflow) {
+    return open_stream<Ticker>(Channel::TICKER, symbol, capacity, overflow);
+}
+
+EventStream<Trade> BackpackClient::trades(const std::string& symbol, size_t capacity, StreamOverflow overflow) {
+    TradeSequencer* sequencer = rest_client_->trade_sequencer();
+    if (!sequencer) {
+        return open_stream<Trade>(Channel::TRADES, symbol, capacity, overflow);
+    }
+    EventStream<Trade> stream(capacity, overflow);
+    if (!subscribe<Trade>(Channel::TRADES, symbol, sequencer->track(symbol, stream.handler()))) {
+        stream.close();
+    }
+    return stream;
+}
+
+EventStream<OrderBook> BackpackClient::depth(const std::string& symbol, size_t capacity, StreamOverflow overflow) {
+    return open_stream<OrderBook>(Channel::DEPTH, symbol, capacity, overflow);
+}
+
+EventStream<Order> BackpackClient::user_orders(size_t capacity, StreamOverflow overflow) {
+    return open_stream<Order>(Channel::USER_ORDERS, "", capacity, overflow);
+}
+#endif
+
 } // namespace backpack
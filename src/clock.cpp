@@ -0,0 +1,169 @@
+#include "backpack/clock.hpp"
+
+#include <mutex>
+#include <thread>
+
+#ifdef BACKPACK_HAS_TSC
+#include <cpuid.h>
+#endif
+
+namespace backpack {
+
+TscClock::State TscClock::state_;
+
+namespace {
+
+// Serializes writers; readers go through the seqlock
+std::mutex anchor_mutex;
+
+int64_t steady_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int64_t system_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+#ifdef BACKPACK_HAS_TSC
+struct Sample {
+    uint64_t tsc;
+    int64_t ns;
+};
+
+// Pair a clock reading with the TSC, keeping the tightest of a few brackets
+// so a preemption between the two reads does not skew the anchor
+template <typename Read>
+Sample sample(Read read) {
+    Sample best{0, 0};
+    uint64_t best_width = UINT64_MAX;
+    for (int i = 0; i < 5; ++i) {
+        uint64_t before = __rdtsc();
+        int64_t ns = read();
+        uint64_t after = __rdtsc();
+        if (after - before < best_width) {
+            best_width = after - before;
+            best = {before + (after - before) / 2, ns};
+        }
+    }
+    return best;
+}
+#endif
+
+} // namespace
+
+bool TscClock::supported() {
+#ifdef BACKPACK_HAS_TSC
+    unsigned eax, ebx, ecx, edx;
+    if (!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx)) {
+        return false;
+    }
+    return (edx & (1u << 8)) != 0;
+#else
+    return false;
+#endif
+}
+
+bool TscClock::enable(std::chrono::milliseconds calibration, std::chrono::milliseconds reanchor_interval) {
+#ifdef BACKPACK_HAS_TSC
+    if (!supported()) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(anchor_mutex);
+
+    Sample start = sample(steady_ns);
+    std::this_thread::sleep_for(calibration);
+    Sample end = sample(steady_ns);
+    if (end.tsc <= start.tsc || end.ns <= start.ns) {
+        return false;
+    }
+    double ns_per_tick = static_cast<double>(end.ns - start.ns) / static_cast<double>(end.tsc - start.tsc);
+    Sample wall = sample(system_ns);
+
+    state_.origin_tsc = start.tsc;
+    state_.origin_steady_ns = start.ns;
+
+    state_.sequence.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    state_.tsc.store(end.tsc, std::memory_order_relaxed);
+    state_.mono_ns.store(end.ns, std::memory_order_relaxed);
+    state_.wall_ns.store(wall.ns - static_cast<int64_t>(static_cast<double>(wall.tsc - end.tsc) * ns_per_tick),
+                         std::memory_order_relaxed);
+    state_.ns_per_tick.store(ns_per_tick, std::memory_order_relaxed);
+    state_.reanchor_ticks.store(static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(reanchor_interval).count() / ns_per_tick),
+        std::memory_order_relaxed);
+    state_.sequence.fetch_add(1, std::memory_order_release);
+
+    state_.enabled.store(true, std::memory_order_release);
+    return true;
+#else
+    (void)calibration;
+    (void)reanchor_interval;
+    return false;
+#endif
+}
+
+void TscClock::disable() {
+    std::lock_guard<std::mutex> lock(anchor_mutex);
+    state_.enabled.store(false, std::memory_order_release);
+}
+
+double TscClock::tsc_hz() {
+    if (!enabled()) {
+        return 0.0;
+    }
+    return 1e9 / load_anchor().ns_per_tick;
+}
+
+void TscClock::reanchor() {
+    std::lock_guard<std::mutex> lock(anchor_mutex);
+    reanchor_locked();
+}
+
+void TscClock::reanchor_locked() {
+#ifdef BACKPACK_HAS_TSC
+    if (!enabled()) {
+        return;
+    }
+
+    Anchor old = load_anchor();
+    Sample wall = sample(system_ns);
+    Sample steady = sample(steady_ns);
+
+    // Monotonic time continues from the old mapping so it never steps;
+    // only the rate is refined, over the full baseline since calibration
+    int64_t mono = old.mono_ns + static_cast<int64_t>(static_cast<double>(steady.tsc - old.tsc) * old.ns_per_tick);
+    double ns_per_tick = old.ns_per_tick;
+    if (steady.tsc > state_.origin_tsc && steady.ns > state_.origin_steady_ns) {
+        ns_per_tick = static_cast<double>(steady.ns - state_.origin_steady_ns) /
+                      static_cast<double>(steady.tsc - state_.origin_tsc);
+    }
+    int64_t wall_at_anchor = wall.ns + static_cast<int64_t>(static_cast<double>(steady.tsc - wall.tsc) * ns_per_tick);
+
+    state_.sequence.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    state_.tsc.store(steady.tsc, std::memory_order_relaxed);
+    state_.mono_ns.store(mono, std::memory_order_relaxed);
+    state_.wall_ns.store(wall_at_anchor, std::memory_order_relaxed);
+    state_.ns_per_tick.store(ns_per_tick, std::memory_order_relaxed);
+    state_.sequence.fetch_add(1, std::memory_order_release);
+#endif
+}
+
+void TscClock::maybe_reanchor() {
+#ifdef BACKPACK_HAS_TSC
+    // Whoever loses the race keeps using the current mapping
+    std::unique_lock<std::mutex> lock(anchor_mutex, std::try_to_lock);
+    if (!lock.owns_lock()) {
+        return;
+    }
+    Anchor anchor = load_anchor();
+    if (__rdtsc() - anchor.tsc > anchor.reanchor_ticks) {
+        reanchor_locked();
+    }
+#endif
+}
+
+} // namespace backpack
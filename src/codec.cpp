@@ -0,0 +1,316 @@
+#include "backpack/codec.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define BACKPACK_CODEC_SSSE3 1
+#include <tmmintrin.h>
+#endif
+
+namespace backpack {
+namespace codec {
+
+namespace {
+
+constexpr char BASE64_CHARS[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+constexpr char HEX_CHARS[] = "0123456789abcdef";
+
+// 256-entry lookup tables built at compile time; -1 marks characters outside the alphabet
+struct Tables {
+    int8_t base64[256];
+    int8_t hex[256];
+    bool unreserved[256];
+
+    constexpr Tables() : base64(), hex(), unreserved() {
+        for (int c = 0; c < 256; ++c) {
+            base64[c] = -1;
+            hex[c] = -1;
+            unreserved[c] = (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') ||
+                            c == '-' || c == '_' || c == '.' || c == '~';
+        }
+        for (int i = 0; i < 64; ++i) {
+            base64[static_cast<unsigned char>(BASE64_CHARS[i])] = static_cast<int8_t>(i);
+        }
+        for (int i = 0; i < 10; ++i) {
+            hex['0' + i] = static_cast<int8_t>(i);
+        }
+        for (int i = 0; i < 6; ++i) {
+            hex['a' + i] = static_cast<int8_t>(10 + i);
+            hex['A' + i] = static_cast<int8_t>(10 + i);
+        }
+    }
+};
+
+constexpr Tables TABLES;
+
+[[noreturn]] void invalid(const char* what) {
+    throw std::invalid_argument(what);
+}
+
+#ifdef BACKPACK_CODEC_SSSE3
+
+bool has_ssse3() {
+    static const bool supported = __builtin_cpu_supports("ssse3");
+    return supported;
+}
+
+// Muła/Lemire: spread 12 input bytes into 16 sextets, then map sextets to ASCII
+// with one shuffle of per-range offsets. Returns input bytes consumed.
+__attribute__((target("ssse3")))
+size_t base64_encode_ssse3(const unsigned char* in, size_t len, char* out) {
+    const __m128i shuffle = _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1);
+    const __m128i offsets = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                          '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+                                          '/' - 63, 'A', 0, 0);
+    size_t i = 0;
+    for (; i + 16 <= len; i += 12, out += 16) {
+        __m128i v = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i)), shuffle);
+        __m128i a = _mm_mulhi_epu16(_mm_and_si128(v, _mm_set1_epi32(0x0fc0fc00)), _mm_set1_epi32(0x04000040));
+        __m128i b = _mm_mullo_epi16(_mm_and_si128(v, _mm_set1_epi32(0x003f03f0)), _mm_set1_epi32(0x01000010));
+        __m128i sextets = _mm_or_si128(a, b);
+
+        __m128i range = _mm_subs_epu8(sextets, _mm_set1_epi8(51));
+        __m128i below_26 = _mm_cmpgt_epi8(_mm_set1_epi8(26), sextets);
+        range = _mm_or_si128(range, _mm_and_si128(below_26, _mm_set1_epi8(13)));
+        __m128i ascii = _mm_add_epi8(_mm_shuffle_epi8(offsets, range), sextets);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), ascii);
+    }
+    return i;
+}
+
+// Classify each character by nibbles to validate and translate 16 characters
+// at a time, then pack 16 sextets into 12 bytes. Returns characters consumed.
+__attribute__((target("ssse3")))
+size_t base64_decode_ssse3(const char* in, size_t len, unsigned char* out) {
+    const __m128i lut_lo = _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                                         0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a);
+    const __m128i lut_hi = _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+                                         0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+    const __m128i lut_roll = _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+    const __m128i mask_2f = _mm_set1_epi8(0x2f);
+    const __m128i pack = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16, out += 12) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        __m128i hi_nibbles = _mm_and_si128(_mm_srli_epi32(v, 4), mask_2f);
+        __m128i lo = _mm_shuffle_epi8(lut_lo, _mm_and_si128(v, mask_2f));
+        __m128i hi = _mm_shuffle_epi8(lut_hi, hi_nibbles);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(lo, hi), _mm_setzero_si128())) != 0xffff) {
+            break;  // Let the scalar path report the offending character
+        }
+        __m128i roll = _mm_shuffle_epi8(lut_roll, _mm_add_epi8(_mm_cmpeq_epi8(v, mask_2f), hi_nibbles));
+        __m128i sextets = _mm_add_epi8(v, roll);
+
+        __m128i pairs = _mm_maddubs_epi16(sextets, _mm_set1_epi32(0x01400140));
+        __m128i words = _mm_madd_epi16(pairs, _mm_set1_epi32(0x00011000));
+        alignas(16) unsigned char bytes[16];
+        _mm_store_si128(reinterpret_cast<__m128i*>(bytes), _mm_shuffle_epi8(words, pack));
+        std::memcpy(out, bytes, 12);
+    }
+    return i;
+}
+
+// Split 16 bytes into nibbles, map through the alphabet and interleave high/low
+__attribute__((target("ssse3")))
+size_t hex_encode_ssse3(const unsigned char* in, size_t len, char* out) {
+    const __m128i alphabet = _mm_loadu_si128(reinterpret_cast<const __m128i*>(HEX_CHARS));
+    const __m128i low_mask = _mm_set1_epi8(0x0f);
+
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16, out += 32) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        __m128i hi = _mm_shuffle_epi8(alphabet, _mm_and_si128(_mm_srli_epi16(v, 4), low_mask));
+        __m128i lo = _mm_shuffle_epi8(alphabet, _mm_and_si128(v, low_mask));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_unpacklo_epi8(hi, lo));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 16), _mm_unpackhi_epi8(hi, lo));
+    }
+    return i;
+}
+
+// Translate 16 hex digits to nibble values, validating range, in one pass
+__attribute__((target("ssse3")))
+bool hex_nibbles_ssse3(__m128i chars, __m128i& nibbles) {
+    __m128i lower = _mm_or_si128(chars, _mm_set1_epi8(0x20));
+    __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(chars, _mm_set1_epi8('0' - 1)),
+                                  _mm_cmpgt_epi8(_mm_set1_epi8('9' + 1), chars));
+    __m128i alpha = _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)),
+                                  _mm_cmpgt_epi8(_mm_set1_epi8('f' + 1), lower));
+    if (_mm_movemask_epi8(_mm_or_si128(digit, alpha)) != 0xffff) {
+        return false;
+    }
+    __m128i bias = _mm_or_si128(_mm_and_si128(digit, _mm_set1_epi8('0')),
+                                _mm_and_si128(alpha, _mm_set1_epi8('a' - 10)));
+    nibbles = _mm_sub_epi8(lower, bias);
+    return true;
+}
+
+__attribute__((target("ssse3")))
+size_t hex_decode_ssse3(const char* in, size_t len, unsigned char* out) {
+    const __m128i weights = _mm_set1_epi16(0x0110);  // high nibble * 16 + low nibble
+
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32, out += 16) {
+        __m128i a, b;
+        if (!hex_nibbles_ssse3(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i)), a) ||
+            !hex_nibbles_ssse3(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i + 16)), b)) {
+            break;
+        }
+        __m128i bytes = _mm_packus_epi16(_mm_maddubs_epi16(a, weights), _mm_maddubs_epi16(b, weights));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), bytes);
+    }
+    return i;
+}
+
+#endif // BACKPACK_CODEC_SSSE3
+
+} // namespace
+
+size_t base64_encode(const void* in, size_t len, char* out) {
+    const auto* bytes = static_cast<const unsigned char*>(in);
+    char* start = out;
+    size_t i = 0;
+
+#ifdef BACKPACK_CODEC_SSSE3
+    if (len >= 16 && has_ssse3()) {
+        i = base64_encode_ssse3(bytes, len, out);
+        out += i / 3 * 4;
+    }
+#endif
+
+    for (; i + 3 <= len; i += 3, out += 4) {
+        uint32_t v = (uint32_t{bytes[i]} << 16) | (uint32_t{bytes[i + 1]} << 8) | bytes[i + 2];
+        out[0] = BASE64_CHARS[v >> 18];
+        out[1] = BASE64_CHARS[(v >> 12) & 63];
+        out[2] = BASE64_CHARS[(v >> 6) & 63];
+        out[3] = BASE64_CHARS[v & 63];
+    }
+
+    if (i < len) {
+        uint32_t v = uint32_t{bytes[i]} << 16;
+        if (i + 1 < len) {
+            v |= uint32_t{bytes[i + 1]} << 8;
+        }
+        out[0] = BASE64_CHARS[v >> 18];
+        out[1] = BASE64_CHARS[(v >> 12) & 63];
+        out[2] = i + 1 < len ? BASE64_CHARS[(v >> 6) & 63] : '=';
+        out[3] = '=';
+        out += 4;
+    }
+    return static_cast<size_t>(out - start);
+}
+
+size_t base64_decode(const char* in, size_t len, unsigned char* out) {
+    // Padding only ever completes the final quad
+    if (len % 4 == 0) {
+        for (int pad = 0; pad < 2 && len > 0 && in[len - 1] == '='; ++pad) {
+            --len;
+        }
+    }
+    if (len % 4 == 1) {
+        invalid("Invalid base64 length");
+    }
+
+    unsigned char* start = out;
+    size_t i = 0;
+
+#ifdef BACKPACK_CODEC_SSSE3
+    if (len >= 16 && has_ssse3()) {
+        i = base64_decode_ssse3(in, len, out);
+        out += i / 4 * 3;
+    }
+#endif
+
+    auto sextet = [in](size_t index) -> uint32_t {
+        int8_t value = TABLES.base64[static_cast<unsigned char>(in[index])];
+        if (value < 0) {
+            invalid("Invalid base64 character");
+        }
+        return static_cast<uint32_t>(value);
+    };
+
+    for (; i + 4 <= len; i += 4, out += 3) {
+        uint32_t v = (sextet(i) << 18) | (sextet(i + 1) << 12) | (sextet(i + 2) << 6) | sextet(i + 3);
+        out[0] = static_cast<unsigned char>(v >> 16);
+        out[1] = static_cast<unsigned char>(v >> 8);
+        out[2] = static_cast<unsigned char>(v);
+    }
+
+    if (i < len) {
+        uint32_t v = (sextet(i) << 18) | (sextet(i + 1) << 12);
+        *out++ = static_cast<unsigned char>(v >> 16);
+        if (i + 2 < len) {
+            v |= sextet(i + 2) << 6;
+            *out++ = static_cast<unsigned char>(v >> 8);
+        }
+    }
+    return static_cast<size_t>(out - start);
+}
+
+size_t hex_encode(const void* in, size_t len, char* out) {
+    const auto* bytes = static_cast<const unsigned char*>(in);
+    size_t i = 0;
+
+#ifdef BACKPACK_CODEC_SSSE3
+    if (len >= 16 && has_ssse3()) {
+        i = hex_encode_ssse3(bytes, len, out);
+    }
+#endif
+
+    for (; i < len; ++i) {
+        out[2 * i] = HEX_CHARS[bytes[i] >> 4];
+        out[2 * i + 1] = HEX_CHARS[bytes[i] & 0x0f];
+    }
+    return 2 * len;
+}
+
+size_t hex_decode(const char* in, size_t len, unsigned char* out) {
+    if (len % 2 != 0) {
+        invalid("Hex input must have an even length");
+    }
+
+    size_t i = 0;
+
+#ifdef BACKPACK_CODEC_SSSE3
+    if (len >= 32 && has_ssse3()) {
+        i = hex_decode_ssse3(in, len, out);
+    }
+#endif
+
+    for (; i < len; i += 2) {
+        int8_t hi = TABLES.hex[static_cast<unsigned char>(in[i])];
+        int8_t lo = TABLES.hex[static_cast<unsigned char>(in[i + 1])];
+        if (hi < 0 || lo < 0) {
+            invalid("Invalid hex character");
+        }
+        out[i / 2] = static_cast<unsigned char>((hi << 4) | lo);
+    }
+    return len / 2;
+}
+
+size_t url_encode(const char* in, size_t len, char* out) {
+    char* start = out;
+    for (size_t i = 0; i < len; ++i) {
+        auto c = static_cast<unsigned char>(in[i]);
+        if (TABLES.unreserved[c]) {
+            *out++ = static_cast<char>(c);
+        } else {
+            out[0] = '%';
+            out[1] = HEX_CHARS[c >> 4];
+            out[2] = HEX_CHARS[c & 0x0f];
+            out += 3;
+        }
+    }
+    return static_cast<size_t>(out - start);
+}
+
+void url_encode_append(std::string_view in, std::string& out) {
+    size_t offset = out.size();
+    out.resize(offset + 3 * in.size());
+    out.resize(offset + url_encode(in.data(), in.size(), &out[offset]));
+}
+
+} // namespace codec
+} // namespace backpack
@@ -0,0 +1,237 @@
+#include "backpack/connection_pool.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+namespace backpack {
+
+namespace {
+
+// Pool requests should never hang the keepalive thread for long
+constexpr long POOL_REQUEST_TIMEOUT_MS = 5000;
+
+size_t discard(char*, size_t size, size_t nmemb, void*) {
+    return size * nmemb;
+}
+
+} // namespace
+
+ConnectionPool::ConnectionPool(std::string base_url, std::shared_ptr<RestEngine> engine, ConnectionStats& stats)
+    : base_url_(std::move(base_url)), engine_(std::move(engine)), stats_(stats) {
+    multi_ = curl_multi_init();
+    if (!multi_) {
+        throw std::runtime_error("Failed to initialize curl multi");
+    }
+    // No multiplexing: each transfer must claim an idle connection or open one
+    curl_multi_setopt(multi_, CURLMOPT_PIPELINING, CURLPIPE_NOTHING);
+}
+
+ConnectionPool::~ConnectionPool() {
+    stop_keepalive();
+    curl_multi_cleanup(multi_);
+}
+
+void ConnectionPool::set_ca_file(const std::string& path) {
+    ca_file_ = path;
+}
+
+void ConnectionPool::attach(CURL* handle) const {
+    engine_->attach(handle);
+    curl_easy_setopt(handle, CURLOPT_MAXAGE_CONN, static_cast<long>(options_.idle_timeout.count()));
+    curl_easy_setopt(handle, CURLOPT_MAXLIFETIME_CONN, static_cast<long>(options_.max_connection_age.count()));
+}
+
+CURLcode ConnectionPool::perform(CURL* handle) {
+    auto lock = lock_transfers();
+    CURLMcode rc = curl_multi_add_handle(multi_, handle);
+    if (rc != CURLM_OK) {
+        throw std::runtime_error("Failed to start request: " + std::string(curl_multi_strerror(rc)));
+    }
+    for (;;) {
+        if (drive() != CURLM_OK) {
+            curl_multi_remove_handle(multi_, handle);
+            finished_.erase(handle);
+            return CURLE_FAILED_INIT;
+        }
+        auto it = finished_.find(handle);
+        if (it != finished_.end()) {
+            CURLcode result = it->second;
+            finished_.erase(it);
+            return result;
+        }
+        curl_multi_poll(multi_, nullptr, 0, 1000, nullptr);
+    }
+}
+
+void ConnectionPool::start(CURL* handle) {
+    auto lock = lock_transfers();
+    CURLMcode rc = curl_multi_add_handle(multi_, handle);
+    if (rc != CURLM_OK) {
+        throw std::runtime_error("Failed to start request: " + std::string(curl_multi_strerror(rc)));
+    }
+    // Get the request onto the wire now rather than at the next collect()
+    drive();
+}
+
+void ConnectionPool::collect(std::vector<std::pair<CURL*, CURLcode>>& done) {
+    auto lock = lock_transfers();
+    drive();
+    for (auto it = finished_.begin(); it != finished_.end();) {
+        if (std::find(batch_.begin(), batch_.end(), it->first) != batch_.end()) {
+            ++it;
+            continue;
+        }
+        done.emplace_back(it->first, it->second);
+        it = finished_.erase(it);
+    }
+}
+
+void ConnectionPool::remove(CURL* handle) {
+    auto lock = lock_transfers();
+    curl_multi_remove_handle(multi_, handle);
+    finished_.erase(handle);
+}
+
+std::unique_lock<std::mutex> ConnectionPool::lock_transfers() {
+    std::unique_lock<std::mutex> lock(transfer_mutex_, std::try_to_lock);
+    if (lock.owns_lock()) {
+        return lock;
+    }
+    // The keepalive thread has it, probably waiting in curl_multi_poll(); make it let go
+    waiters_.fetch_add(1, std::memory_order_acq_rel);
+    curl_multi_wakeup(multi_);
+    lock.lock();
+    waiters_.fetch_sub(1, std::memory_order_release);
+    return lock;
+}
+
+CURLMcode ConnectionPool::drive() {
+    int running = 0;
+    CURLMcode rc = curl_multi_perform(multi_, &running);
+    int queued = 0;
+    while (CURLMsg* message = curl_multi_info_read(multi_, &queued)) {
+        if (message->msg != CURLMSG_DONE) {
+            continue;
+        }
+        CURL* handle = message->easy_handle;
+        CURLcode result = message->data.result;
+        curl_multi_remove_handle(multi_, handle);
+        finished_[handle] = result;
+    }
+    return rc;
+}
+
+size_t ConnectionPool::warm_up(size_t connections) {
+    return run_batch(connections, stats_.warm_up_requests);
+}
+
+void ConnectionPool::start_keepalive(KeepaliveOptions options) {
+    stop_keepalive();
+    options_ = std::move(options);
+    running_ = true;
+    thread_ = std::thread(&ConnectionPool::run_keepalive, this);
+}
+
+void ConnectionPool::stop_keepalive() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_ = false;
+    }
+    cv_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void ConnectionPool::run_keepalive() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (running_) {
+        lock.unlock();
+        run_batch(options_.connections, stats_.keepalive_requests);
+        lock.lock();
+        cv_.wait_for(lock, options_.interval, [this]() { return !running_; });
+    }
+}
+
+size_t ConnectionPool::run_batch(size_t count, std::atomic<uint64_t>& requests) {
+    if (count == 0) {
+        return 0;
+    }
+
+    std::string url = base_url_ + options_.path;
+    std::vector<CURL*> handles;
+    handles.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        CURL* handle = curl_easy_init();
+        if (!handle) {
+            break;
+        }
+        curl_easy_setopt(handle, CURLOPT_URL, url.c_str());
+        curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, discard);
+        curl_easy_setopt(handle, CURLOPT_NOSIGNAL, 1L);
+        curl_easy_setopt(handle, CURLOPT_TIMEOUT_MS, POOL_REQUEST_TIMEOUT_MS);
+        if (!ca_file_.empty()) {
+            curl_easy_setopt(handle, CURLOPT_CAINFO, ca_file_.c_str());
+        }
+        attach(handle);
+        handles.push_back(handle);
+    }
+
+    size_t opened = 0;
+    std::unique_lock<std::mutex> lock(transfer_mutex_);
+    for (CURL* handle : handles) {
+        if (curl_multi_add_handle(multi_, handle) == CURLM_OK) {
+            batch_.push_back(handle);
+        }
+    }
+    while (!batch_.empty()) {
+        if (drive() != CURLM_OK) {
+            for (CURL* handle : batch_) {
+                curl_multi_remove_handle(multi_, handle);
+                finished_.erase(handle);
+            }
+            batch_.clear();
+            break;
+        }
+        for (auto it = batch_.begin(); it != batch_.end();) {
+            auto done = finished_.find(*it);
+            if (done == finished_.end()) {
+                ++it;
+                continue;
+            }
+            requests.fetch_add(1, std::memory_order_relaxed);
+            if (done->second != CURLE_OK) {
+                stats_.pool_failures.fetch_add(1, std::memory_order_relaxed);
+                std::cerr << "Connection warm-up failed: " << curl_easy_strerror(done->second) << std::endl;
+            }
+            long connects = 0;
+            curl_easy_getinfo(*it, CURLINFO_NUM_CONNECTS, &connects);
+            opened += static_cast<size_t>(connects);
+            finished_.erase(done);
+            it = batch_.erase(it);
+        }
+        if (batch_.empty()) {
+            break;
+        }
+        if (waiters_.load(std::memory_order_acquire) > 0) {
+            // A client request is waiting; it drives the round's transfers too while it has the lock
+            lock.unlock();
+            while (waiters_.load(std::memory_order_acquire) > 0) {
+                std::this_thread::yield();
+            }
+            lock.lock();
+            continue;
+        }
+        curl_multi_poll(multi_, nullptr, 0, 1000, nullptr);
+    }
+    lock.unlock();
+    stats_.pool_connects.fetch_add(opened, std::memory_order_relaxed);
+
+    for (CURL* handle : handles) {
+        curl_easy_cleanup(handle);
+    }
+    return opened;
+}
+
+} // namespace backpack
@@ -0,0 +1,155 @@
+#include "backpack/feed_latency.hpp"
+
+#include <algorithm>
+
+#include "backpack/clock.hpp"
+#include "backpack/utils.hpp"
+
+namespace backpack {
+
+namespace {
+
+LatencyPercentiles percentiles(const HdrHistogram& histogram) {
+    LatencyPercentiles result;
+    result.count = histogram.count();
+    if (result.count == 0) {
+        return result;
+    }
+    result.p50 = std::chrono::microseconds(histogram.value_at_percentile(50.0));
+    result.p90 = std::chrono::microseconds(histogram.value_at_percentile(90.0));
+    result.p99 = std::chrono::microseconds(histogram.value_at_percentile(99.0));
+    result.max = std::chrono::microseconds(histogram.max());
+    return result;
+}
+
+} // namespace
+
+FeedLatencyMonitor::FeedLatencyMonitor(OffsetSource source, Options options)
+    : source_(std::move(source)),
+      options_(std::move(options)),
+      max_latency_us_(std::max<int64_t>(std::chrono::microseconds(options_.max_latency).count(), 1000)),
+      connection_histogram_(std::make_unique<HdrHistogram>(max_latency_us_)) {}
+
+int64_t FeedLatencyMonitor::event_time_ns(const nlohmann::json& data) {
+    if (!data.is_object()) {
+        return 0;
+    }
+    // Stream payloads: "E" is the event time in microseconds
+    auto event = data.find("E");
+    if (event != data.end() && event->is_number_integer()) {
+        return event->get<int64_t>() * 1000;
+    }
+    // Legacy payloads: "timestamp" as ISO8601 or milliseconds
+    auto timestamp = data.find("timestamp");
+    if (timestamp == data.end()) {
+        return 0;
+    }
+    if (timestamp->is_number_integer()) {
+        return timestamp->get<int64_t>() * 1000000;
+    }
+    if (timestamp->is_string()) {
+        try {
+            return parse_iso8601_ms(timestamp->get_ref<const std::string&>()) * 1000000;
+        } catch (const std::invalid_argument&) {
+            return 0;
+        }
+    }
+    return 0;
+}
+
+FeedLatencyMonitor::Stream* FeedLatencyMonitor::track(const std::string& channel, const std::string& symbol) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& entry = streams_[channel + ":" + symbol];
+    if (!entry) {
+        entry.reset(new Stream(channel, symbol, max_latency_us_));
+    } else {
+        entry->histogram.reset();
+    }
+    entry->tracked = true;
+    return entry.get();
+}
+
+void FeedLatencyMonitor::untrack(const std::string& channel, const std::string& symbol) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = streams_.find(channel + ":" + symbol);
+    if (it != streams_.end()) {
+        it->second->tracked = false;
+    }
+}
+
+void FeedLatencyMonitor::untrack_all() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& entry : streams_) {
+        entry.second->tracked = false;
+    }
+}
+
+void FeedLatencyMonitor::on_connected() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& entry : streams_) {
+            entry.second->histogram.reset();
+        }
+    }
+    connection_histogram_->reset();
+    connects_.fetch_add(1, std::memory_order_relaxed);
+    refresh_offset(TscClock::wall_ns());
+}
+
+void FeedLatencyMonitor::refresh_offset(int64_t now_ns) {
+    offset_read_ns_.store(now_ns, std::memory_order_relaxed);
+    int64_t offset = 0;
+    bool corrected = source_ && source_(offset);
+    offset_ns_.store(corrected ? offset : 0, std::memory_order_relaxed);
+    corrected_.store(corrected, std::memory_order_relaxed);
+}
+
+void FeedLatencyMonitor::record(Stream* stream, const nlohmann::json& data, int64_t receive_ns) {
+    int64_t event_ns = event_time_ns(data);
+    if (event_ns <= 0) {
+        untimed_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    if (receive_ns - offset_read_ns_.load(std::memory_order_relaxed) >=
+        std::chrono::nanoseconds(options_.offset_refresh).count()) {
+        refresh_offset(receive_ns);
+    }
+
+    // Receive time on the exchange clock, minus the time the exchange stamped
+    int64_t latency_us = (receive_ns + offset_ns_.load(std::memory_order_relaxed) - event_ns) / 1000;
+    if (latency_us < 0) {
+        negative_.fetch_add(1, std::memory_order_relaxed);
+        latency_us = 0;
+    }
+    stream->histogram.record(latency_us);
+    connection_histogram_->record(latency_us);
+}
+
+void FeedLatencyMonitor::for_each_stream(const std::function<void(const std::string&, const std::string&,
+                                                                  const HdrHistogram&)>& fn) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& entry : streams_) {
+        const Stream& stream = *entry.second;
+        if (stream.tracked) {
+            fn(stream.channel, stream.symbol, stream.histogram);
+        }
+    }
+}
+
+FeedLatencySnapshot FeedLatencyMonitor::snapshot() const {
+    FeedLatencySnapshot snapshot;
+    snapshot.connection = options_.connection;
+    snapshot.connects = connects_.load(std::memory_order_relaxed);
+    snapshot.corrected = corrected_.load(std::memory_order_relaxed);
+    snapshot.offset_ns = offset_ns_.load(std::memory_order_relaxed);
+    snapshot.untimed = untimed_.load(std::memory_order_relaxed);
+    snapshot.negative = negative_.load(std::memory_order_relaxed);
+    snapshot.latency = percentiles(*connection_histogram_);
+    for_each_stream([&snapshot](const std::string& channel, const std::string& symbol,
+                                const HdrHistogram& histogram) {
+        snapshot.streams.push_back({channel, symbol, percentiles(histogram)});
+    });
+    return snapshot;
+}
+
+} // namespace backpack
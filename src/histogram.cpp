@@ -0,0 +1,120 @@
+#include "backpack/histogram.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <stdexcept>
+
+namespace backpack {
+
+HdrHistogram::HdrHistogram(int64_t highest_trackable_value, int significant_figures)
+    : highest_trackable_value_(highest_trackable_value)
+    , min_(std::numeric_limits<int64_t>::max()) {
+    if (significant_figures < 1 || significant_figures > 3) {
+        throw std::invalid_argument("HdrHistogram significant_figures must be between 1 and 3");
+    }
+    if (highest_trackable_value < 2) {
+        throw std::invalid_argument("HdrHistogram highest_trackable_value must be at least 2");
+    }
+
+    // Sub-buckets needed to keep the requested precision within each power-of-two bucket
+    int64_t largest_single_unit_resolution = 2 * static_cast<int64_t>(std::pow(10, significant_figures));
+    int sub_bucket_count_magnitude = static_cast<int>(std::ceil(std::log2(static_cast<double>(largest_single_unit_resolution))));
+    sub_bucket_half_count_magnitude_ = (sub_bucket_count_magnitude > 1 ? sub_bucket_count_magnitude : 1) - 1;
+
+    int64_t sub_bucket_count = int64_t{1} << (sub_bucket_half_count_magnitude_ + 1);
+    sub_bucket_half_count_ = sub_bucket_count / 2;
+    sub_bucket_mask_ = static_cast<uint64_t>(sub_bucket_count - 1);
+
+    // Power-of-two buckets needed to reach the highest trackable value
+    int64_t smallest_untrackable_value = sub_bucket_count;
+    int bucket_count = 1;
+    while (smallest_untrackable_value <= highest_trackable_value) {
+        if (smallest_untrackable_value > std::numeric_limits<int64_t>::max() / 2) {
+            ++bucket_count;
+            break;
+        }
+        smallest_untrackable_value <<= 1;
+        ++bucket_count;
+    }
+
+    counts_len_ = static_cast<size_t>(bucket_count + 1) * static_cast<size_t>(sub_bucket_half_count_);
+    counts_ = std::make_unique<std::atomic<uint64_t>[]>(counts_len_);
+    for (size_t i = 0; i < counts_len_; ++i) {
+        counts_[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+int64_t HdrHistogram::min() const {
+    return count() == 0 ? 0 : min_.load(std::memory_order_relaxed);
+}
+
+int64_t HdrHistogram::max() const {
+    return max_.load(std::memory_order_relaxed);
+}
+
+double HdrHistogram::mean() const {
+    uint64_t n = count();
+    return n == 0 ? 0.0 : static_cast<double>(sum_.load(std::memory_order_relaxed)) / static_cast<double>(n);
+}
+
+int64_t HdrHistogram::highest_equivalent_value(size_t index) const {
+    int bucket_index = static_cast<int>(index >> sub_bucket_half_count_magnitude_) - 1;
+    int64_t sub_bucket_index = static_cast<int64_t>(index & static_cast<size_t>(sub_bucket_half_count_ - 1)) + sub_bucket_half_count_;
+    if (bucket_index < 0) {
+        sub_bucket_index -= sub_bucket_half_count_;
+        bucket_index = 0;
+    }
+    int64_t value = sub_bucket_index << bucket_index;
+    return value + (int64_t{1} << bucket_index) - 1;
+}
+
+int64_t HdrHistogram::value_at_percentile(double percentile) const {
+    uint64_t total = count();
+    if (total == 0) {
+        return 0;
+    }
+
+    percentile = std::min(std::max(percentile, 0.0), 100.0);
+    auto target = static_cast<uint64_t>(std::ceil(percentile / 100.0 * static_cast<double>(total)));
+    if (target == 0) {
+        target = 1;
+    }
+
+    uint64_t running = 0;
+    for (size_t i = 0; i < counts_len_; ++i) {
+        running += counts_[i].load(std::memory_order_relaxed);
+        if (running >= target) {
+            return std::min(highest_equivalent_value(i), max());
+        }
+    }
+    return max();
+}
+
+void HdrHistogram::reset() {
+    for (size_t i = 0; i < counts_len_; ++i) {
+        counts_[i].store(0, std::memory_order_relaxed);
+    }
+    total_count_.store(0, std::memory_order_relaxed);
+    sum_.store(0, std::memory_order_relaxed);
+    min_.store(std::numeric_limits<int64_t>::max(), std::memory_order_relaxed);
+    max_.store(0, std::memory_order_relaxed);
+}
+
+void HdrHistogram::print_summary(std::ostream& os, const std::string& name, double scale) const {
+    char line[256];
+    std::snprintf(line, sizeof(line),
+                  "%-24s count=%-10llu mean=%-10.2f p50=%-10.2f p90=%-10.2f p99=%-10.2f p99.9=%-10.2f max=%.2f\n",
+                  name.c_str(),
+                  static_cast<unsigned long long>(count()),
+                  mean() / scale,
+                  static_cast<double>(value_at_percentile(50.0)) / scale,
+                  static_cast<double>(value_at_percentile(90.0)) / scale,
+                  static_cast<double>(value_at_percentile(99.0)) / scale,
+                  static_cast<double>(value_at_percentile(99.9)) / scale,
+                  static_cast<double>(max()) / scale);
+    os << line;
+}
+
+} // namespace backpack
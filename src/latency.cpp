@@ -0,0 +1,24 @@
+#include "backpack/latency.hpp"
+
+namespace backpack {
+
+LatencyTracer::LatencyTracer() {
+    for (auto& histogram : histograms_) {
+        histogram = std::make_unique<HdrHistogram>();
+    }
+}
+
+void LatencyTracer::reset() {
+    for (auto& histogram : histograms_) {
+        histogram->reset();
+    }
+}
+
+void LatencyTracer::dump(std::ostream& os) const {
+    os << "Latency from socket read (us):\n";
+    for (size_t i = 0; i < STAGE_COUNT; ++i) {
+        histograms_[i]->print_summary(os, latency_stage_to_string(static_cast<LatencyStage>(i)), 1000.0);
+    }
+}
+
+} // namespace backpack
@@ -0,0 +1,44 @@
+#include "backpack/memory.hpp"
+
+#include <algorithm>
+
+namespace backpack {
+
+namespace {
+
+constexpr size_t BUFFER_ALIGNMENT = alignof(std::max_align_t);
+
+} // namespace
+
+FrameArena::FrameArena(size_t initial_bytes, std::pmr::memory_resource* upstream)
+    : spill_(upstream), capacity_(std::max<size_t>(initial_bytes, 1024)) {
+    allocate_buffer();
+}
+
+FrameArena::~FrameArena() {
+    arena_.reset();
+    spill_.upstream()->deallocate(buffer_, capacity_, BUFFER_ALIGNMENT);
+}
+
+void FrameArena::reset() {
+    size_t spilled = spill_.spilled;
+    arena_.reset();
+    spill_.spilled = 0;
+
+    if (spilled > 0) {
+        // Grow so a frame of the same size fits inline next time
+        spill_.upstream()->deallocate(buffer_, capacity_, BUFFER_ALIGNMENT);
+        capacity_ += std::max(spilled, capacity_ / 2);
+        ++grows_;
+        allocate_buffer();
+        return;
+    }
+    arena_.emplace(buffer_, capacity_, &spill_);
+}
+
+void FrameArena::allocate_buffer() {
+    buffer_ = static_cast<std::byte*>(spill_.upstream()->allocate(capacity_, BUFFER_ALIGNMENT));
+    arena_.emplace(buffer_, capacity_, &spill_);
+}
+
+} // namespace backpack
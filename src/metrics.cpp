@@ -0,0 +1,167 @@
+#include "backpack/metrics.hpp"
+
+#include <cstdio>
+
+namespace backpack {
+
+namespace {
+
+void append_escaped(std::string& out, const std::string& value) {
+    for (char c : value) {
+        switch (c) {
+            case '\\': out += "\\\\"; break;
+            case '"': out += "\\\""; break;
+            case '\n': out += "\\n"; break;
+            default: out += c; break;
+        }
+    }
+}
+
+void append_value(std::string& out, double value) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.9g", value);
+    out += buffer;
+}
+
+} // namespace
+
+MetricsWriter::Family& MetricsWriter::family(const std::string& name, const std::string& help, const char* type) {
+    Family& family = families_[name];
+    if (family.type.empty()) {
+        family.help = help;
+        family.type = type;
+    }
+    return family;
+}
+
+void MetricsWriter::append_sample(std::string& out, const std::string& name, const MetricLabels& labels, double value,
+                                  const char* extra_label, const char* extra_value) {
+    out += name;
+    if (!labels.empty() || extra_label) {
+        out += '{';
+        bool first = true;
+        for (const auto& label : labels) {
+            if (!first) {
+                out += ',';
+            }
+            out += label.first;
+            out += "=\"";
+            append_escaped(out, label.second);
+            out += '"';
+            first = false;
+        }
+        if (extra_label) {
+            if (!first) {
+                out += ',';
+            }
+            out += extra_label;
+            out += "=\"";
+            out += extra_value;
+            out += '"';
+        }
+        out += '}';
+    }
+    out += ' ';
+    append_value(out, value);
+    out += '\n';
+}
+
+void MetricsWriter::counter(const std::string& name, const std::string& help, const MetricLabels& labels,
+                            uint64_t value) {
+    append_sample(family(name, help, "counter").samples, name, labels, static_cast<double>(value));
+}
+
+void MetricsWriter::gauge(const std::string& name, const std::string& help, const MetricLabels& labels, double value) {
+    append_sample(family(name, help, "gauge").samples, name, labels, value);
+}
+
+void MetricsWriter::summary(const std::string& name, const std::string& help, const MetricLabels& labels,
+                            const HdrHistogram& histogram, double scale) {
+    std::string& out = family(name, help, "summary").samples;
+    static const std::pair<const char*, double> quantiles[] = {
+        {"0.5", 50.0}, {"0.9", 90.0}, {"0.99", 99.0}, {"0.999", 99.9}
+    };
+    for (const auto& quantile : quantiles) {
+        append_sample(out, name, labels, static_cast<double>(histogram.value_at_percentile(quantile.second)) / scale,
+                      "quantile", quantile.first);
+    }
+    append_sample(out, name + "_sum", labels, static_cast<double>(histogram.sum()) / scale);
+    append_sample(out, name + "_count", labels, static_cast<double>(histogram.count()));
+}
+
+std::string MetricsWriter::str() const {
+    std::string out;
+    for (const auto& entry : families_) {
+        out += "# HELP " + entry.first + " " + entry.second.help + "\n";
+        out += "# TYPE " + entry.first + " " + entry.second.type + "\n";
+        out += entry.second.samples;
+    }
+    return out;
+}
+
+std::string MetricsRegistry::series_key(const std::string& name, const MetricLabels& labels) {
+    std::string key = name;
+    for (const auto& label : labels) {
+        key += '\0';
+        key += label.first;
+        key += '\0';
+        key += label.second;
+    }
+    return key;
+}
+
+Counter& MetricsRegistry::counter(const std::string& name, const std::string& help, const MetricLabels& labels) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& series = counters_[series_key(name, labels)];
+    if (!series.metric) {
+        series = {name, help, labels, std::make_unique<Counter>()};
+    }
+    return *series.metric;
+}
+
+Gauge& MetricsRegistry::gauge(const std::string& name, const std::string& help, const MetricLabels& labels) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& series = gauges_[series_key(name, labels)];
+    if (!series.metric) {
+        series = {name, help, labels, std::make_unique<Gauge>()};
+    }
+    return *series.metric;
+}
+
+HdrHistogram& MetricsRegistry::summary(const std::string& name, const std::string& help, const MetricLabels& labels,
+                                       double scale) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& series = summaries_[series_key(name, labels)];
+    if (!series.metric) {
+        series = {name, help, labels, std::make_unique<HdrHistogram>(), scale};
+    }
+    return *series.metric;
+}
+
+void MetricsRegistry::add_collector(Collector collector) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    collectors_.push_back(std::move(collector));
+}
+
+std::string MetricsRegistry::render() const {
+    MetricsWriter writer;
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& entry : counters_) {
+        const auto& series = entry.second;
+        writer.counter(series.name, series.help, series.labels, series.metric->value());
+    }
+    for (const auto& entry : gauges_) {
+        const auto& series = entry.second;
+        writer.gauge(series.name, series.help, series.labels, static_cast<double>(series.metric->value()));
+    }
+    for (const auto& entry : summaries_) {
+        const auto& series = entry.second;
+        writer.summary(series.name, series.help, series.labels, *series.metric, series.scale);
+    }
+    for (const auto& collector : collectors_) {
+        collector(writer);
+    }
+    return writer.str();
+}
+
+} // namespace backpack
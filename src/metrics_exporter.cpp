@@ -0,0 +1,118 @@
+#include "backpack/metrics_exporter.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <boost/asio/ip/address.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+
+namespace backpack {
+
+namespace beast = boost::beast;
+namespace http = beast::http;
+namespace net = boost::asio;
+using tcp = boost::asio::ip::tcp;
+
+namespace {
+
+// Wait between failed accepts; doubles up to the maximum
+constexpr std::chrono::milliseconds MIN_ACCEPT_BACKOFF{100};
+constexpr std::chrono::milliseconds MAX_ACCEPT_BACKOFF{1000};
+
+// One scrape: read a request, render the registry, write the response and close
+class ScrapeSession : public std::enable_shared_from_this<ScrapeSession> {
+public:
+    ScrapeSession(tcp::socket socket, std::shared_ptr<MetricsRegistry> registry)
+        : stream_(std::move(socket)), registry_(std::move(registry)) {}
+
+    void run() {
+        stream_.expires_after(std::chrono::seconds(10));
+        http::async_read(stream_, buffer_, request_,
+            [self = shared_from_this()](const boost::system::error_code& ec, std::size_t) {
+                if (!ec) {
+                    self->respond();
+                }
+            });
+    }
+
+private:
+    void respond() {
+        response_.version(request_.version());
+        response_.keep_alive(false);
+
+        if (request_.method() == http::verb::get && request_.target() == "/metrics") {
+            response_.result(http::status::ok);
+            response_.set(http::field::content_type, "text/plain; version=0.0.4");
+            response_.body() = registry_->render();
+        } else {
+            response_.result(http::status::not_found);
+            response_.set(http::field::content_type, "text/plain");
+            response_.body() = "Not found\n";
+        }
+        response_.prepare_payload();
+
+        http::async_write(stream_, response_,
+            [self = shared_from_this()](const boost::system::error_code&, std::size_t) {
+                boost::system::error_code ignored;
+                self->stream_.socket().shutdown(tcp::socket::shutdown_send, ignored);
+            });
+    }
+
+    beast::tcp_stream stream_;
+    std::shared_ptr<MetricsRegistry> registry_;
+    beast::flat_buffer buffer_;
+    http::request<http::string_body> request_;
+    http::response<http::string_body> response_;
+};
+
+} // namespace
+
+MetricsExporter::MetricsExporter(std::shared_ptr<MetricsRegistry> registry, unsigned short port,
+                                 const std::string& address)
+    : registry_(std::move(registry))
+    , acceptor_(ioc_, tcp::endpoint(net::ip::make_address(address), port))
+    , accept_timer_(ioc_)
+    , accept_backoff_(MIN_ACCEPT_BACKOFF) {
+    do_accept();
+    thread_ = std::thread([this]() { ioc_.run(); });
+}
+
+MetricsExporter::~MetricsExporter() {
+    ioc_.stop();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+unsigned short MetricsExporter::port() const {
+    return acceptor_.local_endpoint().port();
+}
+
+void MetricsExporter::do_accept() {
+    acceptor_.async_accept([this](const boost::system::error_code& ec, tcp::socket socket) {
+        if (ec == net::error::operation_aborted) {
+            return;
+        }
+        if (!ec) {
+            accept_backoff_ = MIN_ACCEPT_BACKOFF;
+            std::make_shared<ScrapeSession>(std::move(socket), registry_)->run();
+            do_accept();
+            return;
+        }
+
+        // Errors such as EMFILE fail again immediately; retrying at once would spin this thread
+        std::cerr << "Metrics exporter accept failed: " << ec.message() << ", retrying in "
+                  << accept_backoff_.count() << "ms" << std::endl;
+        accept_timer_.expires_after(accept_backoff_);
+        accept_backoff_ = std::min(accept_backoff_ * 2, MAX_ACCEPT_BACKOFF);
+        accept_timer_.async_wait([this](const boost::system::error_code& ec) {
+            if (!ec) {
+                do_accept();
+            }
+        });
+    });
+}
+
+} // namespace backpack
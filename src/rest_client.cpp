@@ -1,4 +1,6 @@
 #include "backpack/rest_client.hpp"
+#include "backpack/codec.hpp"
+#include "tracepoints.hpp"
 #include <iostream>
 #include <sstream>
 #include <vector>
@@ -6,77 +8,75 @@
 #include <stdexcept>
 #include <curl/curl.h>
 #include <openssl/evp.h>
-#include <openssl/bio.h>
-#include <openssl/buffer.h>
 #include <openssl/pem.h> // For potential PEM decoding if needed, raw key is likely sufficient
 #include <openssl/hmac.h> // Keep for now? No, remove if not used.
 #include <openssl/sha.h> // Keep for now? No, remove if not used.
-#include <iomanip> // for hex conversion if needed, base64 is needed now.
 
 namespace backpack {
 
-// Helper function for Base64 Decoding
-std::vector<unsigned char> base64_decode(const std::string& encoded_string) {
-    BIO *bio, *b64;
-    int decode_len = encoded_string.length() * 3 / 4; // Estimate length
-    std::vector<unsigned char> buffer(decode_len);
-
-    bio = BIO_new_mem_buf(encoded_string.c_str(), -1);
-    b64 = BIO_new(BIO_f_base64());
-    bio = BIO_push(b64, bio);
-
-    BIO_set_flags(bio, BIO_FLAGS_BASE64_NO_NL); // No newlines in input
-    int length = BIO_read(bio, buffer.data(), encoded_string.length());
-    BIO_free_all(bio);
-
-    if (length < 0) {
-        throw std::runtime_error("Failed to decode base64 private key");
-    }
-    buffer.resize(length); // Adjust buffer size to actual decoded length
-    return buffer;
+struct RestClient::AsyncRequest {
+    std::string endpoint;
+    HttpMethod method;
+    std::string body;  // CURLOPT_POSTFIELDS points into it
+    std::string response_data;
+    struct curl_slist* headers = nullptr;
+    std::function<void(json, std::exception_ptr)> on_response;
+    LatencyTracer::Origin trace;  // The order's trace, finished when poll() collects the response
+};
+
+namespace {
+
+// Adapt a typed callback to raw JSON; a conversion error is reported like a request error
+template<typename T, typename Convert>
+std::function<void(json, std::exception_ptr)> typed_callback(AsyncCallback<T> callback, Convert convert) {
+    return [callback = std::move(callback), convert](json response, std::exception_ptr error) {
+        T result{};
+        if (!error) {
+            try {
+                result = convert(response);
+            } catch (...) {
+                error = std::current_exception();
+            }
+        }
+        callback(std::move(result), error);
+    };
 }
 
-// Helper function for Base64 Encoding
-std::string base64_encode(const unsigned char* buffer, size_t length) {
-    BIO *bio, *b64;
-    BUF_MEM *buffer_ptr;
-
-    b64 = BIO_new(BIO_f_base64());
-    bio = BIO_new(BIO_s_mem());
-    bio = BIO_push(b64, bio);
-
-    BIO_set_flags(bio, BIO_FLAGS_BASE64_NO_NL); // No newlines in output
-    BIO_write(bio, buffer, length);
-    BIO_flush(bio);
-    BIO_get_mem_ptr(bio, &buffer_ptr);
-    
-    std::string encoded_string(buffer_ptr->data, buffer_ptr->length);
-    
-    BIO_free_all(bio); // Also frees b64
-    // BUF_MEM_free(buffer_ptr) is done by BIO_free_all
-
-    return encoded_string;
-}
+} // namespace
 
-RestClient::RestClient(const std::string& base_url)
-    : base_url_(base_url) {
+RestClient::RestClient(const std::string& base_url, std::shared_ptr<RestEngine> engine)
+    : base_url_(base_url)
+    , engine_(engine ? std::move(engine) : std::make_shared<RestEngine>()) {
     
-    // Initialize curl
-    curl_global_init(CURL_GLOBAL_DEFAULT);
+    // Initialize curl (the engine has done the global init)
     curl_ = curl_easy_init();
     
     if (!curl_) {
         throw std::runtime_error("Failed to initialize curl");
     }
+    pool_ = std::make_unique<ConnectionPool>(base_url_, engine_, metrics_.connections());
 }
 
 RestClient::~RestClient() {
-    // Clean up curl
+    // The estimator's and sequencer's threads use curl too, so stop them before releasing the engine
+    server_clock_.reset();
+    trade_sequencer_.reset();
+    
+    // Clean up curl; the handles must be gone before the share they use
+    pool_->stop_keepalive();
+    for (auto& entry : async_requests_) {
+        pool_->remove(entry.first);
+        curl_easy_cleanup(entry.first);
+        curl_slist_free_all(entry.second->headers);
+    }
+    for (CURL* handle : idle_handles_) {
+        curl_easy_cleanup(handle);
+    }
     if (curl_) {
         curl_easy_cleanup(curl_);
         curl_ = nullptr;
     }
-    curl_global_cleanup();
+    pool_.reset();
 }
 
 void RestClient::set_credentials(const std::string& api_key, const std::string& base64_private_key) {
@@ -90,11 +90,93 @@ bool RestClient::has_credentials() const {
     return credentials_.is_valid();
 }
 
+void RestClient::set_ca_file(const std::string& path) {
+    ca_file_ = path;
+    pool_->set_ca_file(path);
+}
+
+void RestClient::set_request_timeout(std::chrono::milliseconds timeout) {
+    request_timeout_ = timeout;
+}
+
+void RestClient::set_latency_tracer(std::shared_ptr<LatencyTracer> tracer) {
+    latency_tracer_ = std::move(tracer);
+}
+
+RestMetrics& RestClient::metrics() {
+    return metrics_;
+}
+
+void RestClient::enable_server_clock(ServerClockEstimator::Options options) {
+    // Other threads read the estimator without a lock, so it is never replaced
+    if (server_clock_) {
+        throw std::runtime_error("Server clock is already enabled");
+    }
+    
+    // Sampling runs on another thread, so it needs its own handle
+    auto time_client = std::make_shared<RestClient>(base_url_, engine_);
+    if (!ca_file_.empty()) {
+        time_client->set_ca_file(ca_file_);
+    }
+    time_client->set_request_timeout(request_timeout_.count() > 0 ? request_timeout_ : std::chrono::seconds(5));
+    
+    server_clock_ = std::make_unique<ServerClockEstimator>(
+        [time_client]() { return time_client->get_server_time(); }, options);
+    server_clock_->start();
+}
+
+ServerClockEstimator* RestClient::server_clock() {
+    return server_clock_.get();
+}
+
+void RestClient::enable_trade_recovery(TradeSequencer::Options options) {
+    // Handlers from track() point into the sequencer, so it is never replaced
+    if (trade_sequencer_) {
+        throw std::runtime_error("Trade recovery is already enabled");
+    }
+    
+    // Backfill runs on the sequencer's thread, so it needs its own handle
+    auto backfill_client = std::make_shared<RestClient>(base_url_, engine_);
+    if (!ca_file_.empty()) {
+        backfill_client->set_ca_file(ca_file_);
+    }
+    backfill_client->credentials_ = credentials_;
+    backfill_client->set_request_timeout(request_timeout_.count() > 0 ? request_timeout_ : std::chrono::seconds(5));
+    
+    trade_sequencer_ = std::make_unique<TradeSequencer>(
+        [backfill_client](const std::string& symbol, const std::string& after_id, int limit) {
+            return backfill_client->get_historical_trades(symbol, limit, after_id);
+        }, options);
+}
+
+TradeSequencer* RestClient::trade_sequencer() {
+    return trade_sequencer_.get();
+}
+
+size_t RestClient::warm_up(size_t connections) {
+    return pool_->warm_up(connections);
+}
+
+void RestClient::enable_keepalive(KeepaliveOptions options) {
+    pool_->start_keepalive(std::move(options));
+}
+
+void RestClient::disable_keepalive() {
+    pool_->stop_keepalive();
+}
+
 int64_t RestClient::get_server_time() {
     json response = send_request("/api/v1/time", HttpMethod::GET);
     return response["serverTime"].get<int64_t>();
 }
 
+void RestClient::get_server_time_async(AsyncCallback<int64_t> callback) {
+    send_request_async("/api/v1/time", HttpMethod::GET, {}, "", false,
+        typed_callback<int64_t>(std::move(callback), [](const json& response) {
+            return response.at("serverTime").get<int64_t>();
+        }));
+}
+
 ExchangeInfo RestClient::get_exchange_info() {
     json response = send_request("/api/v1/exchangeInfo", HttpMethod::GET);
     return ExchangeInfo::from_json(response);
@@ -218,12 +300,43 @@ Order RestClient::create_order(const OrderRequest& order_request) {
         throw std::runtime_error("API credentials not set");
     }
     
+    LatencyTracer::Scope trace(latency_tracer_.get(), true);
     std::string body = order_request.to_json().dump();
-    json response = send_request("/api/v1/order", HttpMethod::POST, {}, body, true);
+    LatencyTracer::mark(LatencyStage::ORDER_ENCODE);
+    BACKPACK_TRACE2(order_send, order_request.symbol.c_str(), body.size());
+    json response;
+    try {
+        response = send_request("/api/v1/order", HttpMethod::POST, {}, body, true);
+    } catch (...) {
+        BACKPACK_TRACE2(order_complete, order_request.symbol.c_str(), 0);
+        throw;
+    }
+    BACKPACK_TRACE2(order_complete, order_request.symbol.c_str(), 1);
     
     return Order::from_json(response);
 }
 
+void RestClient::create_order_async(const OrderRequest& order_request, AsyncCallback<Order> callback) {
+    if (!has_credentials()) {
+        throw std::runtime_error("API credentials not set");
+    }
+    
+    LatencyTracer::Scope trace(latency_tracer_.get(), true);
+    std::string body = order_request.to_json().dump();
+    LatencyTracer::mark(LatencyStage::ORDER_ENCODE);
+    BACKPACK_TRACE2(order_send, order_request.symbol.c_str(), body.size());
+    
+    AsyncCallback<Order> traced = [callback = std::move(callback), symbol = std::string(order_request.symbol)](
+                                      Order order, std::exception_ptr error) {
+        BACKPACK_TRACE2(order_complete, symbol.c_str(), error ? 0 : 1);
+        callback(std::move(order), error);
+    };
+    send_request_async("/api/v1/order", HttpMethod::POST, {}, std::move(body), true,
+        typed_callback<Order>(std::move(traced), [](const json& response) {
+            return Order::from_json(response);
+        }));
+}
+
 bool RestClient::test_order(const OrderRequest& order_request) {
     if (!has_credentials()) {
         throw std::runtime_error("API credentials not set");
@@ -258,6 +371,21 @@ bool RestClient::cancel_order(const std::string& symbol, const std::string& orde
     }
 }
 
+void RestClient::cancel_order_async(const std::string& symbol, const std::string& order_id,
+                                    AsyncCallback<bool> callback) {
+    if (!has_credentials()) {
+        throw std::runtime_error("API credentials not set");
+    }
+    
+    std::map<std::string, std::string> params = {
+        {"symbol", symbol},
+        {"orderId", order_id}
+    };
+    
+    send_request_async("/api/v1/order", HttpMethod::DELETE, params, "", true,
+        typed_callback<bool>(std::move(callback), [](const json&) { return true; }));
+}
+
 bool RestClient::cancel_order_by_client_id(const std::string& symbol, const std::string& client_order_id) {
     if (!has_credentials()) {
         throw std::runtime_error("API credentials not set");
@@ -414,6 +542,124 @@ std::vector<Trade> RestClient::get_account_trades(const std::string& symbol, int
 json RestClient::send_request(const std::string& endpoint, HttpMethod method, 
                              const std::map<std::string, std::string>& params,
                              const std::string& body, bool auth_required) {
+    std::string response_data;
+    struct curl_slist* headers = prepare_request(curl_, endpoint, method, params, body, auth_required, response_data);
+    
+    // Perform request on the pool's connections
+    CURLcode res;
+    try {
+        res = pool_->perform(curl_);
+    } catch (...) {
+        curl_slist_free_all(headers);
+        throw;
+    }
+    LatencyTracer::mark(LatencyStage::WRITE_COMPLETE);
+    record_request_metrics(curl_, endpoint, method, res, response_data.size());
+    
+    // Clean up headers
+    curl_slist_free_all(headers);
+    
+    return parse_response(curl_, res, response_data);
+}
+
+void RestClient::send_request_async(const std::string& endpoint, HttpMethod method,
+                                    const std::map<std::string, std::string>& params, std::string body,
+                                    bool auth_required,
+                                    std::function<void(json response, std::exception_ptr error)> on_response) {
+    CURL* handle;
+    if (!idle_handles_.empty()) {
+        handle = idle_handles_.back();
+        idle_handles_.pop_back();
+    } else {
+        handle = curl_easy_init();
+        if (!handle) {
+            throw std::runtime_error("Failed to initialize curl");
+        }
+    }
+    
+    auto request = std::make_unique<AsyncRequest>();
+    request->endpoint = endpoint;
+    request->method = method;
+    request->body = std::move(body);
+    request->on_response = std::move(on_response);
+    request->trace = LatencyTracer::current();
+    try {
+        request->headers = prepare_request(handle, endpoint, method, params, request->body, auth_required,
+                                           request->response_data);
+    } catch (...) {
+        idle_handles_.push_back(handle);
+        throw;
+    }
+    
+    try {
+        pool_->start(handle);
+    } catch (...) {
+        curl_slist_free_all(request->headers);
+        idle_handles_.push_back(handle);
+        throw;
+    }
+    async_requests_.emplace(handle, std::move(request));
+}
+
+size_t RestClient::poll() {
+    if (async_requests_.empty()) {
+        return 0;
+    }
+    
+    std::vector<std::pair<CURL*, CURLcode>> finished;
+    pool_->collect(finished);
+    
+    struct Completion {
+        std::unique_ptr<AsyncRequest> request;
+        json response;
+        std::exception_ptr error;
+    };
+    std::vector<Completion> completions;
+    
+    for (const auto& transfer : finished) {
+        CURL* handle = transfer.first;
+        CURLcode result = transfer.second;
+        auto it = async_requests_.find(handle);
+        if (it == async_requests_.end()) {
+            continue;
+        }
+        
+        Completion completion{std::move(it->second), json(), nullptr};
+        async_requests_.erase(it);
+        
+        AsyncRequest& request = *completion.request;
+        request.trace.mark(LatencyStage::WRITE_COMPLETE);
+        record_request_metrics(handle, request.endpoint, request.method, result, request.response_data.size());
+        curl_slist_free_all(request.headers);
+        request.headers = nullptr;
+        try {
+            completion.response = parse_response(handle, result, request.response_data);
+        } catch (...) {
+            completion.error = std::current_exception();
+        }
+        idle_handles_.push_back(handle);
+        completions.push_back(std::move(completion));
+    }
+    
+    // Callbacks run last so they can start new requests
+    for (Completion& completion : completions) {
+        try {
+            completion.request->on_response(std::move(completion.response), completion.error);
+        } catch (const std::exception& e) {
+            std::cerr << "Async request callback error: " << e.what() << std::endl;
+        }
+    }
+    return completions.size();
+}
+
+size_t RestClient::pending_requests() const {
+    return async_requests_.size();
+}
+
+struct curl_slist* RestClient::prepare_request(CURL* handle, const std::string& endpoint, HttpMethod method,
+                                               const std::map<std::string, std::string>& params,
+                                               const std::string& body, bool auth_required,
+                                               std::string& response_data) {
     std::string url = base_url_ + endpoint;
     
     // Add query parameters
@@ -430,12 +676,17 @@ json RestClient::send_request(const std::string& endpoint, HttpMethod method,
     }
     
     // Set up request
-    curl_easy_reset(curl_);
-    curl_easy_setopt(curl_, CURLOPT_URL, url.c_str());
-    curl_easy_setopt(curl_, CURLOPT_WRITEFUNCTION, write_callback);
-    
-    std::string response_data;
-    curl_easy_setopt(curl_, CURLOPT_WRITEDATA, &response_data);
+    curl_easy_reset(handle);
+    pool_->attach(handle);
+    curl_easy_setopt(handle, CURLOPT_URL, url.c_str());
+    curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, write_callback);
+    if (!ca_file_.empty()) {
+        curl_easy_setopt(handle, CURLOPT_CAINFO, ca_file_.c_str());
+    }
+    if (request_timeout_.count() > 0) {
+        curl_easy_setopt(handle, CURLOPT_TIMEOUT_MS, static_cast<long>(request_timeout_.count()));
+    }
+    curl_easy_setopt(handle, CURLOPT_WRITEDATA, &response_data);
     
     // Set up headers
     struct curl_slist* headers = nullptr;
@@ -443,61 +694,61 @@ json RestClient::send_request(const std::string& endpoint, HttpMethod method,
     
     if (auth_required) {
         if (!has_credentials()) {
+            curl_slist_free_all(headers);
             throw std::runtime_error("API credentials not set");
         }
         
-        int64_t timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(
-            std::chrono::system_clock::now().time_since_epoch()
-        ).count();
+        // Wall time (the exchange checks it against its own clock); TSC-backed when enabled
+        int64_t timestamp = server_clock_ ? server_clock_->now_ms() : get_current_timestamp_ms();
         
-        // Use a monotonic clock source if system_clock can go backwards
-        // std::chrono::steady_clock could be an alternative if strictly monotonic is required
-        // However, Backpack likely expects wall time (UTC) for the timestamp.
-        // Ensure server time is synced (e.g., via NTP).
-        
-        std::string signature = sign_request(method, endpoint, timestamp, params, body);
+        std::string signature;
+        try {
+            signature = sign_request(method, timestamp, body);
+        } catch (...) {
+            curl_slist_free_all(headers);
+            throw;
+        }
+        LatencyTracer::mark(LatencyStage::SIGN_DONE);
         
         headers = curl_slist_append(headers, ("X-API-KEY: " + credentials_.api_key).c_str());
         headers = curl_slist_append(headers, ("X-BPX-TS: " + std::to_string(timestamp)).c_str()); // Updated header name
         headers = curl_slist_append(headers, ("X-BPX-SIGNATURE: " + signature).c_str()); // Updated header name
     }
     
-    curl_easy_setopt(curl_, CURLOPT_HTTPHEADER, headers);
+    curl_easy_setopt(handle, CURLOPT_HTTPHEADER, headers);
     
-    // Set method and body
+    // Set method and body; the body is not copied and must outlive the transfer
     switch (method) {
         case HttpMethod::GET:
             break;
         case HttpMethod::POST:
-            curl_easy_setopt(curl_, CURLOPT_POST, 1L);
+            curl_easy_setopt(handle, CURLOPT_POST, 1L);
             if (!body.empty()) {
-                curl_easy_setopt(curl_, CURLOPT_POSTFIELDS, body.c_str());
+                curl_easy_setopt(handle, CURLOPT_POSTFIELDS, body.c_str());
             }
             break;
         case HttpMethod::PUT:
-            curl_easy_setopt(curl_, CURLOPT_CUSTOMREQUEST, "PUT");
+            curl_easy_setopt(handle, CURLOPT_CUSTOMREQUEST, "PUT");
             if (!body.empty()) {
-                curl_easy_setopt(curl_, CURLOPT_POSTFIELDS, body.c_str());
+                curl_easy_setopt(handle, CURLOPT_POSTFIELDS, body.c_str());
             }
             break;
         case HttpMethod::DELETE:
-            curl_easy_setopt(curl_, CURLOPT_CUSTOMREQUEST, "DELETE");
+            curl_easy_setopt(handle, CURLOPT_CUSTOMREQUEST, "DELETE");
             break;
     }
     
-    // Perform request
-    CURLcode res = curl_easy_perform(curl_);
-    
-    // Clean up headers
-    curl_slist_free_all(headers);
-    
-    if (res != CURLE_OK) {
-        throw std::runtime_error("CURL request failed: " + std::string(curl_easy_strerror(res)));
+    return headers;
+}
+
+json RestClient::parse_response(CURL* handle, CURLcode result, const std::string& response_data) {
+    if (result != CURLE_OK) {
+        throw std::runtime_error("CURL request failed: " + std::string(curl_easy_strerror(result)));
     }
     
     // Check response code
     long response_code;
-    curl_easy_getinfo(curl_, CURLINFO_RESPONSE_CODE, &response_code);
+    curl_easy_getinfo(handle, CURLINFO_RESPONSE_CODE, &response_code);
     
     if (response_code >= 400) {
         throw std::runtime_error("API request failed with code " + std::to_string(response_code) + 
@@ -512,12 +763,11 @@ json RestClient::send_request(const std::string& endpoint, HttpMethod method,
     }
 }
 
-std::string RestClient::sign_request(HttpMethod method, const std::string& endpoint, int64_t timestamp,
-                                   const std::map<std::string, std::string>& params, const std::string& body) {
+std::string RestClient::sign_request(HttpMethod method, int64_t timestamp, const std::string& body) {
     // Decode the Base64 private key
     std::vector<unsigned char> raw_private_key;
     try {
-        raw_private_key = base64_decode(credentials_.base64_private_key);
+        raw_private_key = codec::base64_decode(credentials_.base64_private_key);
         // ED25519 private key should be 32 bytes (or 64 bytes seed+pubkey)
         // Assuming the base64 decodes to the 32-byte private key seed.
          if (raw_private_key.size() != 32 && raw_private_key.size() != 64) {
@@ -576,16 +826,12 @@ std::string RestClient::sign_request(HttpMethod method, const std::string& endpo
         throw std::runtime_error("Failed to initialize EVP digest sign context.");
     }
 
-    // Update with the message bytes
-    if (EVP_DigestSignUpdate(md_ctx, reinterpret_cast<const unsigned char*>(message_to_sign.data()), message_to_sign.length()) <= 0) {
-        EVP_MD_CTX_free(md_ctx);
-        EVP_PKEY_free(pkey);
-        throw std::runtime_error("Failed to update EVP digest sign context.");
-    }
+    // ED25519 is a one-shot algorithm: EVP_DigestSignUpdate/Final are not supported
+    const unsigned char* message_bytes = reinterpret_cast<const unsigned char*>(message_to_sign.data());
 
     // Determine the signature length
     size_t sig_len = 0;
-    if (EVP_DigestSignFinal(md_ctx, nullptr, &sig_len) <= 0) {
+    if (EVP_DigestSign(md_ctx, nullptr, &sig_len, message_bytes, message_to_sign.length()) <= 0) {
         EVP_MD_CTX_free(md_ctx);
         EVP_PKEY_free(pkey);
         throw std::runtime_error("Failed to determine signature length.");
@@ -593,10 +839,10 @@ std::string RestClient::sign_request(HttpMethod method, const std::string& endpo
 
     // Allocate buffer and get the signature
     std::vector<unsigned char> signature_bytes(sig_len);
-    if (EVP_DigestSignFinal(md_ctx, signature_bytes.data(), &sig_len) <= 0) {
+    if (EVP_DigestSign(md_ctx, signature_bytes.data(), &sig_len, message_bytes, message_to_sign.length()) <= 0) {
         EVP_MD_CTX_free(md_ctx);
         EVP_PKEY_free(pkey);
-        throw std::runtime_error("Failed to finalize EVP digest sign.");
+        throw std::runtime_error("Failed to sign message.");
     }
 
     // Clean up
@@ -604,7 +850,49 @@ std::string RestClient::sign_request(HttpMethod method, const std::string& endpo
     EVP_PKEY_free(pkey);
 
     // Encode the signature in Base64
-    return base64_encode(signature_bytes.data(), sig_len);
+    std::string signature(codec::base64_encoded_size(sig_len), '\0');
+    codec::base64_encode(signature_bytes.data(), sig_len, &signature[0]);
+    return signature;
+}
+
+void RestClient::record_request_metrics(CURL* handle, const std::string& endpoint, HttpMethod method,
+                                        CURLcode result, size_t response_bytes) {
+    // curl reports cumulative times from the start of the transfer
+    curl_off_t namelookup = 0, connect = 0, appconnect = 0, pretransfer = 0, starttransfer = 0, total = 0;
+    curl_easy_getinfo(handle, CURLINFO_NAMELOOKUP_TIME_T, &namelookup);
+    curl_easy_getinfo(handle, CURLINFO_CONNECT_TIME_T, &connect);
+    curl_easy_getinfo(handle, CURLINFO_APPCONNECT_TIME_T, &appconnect);
+    curl_easy_getinfo(handle, CURLINFO_PRETRANSFER_TIME_T, &pretransfer);
+    curl_easy_getinfo(handle, CURLINFO_STARTTRANSFER_TIME_T, &starttransfer);
+    curl_easy_getinfo(handle, CURLINFO_TOTAL_TIME_T, &total);
+    
+    long new_connects = 0;
+    curl_easy_getinfo(handle, CURLINFO_NUM_CONNECTS, &new_connects);
+    
+    RequestTiming timing;
+    timing.dns_us = namelookup;
+    timing.connect_us = connect - namelookup;
+    timing.tls_us = appconnect > 0 ? appconnect - connect : 0;
+    timing.first_byte_us = starttransfer > 0 ? starttransfer - pretransfer : 0;
+    timing.total_us = total;
+    timing.response_bytes = static_cast<int64_t>(response_bytes);
+    timing.new_connection = new_connects > 0;
+    if (result == CURLE_OK) {
+        curl_easy_getinfo(handle, CURLINFO_RESPONSE_CODE, &timing.status_code);
+    }
+    
+    metrics_.record(http_method_to_string(method) + " " + endpoint, timing);
+    
+    // Placing and cancelling orders is what a cold connection actually delays
+    bool order = (method == HttpMethod::POST && endpoint == "/api/v1/order") ||
+                 (method == HttpMethod::DELETE && (endpoint == "/api/v1/order" || endpoint == "/api/v1/openOrders"));
+    if (order) {
+        ConnectionStats& connections = metrics_.connections();
+        connections.orders.fetch_add(1, std::memory_order_relaxed);
+        if (timing.new_connection) {
+            connections.cold_orders.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
 }
 
 std::string RestClient::http_method_to_string(HttpMethod method) {
@@ -0,0 +1,38 @@
+#include "backpack/rest_engine.hpp"
+
+#include <stdexcept>
+
+namespace backpack {
+
+RestEngine::RestEngine() {
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+    share_ = curl_share_init();
+    if (!share_) {
+        curl_global_cleanup();
+        throw std::runtime_error("Failed to initialize curl share");
+    }
+    curl_share_setopt(share_, CURLSHOPT_LOCKFUNC, &RestEngine::lock);
+    curl_share_setopt(share_, CURLSHOPT_UNLOCKFUNC, &RestEngine::unlock);
+    curl_share_setopt(share_, CURLSHOPT_USERDATA, this);
+    curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+}
+
+RestEngine::~RestEngine() {
+    curl_share_cleanup(share_);
+    curl_global_cleanup();
+}
+
+void RestEngine::attach(CURL* handle) const {
+    curl_easy_setopt(handle, CURLOPT_SHARE, share_);
+}
+
+void RestEngine::lock(CURL*, curl_lock_data data, curl_lock_access, void* userptr) {
+    static_cast<RestEngine*>(userptr)->locks_[data].lock();
+}
+
+void RestEngine::unlock(CURL*, curl_lock_data data, void* userptr) {
+    static_cast<RestEngine*>(userptr)->locks_[data].unlock();
+}
+
+} // namespace backpack
@@ -0,0 +1,114 @@
+#include "backpack/rest_metrics.hpp"
+
+namespace backpack {
+
+void EndpointStats::record(const RequestTiming& timing) {
+    requests.fetch_add(1, std::memory_order_relaxed);
+
+    if (timing.status_code == 0) {
+        transport_errors.fetch_add(1, std::memory_order_relaxed);
+    } else if (timing.status_code > 0 && timing.status_code < static_cast<long>(status_codes.size())) {
+        status_codes[static_cast<size_t>(timing.status_code)].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if (timing.new_connection) {
+        new_connections.fetch_add(1, std::memory_order_relaxed);
+        dns_us.record(timing.dns_us);
+        connect_us.record(timing.connect_us);
+        if (timing.tls_us > 0) {
+            tls_us.record(timing.tls_us);
+        }
+    }
+    if (timing.status_code != 0) {
+        first_byte_us.record(timing.first_byte_us);
+        response_bytes.record(timing.response_bytes);
+    }
+    total_us.record(timing.total_us);
+}
+
+void EndpointStats::reset() {
+    for (HdrHistogram* histogram : {&dns_us, &connect_us, &tls_us, &first_byte_us, &total_us, &response_bytes}) {
+        histogram->reset();
+    }
+    requests.store(0, std::memory_order_relaxed);
+    new_connections.store(0, std::memory_order_relaxed);
+    transport_errors.store(0, std::memory_order_relaxed);
+    for (auto& count : status_codes) {
+        count.store(0, std::memory_order_relaxed);
+    }
+}
+
+void ConnectionStats::reset() {
+    for (auto* counter : {&warm_up_requests, &keepalive_requests, &pool_failures, &pool_connects, &orders, &cold_orders}) {
+        counter->store(0, std::memory_order_relaxed);
+    }
+}
+
+void RestMetrics::record(const std::string& endpoint, const RequestTiming& timing) {
+    EndpointStats* stats;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto& entry = endpoints_[endpoint];
+        if (!entry) {
+            entry = std::make_unique<EndpointStats>();
+        }
+        stats = entry.get();
+    }
+    stats->record(timing);
+}
+
+const EndpointStats* RestMetrics::find(const std::string& endpoint) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = endpoints_.find(endpoint);
+    return it == endpoints_.end() ? nullptr : it->second.get();
+}
+
+std::vector<std::string> RestMetrics::endpoints() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<std::string> keys;
+    keys.reserve(endpoints_.size());
+    for (const auto& entry : endpoints_) {
+        keys.push_back(entry.first);
+    }
+    return keys;
+}
+
+void RestMetrics::reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& entry : endpoints_) {
+        entry.second->reset();
+    }
+    connections_.reset();
+}
+
+void RestMetrics::dump(std::ostream& os) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    os << "connections: orders=" << connections_.orders.load(std::memory_order_relaxed)
+       << " cold_orders=" << connections_.cold_orders.load(std::memory_order_relaxed)
+       << " warm_up_requests=" << connections_.warm_up_requests.load(std::memory_order_relaxed)
+       << " keepalive_requests=" << connections_.keepalive_requests.load(std::memory_order_relaxed)
+       << " pool_connects=" << connections_.pool_connects.load(std::memory_order_relaxed)
+       << " pool_failures=" << connections_.pool_failures.load(std::memory_order_relaxed) << "\n";
+    for (const auto& entry : endpoints_) {
+        const EndpointStats& stats = *entry.second;
+        os << entry.first << ": requests=" << stats.requests.load(std::memory_order_relaxed)
+           << " new_connections=" << stats.new_connections.load(std::memory_order_relaxed)
+           << " transport_errors=" << stats.transport_errors.load(std::memory_order_relaxed);
+        for (size_t code = 0; code < stats.status_codes.size(); ++code) {
+            uint64_t count = stats.status_codes[code].load(std::memory_order_relaxed);
+            if (count > 0) {
+                os << " " << code << "=" << count;
+            }
+        }
+        os << "\n";
+
+        stats.dns_us.print_summary(os, "  dns (ms)", 1000.0);
+        stats.connect_us.print_summary(os, "  connect (ms)", 1000.0);
+        stats.tls_us.print_summary(os, "  tls (ms)", 1000.0);
+        stats.first_byte_us.print_summary(os, "  first_byte (ms)", 1000.0);
+        stats.total_us.print_summary(os, "  total (ms)", 1000.0);
+        stats.response_bytes.print_summary(os, "  response (bytes)");
+    }
+}
+
+} // namespace backpack
@@ -0,0 +1,65 @@
+#include "backpack/runtime.hpp"
+
+#include <exception>
+#include <iostream>
+#include <openssl/ssl.h>
+
+namespace backpack {
+
+ClientRuntime::ClientRuntime(size_t io_threads)
+    : ssl_ctx_(boost::asio::ssl::context::tlsv12_client)
+    , work_(boost::asio::make_work_guard(ioc_))
+    , rest_engine_(std::make_shared<RestEngine>()) {
+    ssl_ctx_.set_verify_mode(boost::asio::ssl::verify_peer);
+    ssl_ctx_.set_default_verify_paths();
+
+    threads_.reserve(io_threads);
+    for (size_t i = 0; i < io_threads; ++i) {
+        threads_.emplace_back([this]() {
+            // A throwing handler must not take down every other client's I/O
+            for (;;) {
+                try {
+                    ioc_.run();
+                    return;
+                } catch (const std::exception& e) {
+                    std::cerr << "Runtime handler error: " << e.what() << std::endl;
+                }
+            }
+        });
+    }
+}
+
+ClientRuntime::~ClientRuntime() {
+    work_.reset();
+    ioc_.stop();
+    for (std::thread& thread : threads_) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+}
+
+void ClientRuntime::set_ca_file(const std::string& path) {
+    // Replace the default roots, as CURLOPT_CAINFO does on the REST side
+    SSL_CTX_set_cert_store(ssl_ctx_.native_handle(), X509_STORE_new());
+    ssl_ctx_.load_verify_file(path);
+    ca_file_ = path;
+}
+
+size_t ClientRuntime::poll(std::chrono::microseconds budget) {
+    auto deadline = std::chrono::steady_clock::now() + budget;
+    size_t handled = 0;
+    try {
+        while (ioc_.poll_one() > 0) {
+            ++handled;
+            if (std::chrono::steady_clock::now() >= deadline) {
+                break;
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Runtime handler error: " << e.what() << std::endl;
+    }
+    return handled;
+}
+
+} // namespace backpack
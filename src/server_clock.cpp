@@ -0,0 +1,178 @@
+#include "backpack/server_clock.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <exception>
+#include <iostream>
+
+#include "backpack/clock.hpp"
+
+namespace backpack {
+
+namespace {
+
+// The exchange reports whole milliseconds, so its reading is up to 1 ms late
+constexpr int64_t SERVER_RESOLUTION_NS = 1000000;
+
+// Beyond this the fit is noise, not a real oscillator
+constexpr double MAX_SKEW = 500e-6;
+
+// With millisecond server readings, shorter baselines give a skew that is mostly rounding
+constexpr int64_t MIN_SKEW_SPAN_NS = 60LL * 1000000000;
+
+} // namespace
+
+ServerClockEstimator::ServerClockEstimator(TimeSource source)
+    : ServerClockEstimator(std::move(source), Options{}) {}
+
+ServerClockEstimator::ServerClockEstimator(TimeSource source, Options options)
+    : source_(std::move(source)), options_(options) {
+    options_.burst = std::max(options_.burst, 1);
+    options_.window = std::max<size_t>(options_.window, 1);
+}
+
+ServerClockEstimator::~ServerClockEstimator() {
+    stop();
+}
+
+void ServerClockEstimator::start() {
+    if (running_.exchange(true)) {
+        return;
+    }
+    thread_ = std::thread(&ServerClockEstimator::run, this);
+}
+
+void ServerClockEstimator::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_.exchange(false)) {
+            return;
+        }
+    }
+    cv_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void ServerClockEstimator::run() {
+    while (running_) {
+        sync();
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait_for(lock, options_.interval, [this]() { return !running_; });
+    }
+}
+
+bool ServerClockEstimator::sync() {
+    Sample best{0, 0, INT64_MAX};
+    for (int i = 0; i < options_.burst; ++i) {
+        int64_t sent = TscClock::wall_ns();
+        int64_t server_ms;
+        try {
+            server_ms = source_();
+        } catch (const std::exception& e) {
+            std::cerr << "Server time query failed: " << e.what() << std::endl;
+            continue;
+        }
+        int64_t received = TscClock::wall_ns();
+
+        int64_t rtt = received - sent;
+        if (rtt < best.rtt_ns) {
+            int64_t midpoint = sent + rtt / 2;
+            best = {midpoint, server_ms * 1000000 + SERVER_RESOLUTION_NS / 2 - midpoint, rtt};
+        }
+    }
+
+    if (best.rtt_ns == INT64_MAX) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++failures_;
+        return false;
+    }
+    update(best);
+    return true;
+}
+
+void ServerClockEstimator::update(const Sample& sample) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    window_.push_back(sample);
+    if (window_.size() > options_.window) {
+        window_.pop_front();
+    }
+    ++samples_;
+
+    // Skew from a least squares fit of offset against local time
+    double skew = 0.0;
+    if (window_.size() >= 3 && sample.local_ns - window_.front().local_ns >= MIN_SKEW_SPAN_NS) {
+        double mean_x = 0.0;
+        double mean_y = 0.0;
+        for (const Sample& s : window_) {
+            mean_x += static_cast<double>(s.local_ns - sample.local_ns);
+            mean_y += static_cast<double>(s.offset_ns - sample.offset_ns);
+        }
+        mean_x /= static_cast<double>(window_.size());
+        mean_y /= static_cast<double>(window_.size());
+        double sxx = 0.0;
+        double sxy = 0.0;
+        for (const Sample& s : window_) {
+            double dx = static_cast<double>(s.local_ns - sample.local_ns) - mean_x;
+            double dy = static_cast<double>(s.offset_ns - sample.offset_ns) - mean_y;
+            sxx += dx * dx;
+            sxy += dx * dy;
+        }
+        if (sxx > 0.0) {
+            skew = std::clamp(sxy / sxx, -MAX_SKEW, MAX_SKEW);
+        }
+    }
+
+    // Offset from the least delayed sample in the window, carried forward to now
+    best_ = *std::min_element(window_.begin(), window_.end(),
+                              [](const Sample& a, const Sample& b) { return a.rtt_ns < b.rtt_ns; });
+    int64_t measured = best_.offset_ns + static_cast<int64_t>(skew * static_cast<double>(sample.local_ns - best_.local_ns));
+
+    if (synchronized_) {
+        int64_t predicted = offset_at(sample.local_ns);
+        anchor_offset_ns_ = predicted + static_cast<int64_t>(options_.smoothing * static_cast<double>(measured - predicted));
+    } else {
+        anchor_offset_ns_ = measured;
+        synchronized_ = true;
+    }
+    anchor_local_ns_ = sample.local_ns;
+    skew_ = skew;
+}
+
+int64_t ServerClockEstimator::offset_at(int64_t local_ns) const {
+    return anchor_offset_ns_ + static_cast<int64_t>(skew_ * static_cast<double>(local_ns - anchor_local_ns_));
+}
+
+int64_t ServerClockEstimator::offset_ns() const {
+    int64_t now = TscClock::wall_ns();
+    std::lock_guard<std::mutex> lock(mutex_);
+    return synchronized_ ? offset_at(now) : 0;
+}
+
+int64_t ServerClockEstimator::now_ms() const {
+    int64_t now = TscClock::wall_ns();
+    std::lock_guard<std::mutex> lock(mutex_);
+    return (synchronized_ ? now + offset_at(now) : now) / 1000000;
+}
+
+ServerClockState ServerClockEstimator::state() const {
+    int64_t now = TscClock::wall_ns();
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    ServerClockState state;
+    state.synchronized = synchronized_;
+    state.samples = samples_;
+    state.failures = failures_;
+    if (synchronized_) {
+        state.offset_ns = offset_at(now);
+        state.skew_ppm = skew_ * 1e6;
+        state.min_rtt_ns = best_.rtt_ns;
+        state.uncertainty_ns = best_.rtt_ns / 2 + SERVER_RESOLUTION_NS / 2 +
+                               static_cast<int64_t>(std::abs(skew_) * static_cast<double>(now - best_.local_ns));
+    }
+    return state;
+}
+
+} // namespace backpack
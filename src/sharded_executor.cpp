@@ -0,0 +1,191 @@
+#include "backpack/sharded_executor.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+namespace backpack {
+
+namespace {
+
+// Yields before an idle worker goes to sleep; events tend to arrive in bursts
+constexpr int IDLE_SPINS = 64;
+
+} // namespace
+
+class ShardedExecutor::Shard {
+public:
+    Shard(std::string key, size_t home, size_t capacity)
+        : key(std::move(key)), home(home), tasks(capacity) {}
+
+    const std::string key;
+    const size_t home;
+    SpscQueue<Task> tasks;
+    alignas(CACHE_LINE_SIZE) std::atomic<bool> scheduled{false};  // Queued on a run queue or running
+};
+
+struct ShardedExecutor::Worker {
+    explicit Worker(size_t capacity) : run_queue(capacity) {}
+
+    MpmcQueue<Shard*> run_queue;
+    std::thread thread;
+};
+
+ShardedExecutor::ShardedExecutor()
+    : ShardedExecutor(Options{}) {}
+
+ShardedExecutor::ShardedExecutor(Options options)
+    : options_(options) {
+    options_.workers = std::max<size_t>(options_.workers, 1);
+    options_.batch = std::max<size_t>(options_.batch, 1);
+    options_.max_shards = std::max<size_t>(options_.max_shards, 1);
+
+    // Every shard is on at most one run queue at a time, so pushes never fail
+    for (size_t i = 0; i < options_.workers; ++i) {
+        workers_.push_back(std::make_unique<Worker>(options_.max_shards));
+    }
+    for (size_t i = 0; i < options_.workers; ++i) {
+        workers_[i]->thread = std::thread(&ShardedExecutor::run_worker, this, i);
+    }
+}
+
+ShardedExecutor::~ShardedExecutor() {
+    running_.store(false);
+    {
+        std::lock_guard<std::mutex> lock(idle_mutex_);
+        idle_cv_.notify_all();
+    }
+    for (auto& worker : workers_) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+    }
+}
+
+ShardedExecutor::Shard* ShardedExecutor::shard(std::string_view key) {
+    std::lock_guard<std::mutex> lock(shards_mutex_);
+    auto it = shards_.find(std::string(key));
+    if (it != shards_.end()) {
+        return it->second.get();
+    }
+    if (shards_.size() >= options_.max_shards) {
+        throw std::runtime_error("ShardedExecutor: more than " + std::to_string(options_.max_shards) + " shards");
+    }
+    size_t home = std::hash<std::string_view>{}(key) % workers_.size();
+    auto shard = std::make_unique<Shard>(std::string(key), home, options_.queue_capacity);
+    Shard* result = shard.get();
+    shards_.emplace(result->key, std::move(shard));
+    return result;
+}
+
+void ShardedExecutor::post(Shard* shard, Task task) {
+    while (!shard->tasks.try_push(task)) {
+        if (!running_.load(std::memory_order_relaxed)) {
+            return;
+        }
+        producer_waits_.fetch_add(1, std::memory_order_relaxed);
+        std::this_thread::yield();
+    }
+    if (!shard->scheduled.exchange(true, std::memory_order_acq_rel)) {
+        schedule(shard);
+    }
+}
+
+void ShardedExecutor::schedule(Shard* shard) {
+    while (!workers_[shard->home]->run_queue.try_push(shard)) {
+        std::this_thread::yield();
+    }
+    // Pairs with the fence in run_worker: either we see the sleeper or it sees the shard
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (idle_.load(std::memory_order_relaxed) > 0) {
+        std::lock_guard<std::mutex> lock(idle_mutex_);
+        idle_cv_.notify_one();
+    }
+}
+
+bool ShardedExecutor::has_work() const {
+    for (const auto& worker : workers_) {
+        if (!worker->run_queue.empty()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ShardedExecutor::next_shard(size_t index, Shard*& shard) {
+    if (workers_[index]->run_queue.try_pop(shard)) {
+        return true;
+    }
+    for (size_t i = 1; i < workers_.size(); ++i) {
+        if (workers_[(index + i) % workers_.size()]->run_queue.try_pop(shard)) {
+            steals_.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+void ShardedExecutor::run_worker(size_t index) {
+    int spins = 0;
+    while (running_.load(std::memory_order_acquire)) {
+        Shard* shard = nullptr;
+        if (next_shard(index, shard)) {
+            run_shard(shard);
+            spins = 0;
+            continue;
+        }
+        if (++spins < IDLE_SPINS) {
+            std::this_thread::yield();
+            continue;
+        }
+        spins = 0;
+
+        std::unique_lock<std::mutex> lock(idle_mutex_);
+        idle_.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (running_.load(std::memory_order_acquire) && !has_work()) {
+            idle_cv_.wait(lock);
+        }
+        idle_.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
+void ShardedExecutor::run_shard(Shard* shard) {
+    Task task;
+    size_t count = 0;
+    while (count < options_.batch && shard->tasks.try_pop(task)) {
+        try {
+            task();
+        } catch (const std::exception& e) {
+            handler_errors_.fetch_add(1, std::memory_order_relaxed);
+            std::cerr << "Handler error on " << shard->key << ": " << e.what() << std::endl;
+        } catch (...) {
+            handler_errors_.fetch_add(1, std::memory_order_relaxed);
+            std::cerr << "Handler error on " << shard->key << std::endl;
+        }
+        task = nullptr;
+        ++count;
+    }
+    executed_.fetch_add(count, std::memory_order_relaxed);
+
+    // An RMW, so a post() that saw the shard still scheduled is visible below
+    shard->scheduled.exchange(false, std::memory_order_acq_rel);
+    if (!shard->tasks.empty() && !shard->scheduled.exchange(true, std::memory_order_acq_rel)) {
+        schedule(shard);
+    }
+}
+
+ShardedExecutorStats ShardedExecutor::stats() const {
+    ShardedExecutorStats stats;
+    stats.executed = executed_.load(std::memory_order_relaxed);
+    stats.steals = steals_.load(std::memory_order_relaxed);
+    stats.producer_waits = producer_waits_.load(std::memory_order_relaxed);
+    stats.handler_errors = handler_errors_.load(std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(shards_mutex_);
+        stats.shards = shards_.size();
+    }
+    return stats;
+}
+
+} // namespace backpack
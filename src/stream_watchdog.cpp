@@ -0,0 +1,213 @@
+#include "backpack/stream_watchdog.hpp"
+
+#include <algorithm>
+
+namespace backpack {
+
+namespace {
+
+std::chrono::milliseconds to_ms(int64_t ns) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::nanoseconds(ns));
+}
+
+} // namespace
+
+StreamWatchdog::StreamWatchdog()
+    : StreamWatchdog(Options{}) {}
+
+StreamWatchdog::StreamWatchdog(Options options)
+    : options_(std::move(options)),
+      tick_ns_(std::max<int64_t>(std::chrono::nanoseconds(options_.tick).count(), 1000000)),
+      wheel_(WHEEL_SLOTS),
+      origin_ns_(now_ns()) {}
+
+void StreamWatchdog::set_callback(Callback callback) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    callback_ = std::move(callback);
+}
+
+StreamWatchdog::Stream* StreamWatchdog::track(const std::string& channel, const std::string& symbol) {
+    int64_t now = now_ns();
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& entry = streams_[channel + ":" + symbol];
+    if (!entry) {
+        auto policy = options_.channels.find(channel);
+        entry.reset(new Stream(channel, symbol,
+                               policy == options_.channels.end() ? options_.default_policy : policy->second));
+    }
+    Stream* stream = entry.get();
+    if (stream->stale) {
+        stream->stale = false;
+        --stale_count_;
+    }
+    stream->tracked = true;
+    stream->last_ns.store(now, std::memory_order_relaxed);
+    if (!stream->scheduled) {
+        schedule_locked(stream, now + sla_ns(*stream));
+    }
+    return stream;
+}
+
+void StreamWatchdog::untrack(const std::string& channel, const std::string& symbol) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = streams_.find(channel + ":" + symbol);
+    if (it == streams_.end()) {
+        return;
+    }
+    Stream* stream = it->second.get();
+    // Dropped from the wheel when its slot comes up
+    stream->tracked = false;
+    if (stream->stale) {
+        stream->stale = false;
+        --stale_count_;
+    }
+}
+
+void StreamWatchdog::untrack_all() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& entry : streams_) {
+        entry.second->tracked = false;
+        entry.second->stale = false;
+    }
+    stale_count_ = 0;
+}
+
+void StreamWatchdog::pause() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    paused_ = true;
+}
+
+void StreamWatchdog::resume(int64_t now_ns) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    paused_ = false;
+    for (auto& entry : streams_) {
+        Stream* stream = entry.second.get();
+        stream->last_ns.store(now_ns, std::memory_order_relaxed);
+        stream->stale = false;
+    }
+    stale_count_ = 0;
+}
+
+int64_t StreamWatchdog::sla_ns(const Stream& stream) const {
+    int64_t min_ns = std::chrono::nanoseconds(stream.policy.min_sla).count();
+    int64_t max_ns = std::max(std::chrono::nanoseconds(stream.policy.max_sla).count(), min_ns);
+    if (stream.samples.load(std::memory_order_relaxed) < Stream::MIN_SAMPLES) {
+        return max_ns;
+    }
+    double gap = static_cast<double>(stream.gap_ns.load(std::memory_order_relaxed));
+    double sla = std::min(gap * stream.policy.multiplier, static_cast<double>(max_ns));
+    return std::max(static_cast<int64_t>(sla), min_ns);
+}
+
+void StreamWatchdog::schedule_locked(Stream* stream, int64_t deadline_ns) {
+    // Round up, so a stream is never checked before its deadline
+    int64_t since_origin = std::max<int64_t>(deadline_ns - origin_ns_, 0);
+    uint64_t deadline_tick = static_cast<uint64_t>((since_origin + tick_ns_ - 1) / tick_ns_);
+    uint64_t distance = deadline_tick > current_tick_ ? deadline_tick - current_tick_ : 1;
+    distance = std::min<uint64_t>(distance, WHEEL_SLOTS - 1);
+    wheel_[(current_tick_ + distance) % WHEEL_SLOTS].push_back(stream);
+    stream->scheduled = true;
+}
+
+void StreamWatchdog::check_locked(Stream* stream, int64_t now_ns, std::vector<StaleStreamEvent>& events) {
+    stream->scheduled = false;
+    if (!stream->tracked) {
+        return;
+    }
+    int64_t last = stream->last_ns.load(std::memory_order_relaxed);
+    int64_t sla = sla_ns(*stream);
+    int64_t recheck_ns = std::chrono::nanoseconds(stream->policy.min_sla).count();
+
+    if (stream->stale) {
+        if (last != stream->stale_last_ns) {
+            stream->stale = false;
+            --stale_count_;
+            ++recoveries_;
+            events.push_back({stream->channel, stream->symbol, to_ms(last - stream->stale_last_ns),
+                              to_ms(sla), true});
+            schedule_locked(stream, last + sla);
+        } else {
+            schedule_locked(stream, now_ns + recheck_ns);
+        }
+        return;
+    }
+
+    if (now_ns - last < sla) {
+        schedule_locked(stream, last + sla);
+        return;
+    }
+    stream->stale = true;
+    stream->stale_last_ns = last;
+    ++stale_count_;
+    ++stale_events_;
+    events.push_back({stream->channel, stream->symbol, to_ms(now_ns - last), to_ms(sla), false});
+    schedule_locked(stream, now_ns + recheck_ns);
+}
+
+void StreamWatchdog::advance(int64_t now_ns) {
+    std::vector<StaleStreamEvent> events;
+    Callback callback;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (paused_ || now_ns < origin_ns_) {
+            return;
+        }
+        uint64_t target = static_cast<uint64_t>((now_ns - origin_ns_) / tick_ns_);
+        if (target - std::min(target, current_tick_) > WHEEL_SLOTS) {
+            // Late by more than a lap (a stalled poll loop): one lap visits every slot
+            current_tick_ = target - WHEEL_SLOTS;
+        }
+        while (current_tick_ < target) {
+            ++current_tick_;
+            std::vector<Stream*> due;
+            due.swap(wheel_[current_tick_ % WHEEL_SLOTS]);
+            for (Stream* stream : due) {
+                check_locked(stream, now_ns, events);
+            }
+        }
+        if (events.empty()) {
+            return;
+        }
+        callback = callback_;
+    }
+    if (callback) {
+        for (const auto& event : events) {
+            callback(event);
+        }
+    }
+}
+
+std::vector<StreamHealth> StreamWatchdog::snapshot(int64_t now_ns) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<StreamHealth> health;
+    for (const auto& entry : streams_) {
+        const Stream& stream = *entry.second;
+        if (!stream.tracked) {
+            continue;
+        }
+        StreamHealth item;
+        item.channel = stream.channel;
+        item.symbol = stream.symbol;
+        item.silence = to_ms(now_ns - stream.last_ns.load(std::memory_order_relaxed));
+        item.sla = to_ms(sla_ns(stream));
+        item.typical_gap = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::nanoseconds(stream.gap_ns.load(std::memory_order_relaxed)));
+        item.stale = stream.stale;
+        health.push_back(std::move(item));
+    }
+    return health;
+}
+
+StreamWatchdogStats StreamWatchdog::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    StreamWatchdogStats stats;
+    stats.stale_events = stale_events_;
+    stats.recoveries = recoveries_;
+    stats.stale = stale_count_;
+    for (const auto& entry : streams_) {
+        stats.streams += entry.second->tracked ? 1 : 0;
+    }
+    return stats;
+}
+
+} // namespace backpack
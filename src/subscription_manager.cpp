@@ -0,0 +1,236 @@
+#include "backpack/subscription_manager.hpp"
+
+#include <algorithm>
+#include <iostream>
+
+namespace backpack {
+
+SubscriptionManager::SubscriptionManager(Sender sender)
+    : SubscriptionManager(std::move(sender), Options{}) {}
+
+SubscriptionManager::SubscriptionManager(Sender sender, Options options)
+    : sender_(std::move(sender)), options_(options) {
+    options_.max_streams_per_frame = std::max<size_t>(options_.max_streams_per_frame, 1);
+}
+
+void SubscriptionManager::subscribe(const std::string& stream) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    desired_.insert(stream);
+    rejected_.erase(stream);
+    unconfirmed_.erase(stream);
+}
+
+void SubscriptionManager::unsubscribe(const std::string& stream) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    desired_.erase(stream);
+    rejected_.erase(stream);
+    unconfirmed_.erase(stream);
+}
+
+void SubscriptionManager::set_desired(const std::set<std::string>& streams) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    desired_ = streams;
+    for (auto it = rejected_.begin(); it != rejected_.end();) {
+        it = desired_.count(*it) ? std::next(it) : rejected_.erase(it);
+    }
+    for (auto it = unconfirmed_.begin(); it != unconfirmed_.end();) {
+        it = desired_.count(*it) ? std::next(it) : unconfirmed_.erase(it);
+    }
+}
+
+bool SubscriptionManager::resubscribe(const std::string& stream) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!connected_ || !desired_.count(stream) || pending_.count(stream)) {
+        return false;
+    }
+    auto now = std::chrono::steady_clock::now();
+    if (send_locked(EventType::UNSUBSCRIBE, {stream}, now) == 0) {
+        return false;
+    }
+    // The stream now waits on the SUBSCRIBE, so the UNSUBSCRIBE's reply leaves it alone
+    active_.erase(stream);
+    return send_locked(EventType::SUBSCRIBE, {stream}, now) == 1;
+}
+
+void SubscriptionManager::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    desired_.clear();
+    active_.clear();
+    rejected_.clear();
+    unconfirmed_.clear();
+    pending_.clear();
+    timeouts_.clear();
+    in_flight_.clear();
+}
+
+size_t SubscriptionManager::flush() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!connected_) {
+        return 0;
+    }
+    auto now = std::chrono::steady_clock::now();
+    expire_locked(now);
+
+    std::vector<std::string> to_subscribe;
+    for (const auto& stream : desired_) {
+        if (!active_.count(stream) && !pending_.count(stream) && !rejected_.count(stream) &&
+            !unconfirmed_.count(stream)) {
+            to_subscribe.push_back(stream);
+        }
+    }
+    std::vector<std::string> to_unsubscribe;
+    for (const auto& stream : active_) {
+        if (!desired_.count(stream) && !pending_.count(stream)) {
+            to_unsubscribe.push_back(stream);
+        }
+    }
+
+    return send_locked(EventType::UNSUBSCRIBE, to_unsubscribe, now) +
+           send_locked(EventType::SUBSCRIBE, to_subscribe, now);
+}
+
+size_t SubscriptionManager::send_locked(EventType method, const std::vector<std::string>& streams,
+                                        std::chrono::steady_clock::time_point now) {
+    size_t frames = 0;
+    for (size_t begin = 0; begin < streams.size(); begin += options_.max_streams_per_frame) {
+        size_t end = std::min(streams.size(), begin + options_.max_streams_per_frame);
+        StreamRequest request{method, {streams.begin() + begin, streams.begin() + end}, next_id_};
+        if (!sender_(request.to_json().dump())) {
+            // Unsent streams are picked up again by the next flush()
+            break;
+        }
+        ++next_id_;
+        for (const auto& stream : request.streams) {
+            pending_[stream] = request.id;
+        }
+        stats_.frames++;
+        stats_.streams += request.streams.size();
+        in_flight_.emplace(request.id, Batch{method, std::move(request.streams), now});
+        ++frames;
+    }
+    return frames;
+}
+
+void SubscriptionManager::expire_locked(std::chrono::steady_clock::time_point now) {
+    for (auto it = in_flight_.begin(); it != in_flight_.end();) {
+        if (now - it->second.sent < options_.ack_timeout) {
+            ++it;
+            continue;
+        }
+        stats_.timeouts++;
+        size_t given_up = 0;
+        for (const auto& stream : it->second.streams) {
+            auto pending = pending_.find(stream);
+            if (pending == pending_.end() || pending->second != it->first) {
+                continue;
+            }
+            pending_.erase(pending);
+            if (++timeouts_[stream] <= options_.max_retries) {
+                continue;
+            }
+            // Stop resending; a server that never echoes ids would otherwise get this frame forever
+            timeouts_.erase(stream);
+            ++given_up;
+            if (it->second.method == EventType::SUBSCRIBE) {
+                unconfirmed_.insert(stream);
+            } else {
+                active_.erase(stream);
+            }
+        }
+        if (given_up > 0) {
+            std::cerr << "No reply to subscription request " << it->first << " within "
+                      << options_.ack_timeout.count() << "ms, giving up on " << given_up
+                      << " stream(s) after " << options_.max_retries << " retries" << std::endl;
+        } else {
+            std::cerr << "No reply to subscription request " << it->first << " within "
+                      << options_.ack_timeout.count() << "ms, retrying" << std::endl;
+        }
+        it = in_flight_.erase(it);
+    }
+}
+
+bool SubscriptionManager::on_response(const nlohmann::json& message) {
+    auto id_it = message.find("id");
+    if (id_it == message.end() || !id_it->is_number_unsigned() ||
+        (!message.contains("result") && !message.contains("error"))) {
+        return false;
+    }
+    uint64_t id = id_it->get<uint64_t>();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = in_flight_.find(id);
+    if (it == in_flight_.end()) {
+        // A late reply to a frame that timed out or belonged to an earlier connection
+        return id < next_id_;
+    }
+    Batch batch = std::move(it->second);
+    in_flight_.erase(it);
+
+    auto error = message.find("error");
+    bool failed = error != message.end() && !error->is_null();
+    if (failed) {
+        stats_.errors++;
+        std::cerr << "Subscription request " << id << " failed: " << error->dump() << std::endl;
+    } else {
+        stats_.acks++;
+    }
+
+    for (const auto& stream : batch.streams) {
+        auto pending = pending_.find(stream);
+        if (pending == pending_.end() || pending->second != id) {
+            continue;
+        }
+        pending_.erase(pending);
+        timeouts_.erase(stream);
+        if (batch.method == EventType::SUBSCRIBE) {
+            unconfirmed_.erase(stream);
+            if (failed) {
+                rejected_.insert(stream);
+            } else {
+                active_.insert(stream);
+            }
+        } else {
+            // A failed unsubscribe is not retried; its handler is already gone
+            active_.erase(stream);
+        }
+    }
+    return true;
+}
+
+void SubscriptionManager::on_connected() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    connected_ = true;
+    active_.clear();
+    rejected_.clear();
+    unconfirmed_.clear();
+    pending_.clear();
+    timeouts_.clear();
+    in_flight_.clear();
+}
+
+void SubscriptionManager::on_disconnected() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    connected_ = false;
+    active_.clear();
+    pending_.clear();
+    timeouts_.clear();
+    in_flight_.clear();
+}
+
+bool SubscriptionManager::is_active(const std::string& stream) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return active_.count(stream) > 0;
+}
+
+SubscriptionStats SubscriptionManager::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    SubscriptionStats stats = stats_;
+    stats.desired = desired_.size();
+    stats.active = active_.size();
+    stats.in_flight = pending_.size();
+    stats.rejected = rejected_.size();
+    stats.unconfirmed = unconfirmed_.size();
+    return stats;
+}
+
+} // namespace backpack
@@ -0,0 +1,42 @@
+#pragma once
+
+// USDT (user statically-defined tracing) probes at SDK hot spots.
+//
+// Built in when configured with -DBACKPACK_ENABLE_USDT=ON and <sys/sdt.h> is
+// available (systemtap-sdt-dev / systemtap-sdt-devel). Each probe compiles to
+// a single nop plus a note in the ELF .note.stapsdt section, so a detached
+// probe costs nothing beyond keeping its arguments live. Attach on demand:
+//
+//   bpftrace -e 'usdt:./app:backpack:frame_receive { @bytes = hist(arg0); }'
+//   perf probe -x ./app sdt_backpack:order_send
+//
+// Probe arguments must be cheap to evaluate (sizes, pointers, c_str()).
+//
+// Probes (provider "backpack"):
+//   frame_receive(size_t bytes)                    WebSocket frame read off the socket
+//   parse_begin(size_t bytes)                      JSON parse of a frame starting
+//   parse_end(size_t bytes)                        JSON parse finished
+//   dispatch(const char* stream)                   Frame handed to the stream's handler
+//   order_send(const char* symbol, size_t bytes)   Order request about to be sent
+//   order_complete(const char* symbol, int ok)     Order request returned
+//   ws_connect(const char* uri, uint64_t count)    WebSocket connected; count > 1 is a reconnect
+//   ws_reconnect(const char* uri, uint64_t count)  Fired alongside ws_connect for reconnects
+//   ws_disconnect(uint64_t count)                  WebSocket closed or lost
+
+#if defined(BACKPACK_ENABLE_USDT) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define BACKPACK_USDT_AVAILABLE 1
+#endif
+#endif
+
+#ifdef BACKPACK_USDT_AVAILABLE
+#define BACKPACK_TRACE(name) DTRACE_PROBE(backpack, name)
+#define BACKPACK_TRACE1(name, a1) DTRACE_PROBE1(backpack, name, a1)
+#define BACKPACK_TRACE2(name, a1, a2) DTRACE_PROBE2(backpack, name, a1, a2)
+#else
+// sizeof keeps the arguments unevaluated but used, so probe-only values do not warn
+#define BACKPACK_TRACE(name) do {} while (0)
+#define BACKPACK_TRACE1(name, a1) do { (void)sizeof(a1); } while (0)
+#define BACKPACK_TRACE2(name, a1, a2) do { (void)sizeof(a1); (void)sizeof(a2); } while (0)
+#endif
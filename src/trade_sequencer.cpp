@@ -0,0 +1,261 @@
+#include "backpack/trade_sequencer.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <iostream>
+
+namespace backpack {
+
+namespace {
+
+bool parse_trade_id(const std::string& id, uint64_t& value) {
+    const char* end = id.data() + id.size();
+    auto result = std::from_chars(id.data(), end, value);
+    return result.ec == std::errc() && result.ptr == end && !id.empty();
+}
+
+} // namespace
+
+struct TradeSequencer::Stream {
+    explicit Stream(std::string symbol) : symbol(std::move(symbol)) {}
+
+    const std::string symbol;
+
+    // Guards everything below and serializes calls to handler
+    std::mutex mutex;
+    Handler handler;
+    uint64_t last = 0;          // Last delivered id; 0 before the first
+    bool recovering = false;    // Waiting for ids (last, target) from REST
+    uint64_t target = 0;        // Id of the trade that revealed the gap
+    uint64_t generation = 0;    // Bumped per gap, so an abandoned fetch is ignored
+    std::deque<Trade> held;     // Trades from target on, in arrival order
+};
+
+TradeSequencer::TradeSequencer(Fetcher fetcher)
+    : TradeSequencer(std::move(fetcher), Options{}) {}
+
+TradeSequencer::TradeSequencer(Fetcher fetcher, Options options)
+    : fetcher_(std::move(fetcher)), options_(options) {
+    options_.page_size = std::max(options_.page_size, 1);
+    thread_ = std::thread(&TradeSequencer::run, this);
+}
+
+TradeSequencer::~TradeSequencer() {
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        running_ = false;
+    }
+    queue_cv_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+TradeSequencer::Handler TradeSequencer::track(const std::string& symbol, Handler handler) {
+    Stream* stream;
+    {
+        std::lock_guard<std::mutex> lock(streams_mutex_);
+        auto& entry = streams_[symbol];
+        if (!entry) {
+            entry = std::make_unique<Stream>(symbol);
+        }
+        stream = entry.get();
+    }
+    {
+        std::lock_guard<std::mutex> lock(stream->mutex);
+        stream->handler = std::move(handler);
+    }
+    return [this, stream](const Trade& trade) { on_trade(*stream, trade); };
+}
+
+void TradeSequencer::on_trade(Stream& stream, const Trade& trade) {
+    std::lock_guard<std::mutex> lock(stream.mutex);
+    if (stream.recovering && stream.held.size() >= options_.max_held) {
+        // The fetch is taking too long; give up on the gap rather than grow without bound
+        lost_.fetch_add(stream.target - stream.last - 1, std::memory_order_relaxed);
+        std::cerr << "Trade backfill for " << stream.symbol << " abandoned after holding "
+                  << stream.held.size() << " trades" << std::endl;
+        stream.last = stream.target - 1;
+        stream.recovering = false;
+        ++stream.generation;
+        drain_locked(stream);
+    }
+    if (stream.recovering) {
+        stream.held.push_back(trade);
+        return;
+    }
+    accept_locked(stream, trade);
+}
+
+void TradeSequencer::accept_locked(Stream& stream, const Trade& trade) {
+    uint64_t id;
+    if (!parse_trade_id(trade.id, id)) {
+        deliver_locked(stream, trade);
+        return;
+    }
+    if (stream.last == 0 || id == stream.last + 1) {
+        stream.last = id;
+        deliver_locked(stream, trade);
+        return;
+    }
+    if (id <= stream.last) {
+        duplicates_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    uint64_t gap = id - stream.last - 1;
+    gaps_.fetch_add(1, std::memory_order_relaxed);
+    missing_.fetch_add(gap, std::memory_order_relaxed);
+    if (gap > options_.max_backfill) {
+        lost_.fetch_add(gap, std::memory_order_relaxed);
+        std::cerr << "Trade gap of " << gap << " on " << stream.symbol << " is too large to backfill" << std::endl;
+        stream.last = id;
+        deliver_locked(stream, trade);
+        return;
+    }
+
+    // Ahead of whatever is still held, which all arrived after it
+    stream.held.push_front(trade);
+    stream.recovering = true;
+    stream.target = id;
+    ++stream.generation;
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        queue_.push_back(&stream);
+    }
+    queue_cv_.notify_one();
+}
+
+void TradeSequencer::drain_locked(Stream& stream) {
+    while (!stream.recovering && !stream.held.empty()) {
+        Trade trade = std::move(stream.held.front());
+        stream.held.pop_front();
+        accept_locked(stream, trade);
+    }
+}
+
+void TradeSequencer::deliver_locked(Stream& stream, const Trade& trade) {
+    if (!stream.handler) {
+        return;
+    }
+    try {
+        stream.handler(trade);
+    } catch (const std::exception& e) {
+        std::cerr << "Error in trade handler for " << stream.symbol << ": " << e.what() << std::endl;
+    }
+}
+
+void TradeSequencer::run() {
+    for (;;) {
+        Stream* stream;
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex_);
+            queue_cv_.wait(lock, [this]() { return !running_ || !queue_.empty(); });
+            if (!running_) {
+                return;
+            }
+            stream = queue_.front();
+            queue_.pop_front();
+        }
+
+        uint64_t from, to, generation;
+        {
+            std::lock_guard<std::mutex> lock(stream->mutex);
+            from = stream->last + 1;
+            to = stream->target;
+            generation = stream->generation;
+        }
+        std::vector<Trade> recovered = fetch(*stream, from, to);
+
+        std::lock_guard<std::mutex> lock(stream->mutex);
+        if (!stream->recovering || stream->generation != generation) {
+            continue;
+        }
+        for (const Trade& trade : recovered) {
+            uint64_t id;
+            if (parse_trade_id(trade.id, id) && id > stream->last && id < to) {
+                // Ids the exchange skipped inside the range are gone too
+                lost_.fetch_add(id - stream->last - 1, std::memory_order_relaxed);
+                stream->last = id;
+                recovered_.fetch_add(1, std::memory_order_relaxed);
+                deliver_locked(*stream, trade);
+            }
+        }
+        if (stream->last + 1 < to) {
+            lost_.fetch_add(to - stream->last - 1, std::memory_order_relaxed);
+            stream->last = to - 1;
+        }
+        stream->recovering = false;
+        drain_locked(*stream);
+    }
+}
+
+std::vector<Trade> TradeSequencer::fetch(const Stream& stream, uint64_t from, uint64_t to) {
+    std::vector<Trade> recovered;
+    uint64_t next = from;
+    while (next < to) {
+        // Up to and including the held trade, so a server that also returns next - 1 still covers the range
+        int limit = static_cast<int>(std::min<uint64_t>(static_cast<uint64_t>(options_.page_size), to - next + 1));
+        std::vector<Trade> page;
+        backfill_requests_.fetch_add(1, std::memory_order_relaxed);
+        try {
+            // fromId is exclusive: ask for the trades after the last one we have
+            page = fetcher_(stream.symbol, std::to_string(next - 1), limit);
+        } catch (const std::exception& e) {
+            backfill_failures_.fetch_add(1, std::memory_order_relaxed);
+            std::cerr << "Trade backfill for " << stream.symbol << " from " << next << " failed: "
+                      << e.what() << std::endl;
+            break;
+        }
+
+        uint64_t advanced = next;
+        for (Trade& trade : page) {
+            uint64_t id;
+            if (parse_trade_id(trade.id, id) && id >= next && id < to) {
+                advanced = std::max(advanced, id + 1);
+                recovered.push_back(std::move(trade));
+            }
+        }
+        if (advanced == next) {
+            // The exchange no longer has these trades
+            break;
+        }
+        next = advanced;
+    }
+
+    std::sort(recovered.begin(), recovered.end(), [](const Trade& a, const Trade& b) {
+        uint64_t a_id = 0, b_id = 0;
+        parse_trade_id(a.id, a_id);
+        parse_trade_id(b.id, b_id);
+        return a_id < b_id;
+    });
+    return recovered;
+}
+
+uint64_t TradeSequencer::last_id(const std::string& symbol) const {
+    Stream* stream;
+    {
+        std::lock_guard<std::mutex> lock(streams_mutex_);
+        auto it = streams_.find(symbol);
+        if (it == streams_.end()) {
+            return 0;
+        }
+        stream = it->second.get();
+    }
+    std::lock_guard<std::mutex> lock(stream->mutex);
+    return stream->last;
+}
+
+TradeSequencerStats TradeSequencer::stats() const {
+    TradeSequencerStats stats;
+    stats.gaps = gaps_.load(std::memory_order_relaxed);
+    stats.missing = missing_.load(std::memory_order_relaxed);
+    stats.recovered = recovered_.load(std::memory_order_relaxed);
+    stats.lost = lost_.load(std::memory_order_relaxed);
+    stats.duplicates = duplicates_.load(std::memory_order_relaxed);
+    stats.backfill_requests = backfill_requests_.load(std::memory_order_relaxed);
+    stats.backfill_failures = backfill_failures_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+} // namespace backpack
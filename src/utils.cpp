@@ -1,11 +1,217 @@
 #include "backpack/utils.hpp"
 
-// Most of the utilities are implemented as inline functions in the header file,
-// but we provide this implementation file for any non-inline functions that might be needed.
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+// Most of the utilities are implemented as inline functions in the header file;
+// this file holds the ones with internal state or tables.
 
 namespace backpack {
 
-// Currently all utility functions are implemented as inline functions in the header file.
-// This file is provided as a placeholder for any non-inline implementations that might be added later.
+namespace {
+
+// "00" "01" ... "99": two digits per lookup
+struct DigitPairs {
+    char chars[200];
+
+    constexpr DigitPairs() : chars() {
+        for (int i = 0; i < 100; ++i) {
+            chars[2 * i] = static_cast<char>('0' + i / 10);
+            chars[2 * i + 1] = static_cast<char>('0' + i % 10);
+        }
+    }
+};
+
+constexpr DigitPairs DIGIT_PAIRS;
+
+inline void write_2digits(char* out, int value) {
+    std::memcpy(out, &DIGIT_PAIRS.chars[2 * value], 2);
+}
+
+// Howard Hinnant's civil calendar algorithms, valid for the proleptic Gregorian calendar
+constexpr int64_t days_from_civil(int64_t year, int64_t month, int64_t day) {
+    year -= month <= 2 ? 1 : 0;
+    int64_t era = (year >= 0 ? year : year - 399) / 400;
+    int64_t yoe = year - era * 400;
+    int64_t doy = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+struct CivilDate {
+    int64_t year;
+    int month;
+    int day;
+};
+
+constexpr CivilDate civil_from_days(int64_t days) {
+    days += 719468;
+    int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+    int64_t doe = days - era * 146097;
+    int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    int64_t mp = (5 * doy + 2) / 153;
+    int day = static_cast<int>(doy - (153 * mp + 2) / 5 + 1);
+    int month = static_cast<int>(mp < 10 ? mp + 3 : mp - 9);
+    return {yoe + era * 400 + (month <= 2 ? 1 : 0), month, day};
+}
+
+static_assert(days_from_civil(1970, 1, 1) == 0, "epoch");
+static_assert(days_from_civil(2000, 3, 1) == 11017, "leap handling");
+
+// Per-thread "YYYY-MM-DDTHH:MM:SS." for the last second formatted
+struct PrefixCache {
+    int64_t second = INT64_MIN;
+    char prefix[20];
+};
+
+thread_local PrefixCache prefix_cache;
+
+[[noreturn]] void invalid_timestamp(std::string_view timestamp) {
+    throw std::invalid_argument("Invalid ISO8601 timestamp: " + std::string(timestamp));
+}
+
+// Parse exactly count digits at pos, advancing pos
+inline bool parse_digits(std::string_view s, size_t& pos, int count, int64_t& value) {
+    if (pos + static_cast<size_t>(count) > s.size()) {
+        return false;
+    }
+    int64_t v = 0;
+    for (int i = 0; i < count; ++i) {
+        unsigned digit = static_cast<unsigned char>(s[pos + i]) - '0';
+        if (digit > 9) {
+            return false;
+        }
+        v = v * 10 + digit;
+    }
+    pos += static_cast<size_t>(count);
+    value = v;
+    return true;
+}
+
+inline bool expect(std::string_view s, size_t& pos, char c) {
+    if (pos < s.size() && s[pos] == c) {
+        ++pos;
+        return true;
+    }
+    return false;
+}
+
+} // namespace
+
+size_t format_iso8601(int64_t timestamp_ms, char* out) {
+    // Floor division so pre-1970 timestamps format correctly too
+    int64_t second = timestamp_ms / 1000;
+    int millis = static_cast<int>(timestamp_ms % 1000);
+    if (millis < 0) {
+        millis += 1000;
+        --second;
+    }
+
+    PrefixCache& cache = prefix_cache;
+    if (second != cache.second) {
+        int64_t days = second / 86400;
+        int64_t seconds_of_day = second % 86400;
+        if (seconds_of_day < 0) {
+            seconds_of_day += 86400;
+            --days;
+        }
+        CivilDate date = civil_from_days(days);
+        int64_t year = date.year < 0 ? 0 : (date.year > 9999 ? 9999 : date.year);
+
+        char* p = cache.prefix;
+        write_2digits(p, static_cast<int>(year / 100));
+        write_2digits(p + 2, static_cast<int>(year % 100));
+        p[4] = '-';
+        write_2digits(p + 5, date.month);
+        p[7] = '-';
+        write_2digits(p + 8, date.day);
+        p[10] = 'T';
+        write_2digits(p + 11, static_cast<int>(seconds_of_day / 3600));
+        p[13] = ':';
+        write_2digits(p + 14, static_cast<int>(seconds_of_day / 60 % 60));
+        p[16] = ':';
+        write_2digits(p + 17, static_cast<int>(seconds_of_day % 60));
+        p[19] = '.';
+        cache.second = second;
+    }
+
+    std::memcpy(out, cache.prefix, sizeof(cache.prefix));
+    out[20] = static_cast<char>('0' + millis / 100);
+    write_2digits(out + 21, millis % 100);
+    out[23] = 'Z';
+    return ISO8601_MS_LENGTH;
+}
+
+int64_t parse_iso8601_ms(std::string_view timestamp) {
+    size_t pos = 0;
+    int64_t year, month, day, hour, minute, second;
+    if (!parse_digits(timestamp, pos, 4, year) || !expect(timestamp, pos, '-') ||
+        !parse_digits(timestamp, pos, 2, month) || !expect(timestamp, pos, '-') ||
+        !parse_digits(timestamp, pos, 2, day) ||
+        !(expect(timestamp, pos, 'T') || expect(timestamp, pos, ' ')) ||
+        !parse_digits(timestamp, pos, 2, hour) || !expect(timestamp, pos, ':') ||
+        !parse_digits(timestamp, pos, 2, minute) || !expect(timestamp, pos, ':') ||
+        !parse_digits(timestamp, pos, 2, second)) {
+        invalid_timestamp(timestamp);
+    }
+
+    // Leap seconds (:60) are accepted and fold into the next second
+    static constexpr int DAYS_IN_MONTH[] = {31, 29, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    if (month < 1 || month > 12 || day < 1 || day > DAYS_IN_MONTH[month - 1] ||
+        hour > 23 || minute > 59 || second > 60) {
+        invalid_timestamp(timestamp);
+    }
+    bool leap_year = year % 4 == 0 && (year % 100 != 0 || year % 400 == 0);
+    if (month == 2 && day == 29 && !leap_year) {
+        invalid_timestamp(timestamp);
+    }
+
+    int64_t millis = 0;
+    if (expect(timestamp, pos, '.')) {
+        size_t start = pos;
+        while (pos < timestamp.size() && static_cast<unsigned>(timestamp[pos] - '0') <= 9) {
+            if (pos - start < 3) {
+                millis = millis * 10 + (timestamp[pos] - '0');
+            }
+            ++pos;
+        }
+        size_t digits = pos - start;
+        if (digits == 0 || digits > 9) {
+            invalid_timestamp(timestamp);
+        }
+        for (size_t i = digits; i < 3; ++i) {
+            millis *= 10;
+        }
+    }
+
+    int64_t offset_minutes = 0;
+    if (pos < timestamp.size()) {
+        char zone = timestamp[pos++];
+        if (zone == 'Z' || zone == 'z') {
+            // UTC
+        } else if (zone == '+' || zone == '-') {
+            int64_t offset_hour, offset_minute;
+            if (!parse_digits(timestamp, pos, 2, offset_hour)) {
+                invalid_timestamp(timestamp);
+            }
+            expect(timestamp, pos, ':');  // +HH:MM or +HHMM
+            if (!parse_digits(timestamp, pos, 2, offset_minute) || offset_hour > 23 || offset_minute > 59) {
+                invalid_timestamp(timestamp);
+            }
+            offset_minutes = (offset_hour * 60 + offset_minute) * (zone == '-' ? -1 : 1);
+        } else {
+            invalid_timestamp(timestamp);
+        }
+    }
+    if (pos != timestamp.size()) {
+        invalid_timestamp(timestamp);
+    }
+
+    int64_t days = days_from_civil(year, month, day);
+    int64_t seconds = days * 86400 + hour * 3600 + minute * 60 + second - offset_minutes * 60;
+    return seconds * 1000 + millis;
+}
 
 } // namespace backpack
@@ -1,9 +1,13 @@
 #include "backpack/websocket_client.hpp"
+#include "backpack/codec.hpp"
+#include "tracepoints.hpp"
 #include <openssl/evp.h>
 #include <openssl/encoder.h>
 #include <openssl/core_names.h>
 #include <openssl/err.h>
 #include <openssl/pem.h>
+#include <openssl/ssl.h>
+#include <cstdlib>
 #include <iostream>
 #include <sstream>
 #include <cstring>
@@ -12,37 +16,15 @@
 
 namespace backpack {
 
-inline std::string base64_encode(const unsigned char* buf, std::size_t len)
+[[maybe_unused]] static std::string ed25519_sign_b64(const std::string& msg, const std::string& secret_b64)
 {
-    std::string out(4 * ((len + 2) / 3), '\0');
-    int out_len = EVP_EncodeBlock(
-        reinterpret_cast<unsigned char*>(out.data()), buf, static_cast<int>(len));
-    out.resize(out_len);
-    return out;
-}
-
-inline std::string base64_decode(const std::string& in)
-{
-    std::vector<unsigned char> tmp(in.size());
-    int len = EVP_DecodeBlock(tmp.data(),
-                              reinterpret_cast<const unsigned char*>(in.data()),
-                              static_cast<int>(in.size()));
-    if (len < 0)
-        throw std::runtime_error("base64 decode error");
-    while (len && tmp[len - 1] == 0) --len;
-    return std::string(reinterpret_cast<char*>(tmp.data()), len);
-}
-
-static std::string ed25519_sign_b64(const std::string& msg, const std::string& secret_b64)
-{
-    std::string sk_raw = base64_decode(secret_b64);
+    std::vector<unsigned char> sk_raw = codec::base64_decode(secret_b64);
     if (sk_raw.size() != 64 && sk_raw.size() != 32)
         throw std::runtime_error("invalid ed25519 secret length");
 
     EVP_PKEY* pkey = EVP_PKEY_new_raw_private_key(
         EVP_PKEY_ED25519, nullptr,
-        reinterpret_cast<const unsigned char*>(sk_raw.data()),
-        sk_raw.size());
+        sk_raw.data(), sk_raw.size());
     if (!pkey) throw std::runtime_error("EVP_PKEY_new_raw_private_key");
 
     EVP_MD_CTX* ctx = EVP_MD_CTX_new();
@@ -74,18 +56,33 @@ static std::string ed25519_sign_b64(const std::string& msg, const std::string& s
 
     EVP_MD_CTX_free(ctx);
     EVP_PKEY_free(pkey);
-    return base64_encode(sig.data(), siglen);
+    std::string sig_b64(codec::base64_encoded_size(siglen), '\0');
+    codec::base64_encode(sig.data(), siglen, &sig_b64[0]);
+    return sig_b64;
 }
 
 WebSocketClient::WebSocketClient() 
-    : m_ssl_ctx(ssl::context::tlsv12_client)
-    , m_ws(m_ioc, m_ssl_ctx)
-    , m_resolver(m_ioc)
+    : WebSocketClient(nullptr) {}
+
+WebSocketClient::WebSocketClient(std::shared_ptr<ClientRuntime> runtime)
+    : m_runtime(std::move(runtime))
+    // Shared contexts are aliased to the runtime so they live as long as this client
+    , m_ioc(m_runtime ? std::shared_ptr<net::io_context>(m_runtime, &m_runtime->io_context())
+                      : std::make_shared<net::io_context>())
+    , m_ssl_ctx(m_runtime ? std::shared_ptr<ssl::context>(m_runtime, &m_runtime->ssl_context())
+                          : std::make_shared<ssl::context>(ssl::context::tlsv12_client))
+    // A strand keeps this client's handlers serialized when the runtime runs several threads
+    , m_ws(net::make_strand(*m_ioc), *m_ssl_ctx)
+    , m_resolver(*m_ioc)
+    , m_heartbeat_timer(m_ws.get_executor())
+    , m_timer(m_ws.get_executor())
     , m_running(false) {
     
-    // Configure SSL context
-    m_ssl_ctx.set_verify_mode(ssl::verify_peer);
-    m_ssl_ctx.set_default_verify_paths();
+    // Configure SSL context (a runtime configures its own)
+    if (!m_runtime) {
+        m_ssl_ctx->set_verify_mode(ssl::verify_peer);
+        m_ssl_ctx->set_default_verify_paths();
+    }
 
     // Set up default handlers
     m_message_handler = [](const std::string& msg) {
@@ -175,10 +172,40 @@ bool WebSocketClient::connect(const std::string& uri) {
         m_running = true;
         m_connected = true;
 
+        uint64_t connect_count = ++m_connect_count;
+        BACKPACK_TRACE2(ws_connect, uri.c_str(), connect_count);
+        if (connect_count > 1) {
+            BACKPACK_TRACE2(ws_reconnect, uri.c_str(), connect_count);
+        }
+
         if (m_open_handler) {
             m_open_handler();
         }
 
+        if (m_runtime) {
+            // Start on this client's strand; the runtime's threads take it from there
+            begin_op();
+            net::post(m_ws.get_executor(), [this]() {
+                OpGuard guard{this};
+                async_read();
+                schedule_heartbeat();
+                schedule_timer();
+            });
+            return true;
+        }
+
+        if (m_ioc->stopped()) {
+            m_ioc->restart();
+        }
+        schedule_heartbeat();
+        schedule_timer();
+
+        if (m_poll_mode) {
+            // The owner's poll() calls drive the read loop and the heartbeat
+            async_read();
+            return true;
+        }
+
         // Start the io_context thread
         m_thread = std::make_shared<std::thread>([this]() {
             try {
@@ -186,7 +213,7 @@ bool WebSocketClient::connect(const std::string& uri) {
                 async_read();
                 
                 // Run the io_context
-                m_ioc.run();
+                m_ioc->run();
             } catch (const std::exception& e) {
                 if (m_fail_handler) {
                     m_fail_handler(std::string("IO context error: ") + e.what());
@@ -194,17 +221,6 @@ bool WebSocketClient::connect(const std::string& uri) {
             }
         });
 
-        // Start the heartbeat thread
-        m_heartbeat_thread = std::make_shared<std::thread>([this]() {
-            try {
-                start_heartbeat();
-            } catch (const std::exception& e) {
-                if (m_fail_handler) {
-                    m_fail_handler(std::string("Heartbeat error: ") + e.what());
-                }
-            }
-        });
-
         return true;
     } catch (const std::exception& e) {
         if (m_fail_handler) {
@@ -220,7 +236,9 @@ void WebSocketClient::send(const std::string& message) {
     }
 
     // Post the write operation to the io_context
-    net::post(m_ioc, [this, message]() {
+    begin_op();
+    net::post(m_ws.get_executor(), [this, message]() {
+        OpGuard guard{this};
         try {
             m_ws.write(net::buffer(message));
         } catch (const std::exception& e) {
@@ -262,23 +280,85 @@ void WebSocketClient::set_close_handler(std::function<void()> handler) {
     m_close_handler = std::move(handler);
 }
 
+void WebSocketClient::set_timer_handler(std::chrono::milliseconds interval, std::function<void()> handler) {
+    // The io thread reads both while connected, and connect() is what starts the timer
+    if (is_connected()) {
+        throw std::runtime_error("set_timer_handler() must be called before connect()");
+    }
+    m_timer_interval = interval;
+    m_timer_handler = std::move(handler);
+}
+
 void WebSocketClient::set_fail_handler(std::function<void(const std::string&)> handler) {
     m_fail_handler = std::move(handler);
 }
 
+void WebSocketClient::set_ca_file(const std::string& path) {
+    // The TLS context belongs to the runtime; changing it here would change every client's
+    if (m_runtime) {
+        throw std::runtime_error("set_ca_file() cannot be used with a shared runtime; call ClientRuntime::set_ca_file()");
+    }
+    // Replace the default roots, as CURLOPT_CAINFO does on the REST side
+    SSL_CTX_set_cert_store(m_ssl_ctx->native_handle(), X509_STORE_new());
+    m_ssl_ctx->load_verify_file(path);
+}
+
+void WebSocketClient::set_latency_tracer(std::shared_ptr<LatencyTracer> tracer) {
+    m_latency_tracer = std::move(tracer);
+}
+
+void WebSocketClient::set_poll_mode(bool enabled) {
+    m_poll_mode = enabled;
+}
+
+size_t WebSocketClient::poll(std::chrono::microseconds budget) {
+    if (m_runtime) {
+        return 0;
+    }
+    if (m_ioc->stopped()) {
+        m_ioc->restart();
+    }
+    
+    auto deadline = std::chrono::steady_clock::now() + budget;
+    size_t handled = 0;
+    try {
+        // poll_one() also runs the reactor without blocking when nothing is queued
+        while (m_ioc->poll_one() > 0) {
+            ++handled;
+            if (std::chrono::steady_clock::now() >= deadline) {
+                break;
+            }
+        }
+    } catch (const std::exception& e) {
+        if (m_fail_handler) {
+            m_fail_handler(std::string("IO context error: ") + e.what());
+        }
+    }
+    return handled;
+}
+
 void WebSocketClient::async_read() {
     // Read a message into our buffer
+    begin_op();
     m_ws.async_read(
         m_buffer,
         [this](beast::error_code ec, std::size_t bytes_transferred) {
+            OpGuard guard{this};
             if (ec) {
                 handle_disconnect();
                 return;
             }
 
+            BACKPACK_TRACE1(frame_receive, bytes_transferred);
+
             // Call the message handler with the received data
             if (m_message_handler) {
-                m_message_handler(beast::buffers_to_string(m_buffer.data()));
+                LatencyTracer::Scope trace(m_latency_tracer.get());
+                // Reuse the frame string's capacity instead of allocating a copy per frame
+                auto data = m_buffer.data();
+                m_frame.assign(static_cast<const char*>(data.data()), data.size());
+                LatencyTracer::mark(LatencyStage::SOCKET_READ);
+                m_message_handler(m_frame);
             }
 
             // Clear the buffer
@@ -293,31 +373,127 @@ void WebSocketClient::async_read() {
 
 void WebSocketClient::handle_disconnect() {
     m_connected = false;
+    BACKPACK_TRACE1(ws_disconnect, m_connect_count.load());
     if (m_close_handler) {
         m_close_handler();
     }
 }
 
-void WebSocketClient::start_heartbeat() {
-    while (m_running) {
-        if (is_connected()) {
-            try {
-                send("{\"method\":\"PING\"}");
-            } catch (const WebSocketError&) {
-                // Ignore ping errors
+void WebSocketClient::schedule_heartbeat() {
+    // A timer on the io_context rather than a thread, so poll mode needs no threads at all
+    m_heartbeat_timer.expires_after(std::chrono::seconds(HEARTBEAT_INTERVAL));
+    begin_op();
+    m_heartbeat_timer.async_wait([this](const beast::error_code& ec) {
+        OpGuard guard{this};
+        if (ec || !m_running || !is_connected()) {
+            return;
+        }
+        try {
+            send("{\"method\":\"PING\"}");
+        } catch (const WebSocketError&) {
+            // Ignore ping errors
+        }
+        schedule_heartbeat();
+    });
+}
+
+void WebSocketClient::schedule_timer() {
+    if (!m_timer_handler) {
+        return;
+    }
+    m_timer.expires_after(m_timer_interval);
+    begin_op();
+    m_timer.async_wait([this](const beast::error_code& ec) {
+        OpGuard guard{this};
+        if (ec || !m_running || !is_connected()) {
+            return;
+        }
+        try {
+            m_timer_handler();
+        } catch (const std::exception& e) {
+            if (m_fail_handler) {
+                m_fail_handler(std::string("Timer handler error: ") + e.what());
             }
         }
-        std::this_thread::sleep_for(std::chrono::seconds(HEARTBEAT_INTERVAL));
+        schedule_timer();
+    });
+}
+
+void WebSocketClient::end_op() {
+    if (m_pending_ops.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        std::lock_guard<std::mutex> lock(m_ops_mutex);
+        m_ops_cv.notify_all();
     }
 }
 
+bool WebSocketClient::wait_for_ops(std::chrono::milliseconds timeout) {
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    if (m_runtime->io_threads() == 0) {
+        // Nobody else runs the io_context
+        while (m_pending_ops.load(std::memory_order_acquire) > 0) {
+            if (std::chrono::steady_clock::now() >= deadline) {
+                return false;
+            }
+            m_runtime->poll();
+        }
+        return true;
+    }
+    std::unique_lock<std::mutex> lock(m_ops_mutex);
+    return m_ops_cv.wait_until(lock, deadline, [this]() {
+        return m_pending_ops.load(std::memory_order_acquire) == 0;
+    });
+}
+
 void WebSocketClient::cleanup() {
     m_running = false;
     
+    if (m_runtime) {
+        // The handlers waited for below run on the runtime's threads; waiting
+        // on one of them, e.g. destroying a client from its own callback,
+        // would never return
+        if (m_runtime->io_context().get_executor().running_in_this_thread()) {
+            std::cerr << "WebSocketClient destroyed on a ClientRuntime thread; "
+                      << "destroy runtime clients from a thread that does not run the runtime" << std::endl;
+            std::abort();
+        }
+        
+        // The io_context keeps running for other clients, so wait until no
+        // handler referring to this client is left instead of stopping it
+        begin_op();
+        net::post(m_ws.get_executor(), [this]() {
+            OpGuard guard{this};
+            m_heartbeat_timer.cancel();
+            m_timer.cancel();
+            if (is_connected()) {
+                begin_op();
+                m_ws.async_close(websocket::close_code::normal, [this](const beast::error_code&) {
+                    OpGuard guard{this};
+                });
+            }
+        });
+        if (!wait_for_ops(std::chrono::seconds(CLOSE_TIMEOUT))) {
+            // The peer did not answer the close; abort whatever is still pending
+            begin_op();
+            net::post(m_ws.get_executor(), [this]() {
+                OpGuard guard{this};
+                beast::error_code ignored;
+                beast::get_lowest_layer(m_ws).socket().close(ignored);
+            });
+            if (!wait_for_ops(std::chrono::seconds(CLOSE_TIMEOUT))) {
+                // Pending handlers still refer to this client; freeing it under them would corrupt memory
+                std::cerr << "WebSocketClient handlers still pending " << 2 * CLOSE_TIMEOUT
+                          << "s after close; is every ClientRuntime thread blocked?" << std::endl;
+                std::abort();
+            }
+        }
+        m_connected = false;
+        return;
+    }
+    
     if (is_connected()) {
         try {
             // Post the close operation to the io_context
-            net::post(m_ioc, [this]() {
+            net::post(m_ws.get_executor(), [this]() {
                 try {
                     m_ws.close(websocket::close_code::normal);
                 } catch (...) {
@@ -329,17 +505,22 @@ void WebSocketClient::cleanup() {
         }
     }
     
+    // Without an io thread nothing else would run the close
+    if (m_poll_mode) {
+        try {
+            m_ioc->poll();
+        } catch (...) {
+            // Ignore errors during cleanup
+        }
+    }
+    
     // Stop the io_context
-    m_ioc.stop();
+    m_ioc->stop();
     
     if (m_thread && m_thread->joinable()) {
         m_thread->join();
     }
     
-    if (m_heartbeat_thread && m_heartbeat_thread->joinable()) {
-        m_heartbeat_thread->join();
-    }
-    
     m_connected = false;
 }
 
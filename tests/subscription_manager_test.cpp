@@ -0,0 +1,277 @@
+#include "backpack/subscription_manager.hpp"
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include <nlohmann/json.hpp>
+
+using backpack::SubscriptionManager;
+using backpack::SubscriptionStats;
+using json = nlohmann::json;
+
+namespace {
+
+// Records every frame the manager sends; fail_next makes the next sends fail
+class FakeSocket {
+public:
+    SubscriptionManager::Sender sender() {
+        return [this](const std::string& frame) {
+            if (fail_next > 0) {
+                --fail_next;
+                return false;
+            }
+            frames.push_back(json::parse(frame));
+            return true;
+        };
+    }
+
+    // Reply to a sent frame the way the exchange does
+    static json ack(const json& frame) { return {{"id", frame["id"]}, {"result", nullptr}}; }
+    static json error(const json& frame) {
+        return {{"id", frame["id"]}, {"error", {{"code", 4}, {"message", "Invalid stream"}}}};
+    }
+
+    std::vector<json> frames;
+    int fail_next = 0;
+};
+
+SubscriptionManager::Options options(size_t per_frame = 100,
+                                     std::chrono::milliseconds ack_timeout = std::chrono::seconds(5)) {
+    SubscriptionManager::Options result;
+    result.max_streams_per_frame = per_frame;
+    result.ack_timeout = ack_timeout;
+    return result;
+}
+
+} // namespace
+
+TEST(SubscriptionManagerTest, SendsNothingWhileDisconnected) {
+    FakeSocket socket;
+    SubscriptionManager manager(socket.sender());
+    manager.subscribe("trade.SOL_USDC");
+
+    EXPECT_EQ(manager.flush(), 0u);
+    EXPECT_TRUE(socket.frames.empty());
+    EXPECT_EQ(manager.stats().desired, 1u);
+}
+
+TEST(SubscriptionManagerTest, SendsDifferenceInBatches) {
+    FakeSocket socket;
+    SubscriptionManager manager(socket.sender(), options(2));
+    manager.on_connected();
+    manager.set_desired({"a", "b", "c", "d", "e"});
+
+    ASSERT_EQ(manager.flush(), 3u);
+    ASSERT_EQ(socket.frames.size(), 3u);
+    EXPECT_EQ(socket.frames[0]["method"], "SUBSCRIBE");
+    EXPECT_EQ(socket.frames[0]["params"], json({"a", "b"}));
+    EXPECT_EQ(socket.frames[2]["params"], json({"e"}));
+    EXPECT_NE(socket.frames[0]["id"], socket.frames[1]["id"]);
+
+    // Streams waiting for a reply are not sent twice
+    EXPECT_EQ(manager.flush(), 0u);
+    EXPECT_EQ(manager.stats().in_flight, 5u);
+}
+
+TEST(SubscriptionManagerTest, AckActivatesAndUnsubscribeRemoves) {
+    FakeSocket socket;
+    SubscriptionManager manager(socket.sender());
+    manager.on_connected();
+    manager.subscribe("trade.SOL_USDC");
+    manager.flush();
+
+    ASSERT_TRUE(manager.on_response(FakeSocket::ack(socket.frames.back())));
+    EXPECT_TRUE(manager.is_active("trade.SOL_USDC"));
+    EXPECT_EQ(manager.flush(), 0u);
+
+    manager.unsubscribe("trade.SOL_USDC");
+    ASSERT_EQ(manager.flush(), 1u);
+    EXPECT_EQ(socket.frames.back()["method"], "UNSUBSCRIBE");
+    // Still active until the server confirms
+    EXPECT_TRUE(manager.is_active("trade.SOL_USDC"));
+
+    ASSERT_TRUE(manager.on_response(FakeSocket::ack(socket.frames.back())));
+    EXPECT_FALSE(manager.is_active("trade.SOL_USDC"));
+    SubscriptionStats stats = manager.stats();
+    EXPECT_EQ(stats.acks, 2u);
+    EXPECT_EQ(stats.active, 0u);
+    EXPECT_EQ(stats.in_flight, 0u);
+}
+
+TEST(SubscriptionManagerTest, IgnoresMessagesThatAreNotReplies) {
+    FakeSocket socket;
+    SubscriptionManager manager(socket.sender());
+    manager.on_connected();
+
+    EXPECT_FALSE(manager.on_response({{"stream", "trade.SOL_USDC"}, {"data", json::object()}}));
+    EXPECT_FALSE(manager.on_response({{"id", 42}, {"result", nullptr}}));
+}
+
+TEST(SubscriptionManagerTest, RejectedStreamWaitsUntilRequestedAgain) {
+    FakeSocket socket;
+    SubscriptionManager manager(socket.sender());
+    manager.on_connected();
+    manager.subscribe("trade.NOPE_USDC");
+    manager.flush();
+
+    ASSERT_TRUE(manager.on_response(FakeSocket::error(socket.frames.back())));
+    EXPECT_FALSE(manager.is_active("trade.NOPE_USDC"));
+    EXPECT_EQ(manager.stats().rejected, 1u);
+    EXPECT_EQ(manager.stats().errors, 1u);
+    EXPECT_EQ(manager.flush(), 0u);
+
+    manager.subscribe("trade.NOPE_USDC");
+    EXPECT_EQ(manager.flush(), 1u);
+    EXPECT_EQ(manager.stats().rejected, 0u);
+}
+
+TEST(SubscriptionManagerTest, ResendsFramesThatTimeOut) {
+    FakeSocket socket;
+    SubscriptionManager manager(socket.sender(), options(100, std::chrono::milliseconds(20)));
+    manager.on_connected();
+    manager.subscribe("depth.SOL_USDC");
+    ASSERT_EQ(manager.flush(), 1u);
+    json first = socket.frames.back();
+
+    EXPECT_EQ(manager.flush(), 0u);
+    std::this_thread::sleep_for(std::chrono::milliseconds(40));
+    ASSERT_EQ(manager.flush(), 1u);
+    json second = socket.frames.back();
+    EXPECT_EQ(second["params"], first["params"]);
+    EXPECT_NE(second["id"], first["id"]);
+    EXPECT_EQ(manager.stats().timeouts, 1u);
+
+    // A late reply to the expired frame is recognised but changes nothing
+    EXPECT_TRUE(manager.on_response(FakeSocket::ack(first)));
+    EXPECT_FALSE(manager.is_active("depth.SOL_USDC"));
+    EXPECT_TRUE(manager.on_response(FakeSocket::ack(second)));
+    EXPECT_TRUE(manager.is_active("depth.SOL_USDC"));
+}
+
+TEST(SubscriptionManagerTest, RetriesFramesThatCouldNotBeSent) {
+    FakeSocket socket;
+    SubscriptionManager manager(socket.sender(), options(1));
+    manager.on_connected();
+    manager.set_desired({"a", "b"});
+
+    socket.fail_next = 1;
+    EXPECT_EQ(manager.flush(), 0u);
+    EXPECT_EQ(manager.stats().in_flight, 0u);
+
+    EXPECT_EQ(manager.flush(), 2u);
+    EXPECT_EQ(manager.stats().in_flight, 2u);
+}
+
+TEST(SubscriptionManagerTest, ReconnectSubscribesEverythingAgain) {
+    FakeSocket socket;
+    SubscriptionManager manager(socket.sender());
+    manager.on_connected();
+    manager.set_desired({"a", "b"});
+    manager.flush();
+    manager.on_response(FakeSocket::ack(socket.frames.back()));
+    ASSERT_EQ(manager.stats().active, 2u);
+    json old_frame = socket.frames.back();
+
+    manager.on_disconnected();
+    EXPECT_EQ(manager.stats().active, 0u);
+    manager.subscribe("c");
+    EXPECT_EQ(manager.flush(), 0u);
+
+    manager.on_connected();
+    ASSERT_EQ(manager.flush(), 1u);
+    EXPECT_EQ(socket.frames.back()["params"], json({"a", "b", "c"}));
+
+    // A reply from the old connection does not count for the new one
+    manager.on_response(FakeSocket::ack(old_frame));
+    EXPECT_EQ(manager.stats().active, 0u);
+    manager.on_response(FakeSocket::ack(socket.frames.back()));
+    EXPECT_EQ(manager.stats().active, 3u);
+}
+
+TEST(SubscriptionManagerTest, ResubscribeCyclesOneStream) {
+    FakeSocket socket;
+    SubscriptionManager manager(socket.sender());
+    manager.on_connected();
+    manager.set_desired({"a", "b"});
+    manager.flush();
+    manager.on_response(FakeSocket::ack(socket.frames.back()));
+
+    ASSERT_TRUE(manager.resubscribe("a"));
+    ASSERT_EQ(socket.frames.size(), 3u);
+    EXPECT_EQ(socket.frames[1]["method"], "UNSUBSCRIBE");
+    EXPECT_EQ(socket.frames[2]["method"], "SUBSCRIBE");
+    EXPECT_EQ(socket.frames[2]["params"], json({"a"}));
+    EXPECT_TRUE(manager.is_active("b"));
+    // Only one cycle at a time
+    EXPECT_FALSE(manager.resubscribe("a"));
+
+    // The UNSUBSCRIBE's reply leaves the stream waiting on the SUBSCRIBE
+    manager.on_response(FakeSocket::ack(socket.frames[1]));
+    EXPECT_FALSE(manager.is_active("a"));
+    manager.on_response(FakeSocket::ack(socket.frames[2]));
+    EXPECT_TRUE(manager.is_active("a"));
+    EXPECT_FALSE(manager.resubscribe("unknown"));
+}
+
+TEST(SubscriptionManagerTest, GivesUpOnStreamsThatNeverGetAReply) {
+    FakeSocket socket;
+    SubscriptionManager::Options opts = options(100, std::chrono::milliseconds(5));
+    opts.max_retries = 2;
+    SubscriptionManager manager(socket.sender(), opts);
+    manager.on_connected();
+    manager.subscribe("trade.SOL_USDC");
+
+    // The first frame and two resends, then nothing more however long we wait
+    for (int i = 0; i < 6; ++i) {
+        manager.flush();
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_EQ(socket.frames.size(), 3u);
+    SubscriptionStats stats = manager.stats();
+    EXPECT_EQ(stats.timeouts, 3u);
+    EXPECT_EQ(stats.unconfirmed, 1u);
+    EXPECT_EQ(stats.in_flight, 0u);
+    EXPECT_FALSE(manager.is_active("trade.SOL_USDC"));
+
+    // A late reply is recognised but changes nothing
+    EXPECT_TRUE(manager.on_response(FakeSocket::ack(socket.frames.back())));
+    EXPECT_FALSE(manager.is_active("trade.SOL_USDC"));
+
+    // A new connection tries again
+    manager.on_connected();
+    EXPECT_EQ(manager.stats().unconfirmed, 0u);
+    ASSERT_EQ(manager.flush(), 1u);
+    ASSERT_TRUE(manager.on_response(FakeSocket::ack(socket.frames.back())));
+    EXPECT_TRUE(manager.is_active("trade.SOL_USDC"));
+}
+
+TEST(SubscriptionManagerTest, ReplyResetsTheRetryCount) {
+    FakeSocket socket;
+    SubscriptionManager::Options opts = options(100, std::chrono::milliseconds(5));
+    opts.max_retries = 1;
+    SubscriptionManager manager(socket.sender(), opts);
+    manager.on_connected();
+    manager.set_desired({"a", "b"});
+    manager.flush();
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+    // One timeout each; the resend is answered
+    ASSERT_EQ(manager.flush(), 1u);
+    ASSERT_TRUE(manager.on_response(FakeSocket::ack(socket.frames.back())));
+    EXPECT_EQ(manager.stats().active, 2u);
+
+    // Removing "a" times out once and is retried, as the earlier timeout no longer counts
+    manager.unsubscribe("a");
+    ASSERT_EQ(manager.flush(), 1u);
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    ASSERT_EQ(manager.flush(), 1u);
+    EXPECT_EQ(socket.frames.back()["method"], "UNSUBSCRIBE");
+
+    // A second timeout gives up and treats the stream as gone
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    EXPECT_EQ(manager.flush(), 0u);
+    EXPECT_FALSE(manager.is_active("a"));
+    EXPECT_TRUE(manager.is_active("b"));
+}
@@ -0,0 +1,239 @@
+#include "backpack/trade_sequencer.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include <gtest/gtest.h>
+
+using backpack::Trade;
+using backpack::TradeSequencer;
+using backpack::TradeSequencerStats;
+
+namespace {
+
+Trade trade(uint64_t id) {
+    Trade result;
+    result.id = std::to_string(id);
+    result.symbol = "SOL-USDC";
+    return result;
+}
+
+// Serves trades from a fixed history the way GET /api/v1/historicalTrades?fromId= does
+class FakeExchange {
+public:
+    explicit FakeExchange(std::vector<uint64_t> ids) {
+        for (uint64_t id : ids) {
+            history_[id] = trade(id);
+        }
+    }
+
+    TradeSequencer::Fetcher fetcher() {
+        return [this](const std::string&, const std::string& after_id, int limit) {
+            std::unique_lock<std::mutex> lock(mutex_);
+            requests.emplace_back(after_id, limit);
+            cv_.wait(lock, [this]() { return open_; });
+            if (fail) {
+                throw std::runtime_error("HTTP 503");
+            }
+            std::vector<Trade> page;
+            uint64_t after = std::stoull(after_id);
+            for (auto it = history_.lower_bound(inclusive ? after : after + 1);
+                 it != history_.end() && page.size() < static_cast<size_t>(limit); ++it) {
+                page.push_back(it->second);
+            }
+            return page;
+        };
+    }
+
+    // Hold every fetch until release()
+    void hold() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        open_ = false;
+    }
+
+    void release() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            open_ = true;
+        }
+        cv_.notify_all();
+    }
+
+    std::vector<std::pair<std::string, int>> requests;  // (after_id, limit)
+    bool inclusive = false;  // Also return after_id itself, like a server treating fromId as inclusive
+    bool fail = false;
+
+private:
+    std::map<uint64_t, Trade> history_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool open_ = true;
+};
+
+// Collects delivered ids; recovered trades arrive on the sequencer's thread
+class Delivered {
+public:
+    TradeSequencer::Handler handler() {
+        return [this](const Trade& trade) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                ids_.push_back(std::stoull(trade.id));
+            }
+            cv_.notify_all();
+        };
+    }
+
+    std::vector<uint64_t> wait_for(size_t count) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait_for(lock, std::chrono::seconds(5), [&]() { return ids_.size() >= count; });
+        return ids_;
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::vector<uint64_t> ids_;
+};
+
+TradeSequencer::Options options(int page_size = 1000, size_t max_held = 100000) {
+    TradeSequencer::Options result;
+    result.page_size = page_size;
+    result.max_held = max_held;
+    return result;
+}
+
+} // namespace
+
+TEST(TradeSequencerTest, DeliversConsecutiveTradesAndDropsReplays) {
+    FakeExchange exchange({});
+    Delivered delivered;
+    TradeSequencer sequencer(exchange.fetcher());
+    auto on_trade = sequencer.track("SOL-USDC", delivered.handler());
+
+    for (uint64_t id : {7, 8, 9, 8, 9}) {
+        on_trade(trade(id));
+    }
+
+    EXPECT_EQ(delivered.wait_for(3), (std::vector<uint64_t>{7, 8, 9}));
+    EXPECT_EQ(sequencer.last_id("SOL-USDC"), 9u);
+    TradeSequencerStats stats = sequencer.stats();
+    EXPECT_EQ(stats.duplicates, 2u);
+    EXPECT_EQ(stats.gaps, 0u);
+    EXPECT_TRUE(exchange.requests.empty());
+}
+
+TEST(TradeSequencerTest, SplicesBackfillBeforeHeldTrades) {
+    FakeExchange exchange({1, 2, 3, 4, 5, 6});
+    Delivered delivered;
+    TradeSequencer sequencer(exchange.fetcher());
+    auto on_trade = sequencer.track("SOL-USDC", delivered.handler());
+
+    exchange.hold();
+    on_trade(trade(1));
+    on_trade(trade(5));
+    on_trade(trade(6));
+    on_trade(trade(5));
+    EXPECT_EQ(delivered.wait_for(1), (std::vector<uint64_t>{1}));
+    exchange.release();
+
+    EXPECT_EQ(delivered.wait_for(6), (std::vector<uint64_t>{1, 2, 3, 4, 5, 6}));
+    // fromId is exclusive: the first request asks for trades after the last delivered id
+    ASSERT_EQ(exchange.requests.size(), 1u);
+    EXPECT_EQ(exchange.requests[0], std::make_pair(std::string("1"), 4));
+    TradeSequencerStats stats = sequencer.stats();
+    EXPECT_EQ(stats.gaps, 1u);
+    EXPECT_EQ(stats.missing, 3u);
+    EXPECT_EQ(stats.recovered, 3u);
+    EXPECT_EQ(stats.lost, 0u);
+    EXPECT_EQ(stats.duplicates, 1u);
+}
+
+TEST(TradeSequencerTest, PagesThroughLargeGaps) {
+    FakeExchange exchange({1, 2, 3, 4, 5, 6, 7});
+    Delivered delivered;
+    TradeSequencer sequencer(exchange.fetcher(), options(2));
+    auto on_trade = sequencer.track("SOL-USDC", delivered.handler());
+
+    on_trade(trade(1));
+    on_trade(trade(7));
+
+    EXPECT_EQ(delivered.wait_for(7), (std::vector<uint64_t>{1, 2, 3, 4, 5, 6, 7}));
+    std::vector<std::pair<std::string, int>> expected{{"1", 2}, {"3", 2}, {"5", 2}};
+    EXPECT_EQ(exchange.requests, expected);
+    EXPECT_EQ(sequencer.stats().backfill_requests, 3u);
+}
+
+TEST(TradeSequencerTest, ToleratesInclusiveFromId) {
+    FakeExchange exchange({1, 2, 3, 4});
+    exchange.inclusive = true;
+    Delivered delivered;
+    TradeSequencer sequencer(exchange.fetcher());
+    auto on_trade = sequencer.track("SOL-USDC", delivered.handler());
+
+    on_trade(trade(1));
+    on_trade(trade(4));
+
+    EXPECT_EQ(delivered.wait_for(4), (std::vector<uint64_t>{1, 2, 3, 4}));
+    EXPECT_EQ(sequencer.stats().recovered, 2u);
+}
+
+TEST(TradeSequencerTest, CountsTradesTheExchangeNoLongerHas) {
+    FakeExchange exchange({1, 2, 4, 5});
+    Delivered delivered;
+    TradeSequencer sequencer(exchange.fetcher());
+    auto on_trade = sequencer.track("SOL-USDC", delivered.handler());
+
+    on_trade(trade(1));
+    on_trade(trade(5));
+
+    EXPECT_EQ(delivered.wait_for(4), (std::vector<uint64_t>{1, 2, 4, 5}));
+    TradeSequencerStats stats = sequencer.stats();
+    EXPECT_EQ(stats.recovered, 2u);
+    EXPECT_EQ(stats.lost, 1u);
+}
+
+TEST(TradeSequencerTest, FailedBackfillReleasesHeldTrades) {
+    FakeExchange exchange({1, 2, 3, 4, 5});
+    exchange.fail = true;
+    Delivered delivered;
+    TradeSequencer sequencer(exchange.fetcher());
+    auto on_trade = sequencer.track("SOL-USDC", delivered.handler());
+
+    on_trade(trade(1));
+    on_trade(trade(5));
+
+    EXPECT_EQ(delivered.wait_for(2), (std::vector<uint64_t>{1, 5}));
+    TradeSequencerStats stats = sequencer.stats();
+    EXPECT_EQ(stats.backfill_failures, 1u);
+    EXPECT_EQ(stats.lost, 3u);
+    EXPECT_EQ(sequencer.last_id("SOL-USDC"), 5u);
+}
+
+TEST(TradeSequencerTest, AbandonsGapWhenTooManyTradesAreHeld) {
+    FakeExchange exchange({1, 2, 3, 4, 5, 6, 7});
+    Delivered delivered;
+    auto sequencer = std::make_unique<TradeSequencer>(exchange.fetcher(), options(1000, 2));
+    auto on_trade = sequencer->track("SOL-USDC", delivered.handler());
+
+    exchange.hold();
+    on_trade(trade(1));
+    on_trade(trade(5));
+    on_trade(trade(6));
+    // Two trades held: the next one gives up on 2..4 and releases the held trades
+    on_trade(trade(7));
+
+    EXPECT_EQ(delivered.wait_for(4), (std::vector<uint64_t>{1, 5, 6, 7}));
+    EXPECT_EQ(sequencer->stats().lost, 3u);
+    EXPECT_EQ(sequencer->last_id("SOL-USDC"), 7u);
+
+    // The abandoned fetch completes late and is ignored
+    exchange.release();
+    sequencer.reset();
+    EXPECT_EQ(delivered.wait_for(4), (std::vector<uint64_t>{1, 5, 6, 7}));
+}
@@ -0,0 +1,304 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <backpack/utils.hpp>
+
+namespace backpack {
+namespace feedgen {
+
+/**
+ * @brief Shape of the generated frames
+ */
+enum class FeedFraming {
+    LEGACY,   // {"type":"data","channel":...,"symbol":...,"data":...}
+    STREAM    // {"stream":"depth.SOL_USDC","data":...}
+};
+
+struct FeedConfig {
+    std::vector<std::string> symbols = {"SOL-USDC", "BTC-USDC", "ETH-USDC"};
+    std::vector<std::string> channels = {"depth", "trades", "ticker"};
+    size_t depth_levels = 10;   // Levels per side in each depth update
+    bool publish_ts = false;    // Append "ts" (publish time, ns since epoch) to every frame
+    uint64_t seed = 7;
+};
+
+/**
+ * @brief Synthetic depth/trade/ticker frame generator for throughput tests
+ *
+ * Every (symbol, channel) stream owns a pre-rendered JSON template in each
+ * framing with fixed-width numeric fields. Rendering a frame walks the
+ * stream's price and patches those fields in place, so producing a frame is
+ * a handful of digit writes with no JSON serialisation or allocation. That
+ * keeps generation far cheaper than parsing and lets a single core feed the
+ * SDK millions of frames per second.
+ *
+ * Payloads have the shapes the SDK's from_json decoders expect. Not
+ * thread-safe; use one generator per producing thread.
+ */
+class FeedGenerator {
+public:
+    explicit FeedGenerator(FeedConfig config)
+        : config_(std::move(config)), rng_(config_.seed | 1) {
+        if (config_.symbols.empty() || config_.channels.empty()) {
+            throw std::invalid_argument("FeedGenerator needs at least one symbol and one channel");
+        }
+
+        uint64_t trade_id = 100000000;
+        for (const auto& symbol : config_.symbols) {
+            for (const auto& channel : config_.channels) {
+                Stream stream;
+                stream.symbol = symbol;
+                stream.channel = channel;
+                stream.mid_ticks = 1000000 + static_cast<int64_t>(next_random() % 9000000);
+                stream.open_ticks = stream.mid_ticks;
+                stream.next_trade_id = trade_id;
+                trade_id += 100000000;
+                stream.templates[0] = build_template(stream, FeedFraming::LEGACY);
+                stream.templates[1] = build_template(stream, FeedFraming::STREAM);
+                streams_.push_back(std::move(stream));
+            }
+        }
+    }
+
+    /**
+     * @brief Symbols "SYM0-USDC" ... "SYM<n-1>-USDC" for large synthetic universes
+     */
+    static std::vector<std::string> make_symbols(size_t count) {
+        std::vector<std::string> symbols;
+        symbols.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            symbols.push_back("SYM" + std::to_string(i) + "-USDC");
+        }
+        return symbols;
+    }
+
+    /**
+     * @brief Number of (symbol, channel) streams, ordered symbol-major
+     */
+    size_t stream_count() const { return streams_.size(); }
+    const std::string& symbol(size_t stream) const { return streams_[stream].symbol; }
+    const std::string& channel(size_t stream) const { return streams_[stream].channel; }
+
+    /**
+     * @brief Advance a stream and render its next frame
+     *
+     * @return Frame text; valid until the same stream is rendered again in the same framing
+     */
+    const std::string& render(size_t index, FeedFraming framing = FeedFraming::LEGACY) {
+        Stream& stream = streams_[index];
+        Template& tmpl = stream.templates[framing == FeedFraming::LEGACY ? 0 : 1];
+
+        // Random walk of the mid by at most one tick
+        uint64_t r = next_random();
+        stream.mid_ticks += static_cast<int64_t>(r % 3) - 1;
+        stream.mid_ticks = std::max<int64_t>(stream.mid_ticks, static_cast<int64_t>(config_.depth_levels) + 10);
+
+        char* out = &tmpl.text[0];
+        for (const Field& field : tmpl.fields) {
+            char* p = out + field.offset;
+            switch (field.kind) {
+                case FieldKind::BID:
+                    write_fixed(p, PRICE_WIDTH, PRICE_DECIMALS, stream.mid_ticks - 1 - field.level);
+                    break;
+                case FieldKind::ASK:
+                    write_fixed(p, PRICE_WIDTH, PRICE_DECIMALS, stream.mid_ticks + 1 + field.level);
+                    break;
+                case FieldKind::PRICE:
+                    write_fixed(p, PRICE_WIDTH, PRICE_DECIMALS, stream.mid_ticks + static_cast<int64_t>(next_random() % 3) - 1);
+                    break;
+                case FieldKind::QUANTITY:
+                    write_fixed(p, QTY_WIDTH, QTY_DECIMALS, 1 + static_cast<int64_t>(next_random() % 9999999));
+                    break;
+                case FieldKind::VOLUME:
+                    stream.volume += 1 + static_cast<int64_t>(next_random() % 100000);
+                    write_fixed(p, VOLUME_WIDTH, VOLUME_DECIMALS, stream.volume % 10000000000000LL);
+                    break;
+                case FieldKind::CHANGE: {
+                    int64_t change = stream.mid_ticks - stream.open_ticks;
+                    *p = change < 0 ? '-' : '+';
+                    write_fixed(p + 1, CHANGE_WIDTH - 1, PRICE_DECIMALS, change < 0 ? -change : change);
+                    break;
+                }
+                case FieldKind::TRADE_ID:
+                    write_fixed(p, ID_WIDTH, 0, static_cast<int64_t>(stream.next_trade_id++));
+                    break;
+                case FieldKind::BUYER_MAKER:
+                    std::memcpy(p, (next_random() & 1) ? "true " : "false", 5);
+                    break;
+                case FieldKind::TIMESTAMP:
+                    format_iso8601(get_current_timestamp_ms(), p);
+                    break;
+                case FieldKind::PUBLISH_TS:
+                    write_fixed(p, TS_WIDTH, 0, std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::system_clock::now().time_since_epoch()).count());
+                    break;
+            }
+        }
+        ++frames_;
+        return tmpl.text;
+    }
+
+    /**
+     * @brief Render the next frame round-robin across all streams
+     */
+    const std::string& next(FeedFraming framing = FeedFraming::LEGACY) {
+        const std::string& frame = render(cursor_, framing);
+        if (++cursor_ == streams_.size()) {
+            cursor_ = 0;
+        }
+        return frame;
+    }
+
+    uint64_t frames() const { return frames_; }
+
+private:
+    // Fixed field widths; values are zero-padded so templates never change length
+    static constexpr int PRICE_WIDTH = 10;   // 0000000.00
+    static constexpr int PRICE_DECIMALS = 2;
+    static constexpr int QTY_WIDTH = 9;      // 00000.000
+    static constexpr int QTY_DECIMALS = 3;
+    static constexpr int VOLUME_WIDTH = 14;  // 00000000000.00
+    static constexpr int VOLUME_DECIMALS = 2;
+    static constexpr int CHANGE_WIDTH = 9;   // +00000.00
+    static constexpr int ID_WIDTH = 12;
+    static constexpr int TS_WIDTH = 19;
+    static constexpr int TIMESTAMP_WIDTH = static_cast<int>(ISO8601_MS_LENGTH);
+
+    enum class FieldKind {
+        BID, ASK, PRICE, QUANTITY, VOLUME, CHANGE, TRADE_ID, BUYER_MAKER, TIMESTAMP, PUBLISH_TS
+    };
+
+    struct Field {
+        size_t offset;
+        FieldKind kind;
+        int64_t level;
+    };
+
+    struct Template {
+        std::string text;
+        std::vector<Field> fields;
+    };
+
+    struct Stream {
+        std::string symbol;
+        std::string channel;
+        int64_t mid_ticks = 0;
+        int64_t open_ticks = 0;
+        int64_t volume = 0;
+        uint64_t next_trade_id = 0;
+        Template templates[2];
+    };
+
+    // Appends literal text and placeholder fields, recording where each field lives
+    class TemplateBuilder {
+    public:
+        TemplateBuilder& text(const std::string& s) {
+            tmpl_.text += s;
+            return *this;
+        }
+
+        TemplateBuilder& field(FieldKind kind, int width, bool quoted, int64_t level = 0) {
+            if (quoted) {
+                tmpl_.text += '"';
+            }
+            tmpl_.fields.push_back({tmpl_.text.size(), kind, level});
+            tmpl_.text.append(static_cast<size_t>(width), '0');
+            if (quoted) {
+                tmpl_.text += '"';
+            }
+            return *this;
+        }
+
+        Template build() { return std::move(tmpl_); }
+
+    private:
+        Template tmpl_;
+    };
+
+    Template build_template(const Stream& stream, FeedFraming framing) const {
+        TemplateBuilder b;
+        if (framing == FeedFraming::LEGACY) {
+            b.text(R"({"type":"data","channel":")" + stream.channel + R"(","symbol":")" + stream.symbol + R"(","data":)");
+        } else {
+            std::string formatted = stream.symbol;
+            std::replace(formatted.begin(), formatted.end(), '-', '_');
+            b.text(R"({"stream":")" + stream.channel + "." + formatted + R"(","data":)");
+        }
+
+        if (stream.channel == "depth") {
+            b.text(R"({"symbol":")" + stream.symbol + R"(","bids":[)");
+            for (size_t i = 0; i < config_.depth_levels; ++i) {
+                b.text(i == 0 ? "[" : ",[")
+                    .field(FieldKind::BID, PRICE_WIDTH, true, static_cast<int64_t>(i)).text(",")
+                    .field(FieldKind::QUANTITY, QTY_WIDTH, true).text("]");
+            }
+            b.text(R"(],"asks":[)");
+            for (size_t i = 0; i < config_.depth_levels; ++i) {
+                b.text(i == 0 ? "[" : ",[")
+                    .field(FieldKind::ASK, PRICE_WIDTH, true, static_cast<int64_t>(i)).text(",")
+                    .field(FieldKind::QUANTITY, QTY_WIDTH, true).text("]");
+            }
+            b.text("]}");
+        } else if (stream.channel == "trades") {
+            b.text(R"({"symbol":")" + stream.symbol + R"(","id":)").field(FieldKind::TRADE_ID, ID_WIDTH, true)
+                .text(R"(,"timestamp":)").field(FieldKind::TIMESTAMP, TIMESTAMP_WIDTH, true)
+                .text(R"(,"price":)").field(FieldKind::PRICE, PRICE_WIDTH, true)
+                .text(R"(,"quantity":)").field(FieldKind::QUANTITY, QTY_WIDTH, true)
+                .text(R"(,"isBuyerMaker":)").field(FieldKind::BUYER_MAKER, 5, false)
+                .text("}");
+        } else if (stream.channel == "ticker") {
+            b.text(R"({"symbol":")" + stream.symbol + R"(","timestamp":)").field(FieldKind::TIMESTAMP, TIMESTAMP_WIDTH, true)
+                .text(R"(,"lastPrice":)").field(FieldKind::PRICE, PRICE_WIDTH, true)
+                .text(R"(,"bestBid":)").field(FieldKind::BID, PRICE_WIDTH, true)
+                .text(R"(,"bestAsk":)").field(FieldKind::ASK, PRICE_WIDTH, true)
+                .text(R"(,"volume24h":)").field(FieldKind::VOLUME, VOLUME_WIDTH, true)
+                .text(R"(,"priceChange24h":)").field(FieldKind::CHANGE, CHANGE_WIDTH, true)
+                .text("}");
+        } else {
+            throw std::invalid_argument("FeedGenerator does not support channel " + stream.channel);
+        }
+
+        if (config_.publish_ts) {
+            b.text(R"(,"ts":)").field(FieldKind::PUBLISH_TS, TS_WIDTH, false);
+        }
+        b.text("}");
+        return b.build();
+    }
+
+    // Write a non-negative fixed-point value right-aligned and zero-padded into width chars
+    static void write_fixed(char* p, int width, int decimals, int64_t value) {
+        auto v = static_cast<uint64_t>(value);
+        for (int i = width - 1; i >= 0; --i) {
+            if (decimals > 0 && i == width - 1 - decimals) {
+                p[i] = '.';
+                continue;
+            }
+            p[i] = static_cast<char>('0' + v % 10);
+            v /= 10;
+        }
+    }
+
+    // xorshift64*: cheap enough not to show up next to the digit writes
+    uint64_t next_random() {
+        rng_ ^= rng_ >> 12;
+        rng_ ^= rng_ << 25;
+        rng_ ^= rng_ >> 27;
+        return rng_ * 2685821657736338717ULL;
+    }
+
+    FeedConfig config_;
+    std::vector<Stream> streams_;
+    size_t cursor_ = 0;
+    uint64_t frames_ = 0;
+    uint64_t rng_;
+};
+
+} // namespace feedgen
+} // namespace backpack
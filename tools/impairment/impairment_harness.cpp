@@ -0,0 +1,330 @@
+// Network impairment harness for reconnect and tail-latency testing.
+//
+// Starts an ImpairmentProxy in front of a local server (normally mock_exchange),
+// drives a WebSocketClient and a RestClient through it, reconnects whenever the
+// stream dies or goes stale, and reports event latency percentiles and
+// recovery times.
+//
+// Usage: impairment_harness --upstream-port 8443 [--listen-port 9443] [--ca-file mock_exchange_ca.pem]
+//                           [--symbol SOL-USDC] [--duration 30] [--stale-ms 2000]
+//                           [--delay-us 0] [--jitter-us 0] [--bandwidth 0] [--stall-prob 0] [--stall-ms 200]
+//                           [--reset-every-ms 0] [--half-open-every-ms 0]
+//                           [--rest-interval-ms 100] [--rest-timeout-ms 1000] [--proxy-only]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <backpack/rest_client.hpp>
+#include <backpack/websocket_client.hpp>
+
+#include "impairment/impairment_proxy.hpp"
+
+namespace {
+
+using backpack::impairment::Clock;
+using backpack::impairment::ImpairmentConfig;
+using backpack::impairment::ImpairmentProxy;
+
+std::atomic<bool> running(true);
+
+void signal_handler(int) {
+    running = false;
+}
+
+int64_t wall_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+// Thread-safe sample collector reporting percentiles
+class Samples {
+public:
+    void add(double value) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        values_.push_back(value);
+    }
+
+    void report(const char* name, const char* unit) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (values_.empty()) {
+            std::printf("%-22s n=0\n", name);
+            return;
+        }
+        std::sort(values_.begin(), values_.end());
+        std::printf("%-22s n=%-8zu p50=%-10.1f p99=%-10.1f p999=%-10.1f max=%.1f %s\n",
+                    name, values_.size(), percentile(0.50), percentile(0.99), percentile(0.999),
+                    values_.back(), unit);
+    }
+
+private:
+    double percentile(double q) const {
+        size_t index = static_cast<size_t>(q * static_cast<double>(values_.size() - 1));
+        return values_[index];
+    }
+
+    std::mutex mutex_;
+    std::vector<double> values_;
+};
+
+struct HarnessConfig {
+    std::string upstream_host = "127.0.0.1";
+    unsigned short upstream_port = 8443;
+    unsigned short listen_port = 9443;
+    std::string ca_file = "mock_exchange_ca.pem";
+    std::string symbol = "SOL-USDC";
+    int duration_s = 30;
+    std::chrono::milliseconds stale{2000};
+    std::chrono::milliseconds rest_interval{100};
+    std::chrono::milliseconds rest_timeout{1000};
+    bool proxy_only = false;
+    ImpairmentConfig impairment;
+};
+
+struct HarnessResults {
+    Samples event_latency_us;
+    Samples recovery_ms;
+    Samples rest_latency_us;
+    std::atomic<uint64_t> events{0};
+    std::atomic<uint64_t> connect_failures{0};
+    std::atomic<uint64_t> disconnects{0};
+    std::atomic<uint64_t> stale_detections{0};
+    std::atomic<uint64_t> rest_ok{0};
+    std::atomic<uint64_t> rest_failures{0};
+    std::string rest_breakdown;
+};
+
+// Keep one subscribed WebSocketClient alive through the proxy, replacing it on failure
+void run_websocket(const HarnessConfig& config, HarnessResults& results, Clock::time_point deadline) {
+    const std::string uri = "wss://127.0.0.1:" + std::to_string(config.listen_port) + "/";
+
+    // Start of the current outage, measured from the last event seen before it
+    std::atomic<int64_t> last_event_ns{0};
+    bool recovering = false;
+    Clock::time_point outage_start{};
+
+    while (running && Clock::now() < deadline) {
+        std::atomic<bool> closed{false};
+        std::atomic<bool> first_event{false};
+        auto client = std::make_unique<backpack::WebSocketClient>();
+        if (!config.ca_file.empty()) {
+            client->set_ca_file(config.ca_file);
+        }
+
+        client->set_message_handler([&](const std::string& message) {
+            int64_t now = wall_ns();
+            try {
+                auto frame = backpack::json::parse(message);
+                if (!frame.contains("data") || !frame.contains("ts")) {
+                    return;
+                }
+                results.event_latency_us.add(static_cast<double>(now - frame["ts"].get<int64_t>()) / 1000.0);
+                ++results.events;
+                last_event_ns = now;
+                first_event = true;
+            } catch (const std::exception&) {
+                // Truncated frames are expected under mid-frame resets
+            }
+        });
+        client->set_close_handler([&closed]() { closed = true; });
+        client->set_fail_handler([](const std::string&) {});
+        client->set_open_handler([]() {});
+
+        if (!client->connect(uri)) {
+            ++results.connect_failures;
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            continue;
+        }
+
+        try {
+            for (const char* channel : {"trades", "depth", "ticker"}) {
+                backpack::json sub = {{"type", "subscribe"}, {"channel", channel}, {"symbol", config.symbol}};
+                client->send(sub.dump());
+            }
+        } catch (const std::exception&) {
+            ++results.connect_failures;
+            continue;
+        }
+
+        auto connected_at = Clock::now();
+        while (running && Clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+
+            if (recovering && first_event) {
+                results.recovery_ms.add(std::chrono::duration<double, std::milli>(Clock::now() - outage_start).count());
+                recovering = false;
+            }
+
+            if (closed) {
+                ++results.disconnects;
+                break;
+            }
+
+            // Half-open sockets never close; only silence gives them away
+            auto quiet_since = first_event
+                ? Clock::now() - std::chrono::nanoseconds(wall_ns() - last_event_ns.load())
+                : connected_at;
+            if (Clock::now() - quiet_since > config.stale) {
+                ++results.stale_detections;
+                break;
+            }
+        }
+
+        if (!recovering && running && Clock::now() < deadline) {
+            recovering = true;
+            outage_start = last_event_ns.load() != 0
+                ? Clock::now() - std::chrono::nanoseconds(wall_ns() - last_event_ns.load())
+                : Clock::now();
+        }
+        // Destroying the client closes the socket and joins its threads
+        client.reset();
+    }
+}
+
+void run_rest(const HarnessConfig& config, HarnessResults& results, Clock::time_point deadline) {
+    backpack::RestClient client("https://127.0.0.1:" + std::to_string(config.listen_port));
+    if (!config.ca_file.empty()) {
+        client.set_ca_file(config.ca_file);
+    }
+    client.set_request_timeout(config.rest_timeout);
+
+    while (running && Clock::now() < deadline) {
+        auto start = Clock::now();
+        try {
+            client.get_server_time();
+            results.rest_latency_us.add(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+            ++results.rest_ok;
+        } catch (const std::exception&) {
+            ++results.rest_failures;
+        }
+        std::this_thread::sleep_until(start + config.rest_interval);
+    }
+
+    std::ostringstream breakdown;
+    client.metrics().dump(breakdown);
+    results.rest_breakdown = breakdown.str();
+}
+
+void print_usage(const char* argv0) {
+    std::cout << "Usage: " << argv0 << " [options]\n"
+              << "  --upstream-host HOST     Server behind the proxy (default 127.0.0.1)\n"
+              << "  --upstream-port PORT     Server port (default 8443)\n"
+              << "  --listen-port PORT       Proxy listen port (default 9443)\n"
+              << "  --ca-file FILE           CA bundle for the server certificate (default mock_exchange_ca.pem)\n"
+              << "  --symbol SYMBOL          Symbol to subscribe (default SOL-USDC)\n"
+              << "  --duration S             Test duration in seconds (default 30)\n"
+              << "  --stale-ms N             Silence after which the stream is declared dead (default 2000)\n"
+              << "  --delay-us N             One-way delay per chunk\n"
+              << "  --jitter-us N            Uniform +/- jitter per chunk\n"
+              << "  --bandwidth N            Per-direction cap in bytes/sec\n"
+              << "  --stall-prob P           Probability of a stall per chunk\n"
+              << "  --stall-ms N             Stall length (default 200)\n"
+              << "  --reset-every-ms N       Reset live connections mid-frame on this period\n"
+              << "  --half-open-every-ms N   Freeze live connections (half-open) on this period\n"
+              << "  --rest-interval-ms N     Delay between REST probes (default 100)\n"
+              << "  --rest-timeout-ms N      REST request timeout (default 1000)\n"
+              << "  --proxy-only             Only run the proxy until interrupted\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    HarnessConfig config;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                throw std::invalid_argument("Missing value for " + arg);
+            }
+            return argv[++i];
+        };
+
+        try {
+            if (arg == "--upstream-host") config.upstream_host = next();
+            else if (arg == "--upstream-port") config.upstream_port = static_cast<unsigned short>(std::stoi(next()));
+            else if (arg == "--listen-port") config.listen_port = static_cast<unsigned short>(std::stoi(next()));
+            else if (arg == "--ca-file") config.ca_file = next();
+            else if (arg == "--symbol") config.symbol = next();
+            else if (arg == "--duration") config.duration_s = std::stoi(next());
+            else if (arg == "--stale-ms") config.stale = std::chrono::milliseconds(std::stoll(next()));
+            else if (arg == "--delay-us") config.impairment.delay = std::chrono::microseconds(std::stoll(next()));
+            else if (arg == "--jitter-us") config.impairment.jitter = std::chrono::microseconds(std::stoll(next()));
+            else if (arg == "--bandwidth") config.impairment.bandwidth_bps = std::stoull(next());
+            else if (arg == "--stall-prob") config.impairment.stall_probability = std::stod(next());
+            else if (arg == "--stall-ms") config.impairment.stall = std::chrono::milliseconds(std::stoll(next()));
+            else if (arg == "--reset-every-ms") config.impairment.reset_every = std::chrono::milliseconds(std::stoll(next()));
+            else if (arg == "--half-open-every-ms") config.impairment.half_open_every = std::chrono::milliseconds(std::stoll(next()));
+            else if (arg == "--rest-interval-ms") config.rest_interval = std::chrono::milliseconds(std::stoll(next()));
+            else if (arg == "--rest-timeout-ms") config.rest_timeout = std::chrono::milliseconds(std::stoll(next()));
+            else if (arg == "--proxy-only") config.proxy_only = true;
+            else if (arg == "--help" || arg == "-h") {
+                print_usage(argv[0]);
+                return 0;
+            } else {
+                throw std::invalid_argument("Unknown option " + arg);
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    std::signal(SIGINT, signal_handler);
+    std::signal(SIGTERM, signal_handler);
+
+    try {
+        ImpairmentProxy proxy(config.listen_port, config.upstream_host, config.upstream_port, config.impairment);
+        proxy.start();
+        std::cout << "Impairment proxy 127.0.0.1:" << proxy.port() << " -> "
+                  << config.upstream_host << ":" << config.upstream_port << std::endl;
+
+        if (config.proxy_only) {
+            while (running) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(200));
+            }
+            return 0;
+        }
+
+        HarnessResults results;
+        auto deadline = Clock::now() + std::chrono::seconds(config.duration_s);
+
+        std::thread rest_thread([&]() { run_rest(config, results, deadline); });
+        run_websocket(config, results, deadline);
+        rest_thread.join();
+
+        const auto& stats = proxy.stats();
+        std::printf("\nproxy: connections=%llu bytes=%llu stalls=%llu resets=%llu half_opens=%llu\n",
+                    static_cast<unsigned long long>(stats.connections.load()),
+                    static_cast<unsigned long long>(stats.bytes_forwarded.load()),
+                    static_cast<unsigned long long>(stats.stalls.load()),
+                    static_cast<unsigned long long>(stats.resets.load()),
+                    static_cast<unsigned long long>(stats.half_opens.load()));
+        std::printf("websocket: events=%llu disconnects=%llu stale=%llu connect_failures=%llu\n",
+                    static_cast<unsigned long long>(results.events.load()),
+                    static_cast<unsigned long long>(results.disconnects.load()),
+                    static_cast<unsigned long long>(results.stale_detections.load()),
+                    static_cast<unsigned long long>(results.connect_failures.load()));
+        std::printf("rest: ok=%llu failures=%llu\n",
+                    static_cast<unsigned long long>(results.rest_ok.load()),
+                    static_cast<unsigned long long>(results.rest_failures.load()));
+        results.event_latency_us.report("event latency", "us");
+        results.recovery_ms.report("recovery time", "ms");
+        results.rest_latency_us.report("rest latency", "us");
+        std::cout << results.rest_breakdown << std::flush;
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
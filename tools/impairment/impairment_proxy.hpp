@@ -0,0 +1,343 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/asio.hpp>
+
+namespace backpack {
+namespace impairment {
+
+namespace net = boost::asio;
+using tcp = boost::asio::ip::tcp;
+using Clock = std::chrono::steady_clock;
+
+/**
+ * @brief Impairments applied by ImpairmentProxy to every proxied connection
+ *
+ * All impairments operate on the TCP byte stream, so they apply equally to
+ * TLS WebSocket and HTTPS traffic.
+ */
+struct ImpairmentConfig {
+    std::chrono::microseconds delay{0};        // One-way delay added to every chunk
+    std::chrono::microseconds jitter{0};       // Uniform +/- jitter, order is preserved
+    uint64_t bandwidth_bps = 0;                // Per-direction cap in bytes/sec, 0 = unlimited
+    double stall_probability = 0.0;            // Chance per chunk of a retransmit-style stall
+    std::chrono::milliseconds stall{200};      // Length of each stall
+    std::chrono::milliseconds reset_every{0};  // Reset all live connections mid-chunk on this period
+    std::chrono::milliseconds half_open_every{0}; // Silently freeze all live connections on this period
+};
+
+struct ProxyStats {
+    std::atomic<uint64_t> connections{0};
+    std::atomic<uint64_t> bytes_forwarded{0};
+    std::atomic<uint64_t> stalls{0};
+    std::atomic<uint64_t> resets{0};
+    std::atomic<uint64_t> half_opens{0};
+};
+
+/**
+ * @brief Loopback TCP proxy that injects delay, jitter, bandwidth caps,
+ * stalls, half-open sockets and mid-frame resets
+ *
+ * Runs on its own io thread. Point the SDK at the listen port instead of the
+ * server to route traffic through it.
+ */
+class ImpairmentProxy {
+public:
+    ImpairmentProxy(unsigned short listen_port, std::string upstream_host, unsigned short upstream_port,
+                    ImpairmentConfig config)
+        : config_(config)
+        , upstream_host_(std::move(upstream_host))
+        , upstream_port_(upstream_port)
+        , acceptor_(ioc_, tcp::endpoint(net::ip::make_address("127.0.0.1"), listen_port))
+        , accept_timer_(ioc_)
+        , reset_timer_(ioc_)
+        , half_open_timer_(ioc_) {}
+
+    ~ImpairmentProxy() {
+        stop();
+    }
+
+    unsigned short port() const {
+        return acceptor_.local_endpoint().port();
+    }
+
+    const ProxyStats& stats() const { return stats_; }
+
+    void start() {
+        do_accept();
+        schedule(reset_timer_, config_.reset_every, [this]() {
+            for_each_pipe([this](Pipe& pipe) { pipe.reset_pending = true; });
+        });
+        schedule(half_open_timer_, config_.half_open_every, [this]() {
+            for_each_pipe([this](Pipe& pipe) {
+                if (!pipe.frozen) {
+                    pipe.frozen = true;
+                    ++stats_.half_opens;
+                }
+            });
+        });
+        thread_ = std::thread([this]() { ioc_.run(); });
+    }
+
+    void stop() {
+        ioc_.stop();
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+    }
+
+private:
+    struct Chunk {
+        Clock::time_point release;
+        std::vector<char> data;
+    };
+
+    // One direction of a proxied connection
+    struct Direction {
+        tcp::socket* from = nullptr;
+        tcp::socket* to = nullptr;
+        std::vector<char> read_buffer = std::vector<char>(16 * 1024);
+        std::deque<Chunk> pending;
+        size_t pending_bytes = 0;
+        Clock::time_point last_release{};
+        bool writing = false;
+        bool reading = false;
+        std::unique_ptr<net::steady_timer> timer;
+    };
+
+    struct Pipe {
+        explicit Pipe(net::io_context& ioc) : client(ioc), upstream(ioc) {}
+
+        tcp::socket client;
+        tcp::socket upstream;
+        Direction downstream;   // upstream -> client
+        Direction upstream_dir; // client -> upstream
+        bool frozen = false;
+        bool reset_pending = false;
+        bool closed = false;
+    };
+
+    static constexpr size_t MAX_PENDING_BYTES = 4 * 1024 * 1024;
+    static constexpr std::chrono::milliseconds MIN_ACCEPT_BACKOFF{100};
+    static constexpr std::chrono::milliseconds MAX_ACCEPT_BACKOFF{1000};
+
+    template<typename Fn>
+    void schedule(net::steady_timer& timer, std::chrono::milliseconds period, Fn fn) {
+        if (period.count() == 0) {
+            return;
+        }
+        timer.expires_after(period);
+        timer.async_wait([this, &timer, period, fn](const boost::system::error_code& ec) {
+            if (!ec) {
+                fn();
+                schedule(timer, period, fn);
+            }
+        });
+    }
+
+    template<typename Fn>
+    void for_each_pipe(Fn fn) {
+        for (auto it = pipes_.begin(); it != pipes_.end();) {
+            if (auto pipe = it->lock()) {
+                fn(*pipe);
+                ++it;
+            } else {
+                it = pipes_.erase(it);
+            }
+        }
+    }
+
+    void do_accept() {
+        auto pipe = std::make_shared<Pipe>(ioc_);
+        acceptor_.async_accept(pipe->client, [this, pipe](const boost::system::error_code& ec) {
+            if (ec == net::error::operation_aborted) {
+                return;
+            }
+            if (!ec) {
+                accept_backoff_ = MIN_ACCEPT_BACKOFF;
+                connect_upstream(pipe);
+                do_accept();
+                return;
+            }
+
+            // Errors such as EMFILE fail again immediately; retrying at once would spin this thread
+            std::cerr << "Impairment proxy accept failed: " << ec.message() << ", retrying in "
+                      << accept_backoff_.count() << "ms" << std::endl;
+            accept_timer_.expires_after(accept_backoff_);
+            accept_backoff_ = std::min(accept_backoff_ * 2, MAX_ACCEPT_BACKOFF);
+            accept_timer_.async_wait([this](const boost::system::error_code& ec) {
+                if (!ec) {
+                    do_accept();
+                }
+            });
+        });
+    }
+
+    void connect_upstream(const std::shared_ptr<Pipe>& pipe) {
+        tcp::resolver resolver(ioc_);
+        boost::system::error_code ec;
+        auto endpoints = resolver.resolve(upstream_host_, std::to_string(upstream_port_), ec);
+        if (ec) {
+            return;
+        }
+
+        net::async_connect(pipe->upstream, endpoints,
+            [this, pipe](const boost::system::error_code& ec, const tcp::endpoint&) {
+                if (ec) {
+                    return;
+                }
+                ++stats_.connections;
+                pipe->client.set_option(tcp::no_delay(true));
+                pipe->upstream.set_option(tcp::no_delay(true));
+
+                init_direction(pipe->upstream_dir, pipe->client, pipe->upstream);
+                init_direction(pipe->downstream, pipe->upstream, pipe->client);
+                pipes_.push_back(pipe);
+
+                do_read(pipe, pipe->upstream_dir);
+                do_read(pipe, pipe->downstream);
+            });
+    }
+
+    void init_direction(Direction& dir, tcp::socket& from, tcp::socket& to) {
+        dir.from = &from;
+        dir.to = &to;
+        dir.timer = std::make_unique<net::steady_timer>(ioc_);
+    }
+
+    void do_read(const std::shared_ptr<Pipe>& pipe, Direction& dir) {
+        if (pipe->closed || dir.reading || dir.pending_bytes >= MAX_PENDING_BYTES) {
+            return;
+        }
+        dir.reading = true;
+        dir.from->async_read_some(net::buffer(dir.read_buffer),
+            [this, pipe, &dir](const boost::system::error_code& ec, std::size_t n) {
+                dir.reading = false;
+                if (ec) {
+                    close(pipe, false);
+                    return;
+                }
+                // A half-open peer swallows everything without closing
+                if (!pipe->frozen) {
+                    enqueue(pipe, dir, n);
+                }
+                do_read(pipe, dir);
+            });
+    }
+
+    // Work out when this chunk may leave, honouring delay, jitter, bandwidth and stalls
+    void enqueue(const std::shared_ptr<Pipe>& pipe, Direction& dir, std::size_t n) {
+        auto now = Clock::now();
+        auto release = now + config_.delay;
+        if (config_.jitter.count() > 0) {
+            std::uniform_int_distribution<int64_t> dist(-config_.jitter.count(), config_.jitter.count());
+            release += std::chrono::microseconds(dist(rng_));
+        }
+        if (config_.stall_probability > 0.0 && std::uniform_real_distribution<double>(0.0, 1.0)(rng_) < config_.stall_probability) {
+            release += config_.stall;
+            ++stats_.stalls;
+        }
+        release = std::max(release, dir.last_release);
+        if (config_.bandwidth_bps > 0) {
+            auto transmit = std::chrono::nanoseconds(n * 1000000000ULL / config_.bandwidth_bps);
+            release = std::max(release, dir.last_release) + std::chrono::duration_cast<Clock::duration>(transmit);
+        }
+        dir.last_release = release;
+
+        dir.pending.push_back({release, std::vector<char>(dir.read_buffer.begin(), dir.read_buffer.begin() + n)});
+        dir.pending_bytes += n;
+        if (!dir.writing) {
+            do_write(pipe, dir);
+        }
+    }
+
+    void do_write(const std::shared_ptr<Pipe>& pipe, Direction& dir) {
+        if (pipe->closed || dir.pending.empty() || pipe->frozen) {
+            dir.writing = false;
+            return;
+        }
+        dir.writing = true;
+
+        dir.timer->expires_at(dir.pending.front().release);
+        dir.timer->async_wait([this, pipe, &dir](const boost::system::error_code& ec) {
+            if (ec || pipe->closed || pipe->frozen) {
+                dir.writing = false;
+                return;
+            }
+
+            Chunk& chunk = dir.pending.front();
+            size_t length = chunk.data.size();
+            bool reset_after = false;
+            if (pipe->reset_pending) {
+                // Deliver only part of the chunk so the peer sees a truncated frame
+                length = std::max<size_t>(1, length / 2);
+                reset_after = true;
+            }
+
+            net::async_write(*dir.to, net::buffer(chunk.data.data(), length),
+                [this, pipe, &dir, reset_after](const boost::system::error_code& ec, std::size_t written) {
+                    if (ec) {
+                        close(pipe, false);
+                        return;
+                    }
+                    stats_.bytes_forwarded += written;
+                    if (reset_after) {
+                        ++stats_.resets;
+                        close(pipe, true);
+                        return;
+                    }
+                    dir.pending_bytes -= dir.pending.front().data.size();
+                    dir.pending.pop_front();
+                    do_read(pipe, dir);
+                    do_write(pipe, dir);
+                });
+        });
+    }
+
+    // Close both sides; abortive close sends RST instead of FIN
+    void close(const std::shared_ptr<Pipe>& pipe, bool abortive) {
+        if (pipe->closed) {
+            return;
+        }
+        pipe->closed = true;
+        boost::system::error_code ignored;
+        for (tcp::socket* socket : {&pipe->client, &pipe->upstream}) {
+            if (abortive) {
+                socket->set_option(net::socket_base::linger(true, 0), ignored);
+            }
+            socket->close(ignored);
+        }
+        for (Direction* dir : {&pipe->downstream, &pipe->upstream_dir}) {
+            if (dir->timer) {
+                dir->timer->cancel();
+            }
+        }
+    }
+
+    ImpairmentConfig config_;
+    std::string upstream_host_;
+    unsigned short upstream_port_;
+    net::io_context ioc_;
+    tcp::acceptor acceptor_;
+    net::steady_timer accept_timer_;
+    std::chrono::milliseconds accept_backoff_{MIN_ACCEPT_BACKOFF};
+    net::steady_timer reset_timer_;
+    net::steady_timer half_open_timer_;
+    std::vector<std::weak_ptr<Pipe>> pipes_;
+    std::mt19937_64 rng_{std::random_device{}()};
+    ProxyStats stats_;
+    std::thread thread_;
+};
+
+} // namespace impairment
+} // namespace backpack
@@ -0,0 +1,295 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <deque>
+#include <functional>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+#include <backpack/utils.hpp>
+
+namespace backpack {
+namespace mock {
+
+using json = nlohmann::json;
+
+/**
+ * @brief Simulated market for the mock exchange
+ *
+ * Keeps a price-level book and a trade tape per symbol and renders them in the
+ * JSON shapes the SDK's from_json decoders expect. Not thread-safe; the mock
+ * server drives it from its single io thread.
+ */
+class MarketSimulator {
+public:
+    struct Config {
+        std::vector<std::string> symbols = {"SOL-USDC", "BTC-USDC", "ETH-USDC"};
+        size_t book_levels = 20;    // Levels per side kept in the book
+        double churn = 0.2;         // Fraction of levels touched by each depth update
+        size_t trade_history = 1000; // Trades kept for REST trade queries
+        uint64_t seed = 42;
+    };
+
+    explicit MarketSimulator(Config config)
+        : config_(std::move(config)), rng_(config_.seed) {
+        uint64_t trade_id = 10000000;
+        for (const auto& name : config_.symbols) {
+            SymbolState state;
+            state.symbol = name;
+            state.tick_size = 0.01;
+            state.decimals = 2;
+            state.mid_ticks = 10000 + static_cast<int64_t>(rng_() % 90000);
+            state.next_trade_id = trade_id;
+            trade_id += 10000000;
+            state.open_ticks = state.mid_ticks;
+            rebuild_book(state);
+            symbols_.emplace(name, std::move(state));
+        }
+    }
+
+    const std::vector<std::string>& symbols() const { return config_.symbols; }
+
+    bool has_symbol(const std::string& symbol) const {
+        return symbols_.count(symbol) != 0;
+    }
+
+    /**
+     * @brief Move the book: walk the mid and rewrite a churn-sized subset of levels
+     *
+     * @return Depth update payload with the changed levels (quantity "0" removes a level)
+     */
+    json next_depth_update(const std::string& symbol) {
+        SymbolState& s = state(symbol);
+        json bids = json::array();
+        json asks = json::array();
+
+        std::uniform_int_distribution<int> step(-1, 1);
+        int64_t shift = step(rng_);
+        if (shift != 0) {
+            s.mid_ticks = std::max<int64_t>(s.mid_ticks + shift, static_cast<int64_t>(config_.book_levels) + 2);
+            // Drop levels that crossed the new mid
+            for (auto it = s.bids.begin(); it != s.bids.end();) {
+                if (it->first >= s.mid_ticks) {
+                    bids.push_back(level(s, it->first, 0.0));
+                    it = s.bids.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+            for (auto it = s.asks.begin(); it != s.asks.end();) {
+                if (it->first <= s.mid_ticks) {
+                    asks.push_back(level(s, it->first, 0.0));
+                    it = s.asks.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+        }
+
+        size_t touched = std::max<size_t>(1, static_cast<size_t>(std::lround(config_.churn * config_.book_levels)));
+        std::uniform_int_distribution<int64_t> offset(1, static_cast<int64_t>(config_.book_levels));
+        for (size_t i = 0; i < touched; ++i) {
+            int64_t bid_price = s.mid_ticks - offset(rng_);
+            double bid_qty = random_quantity();
+            s.bids[bid_price] = bid_qty;
+            bids.push_back(level(s, bid_price, bid_qty));
+
+            int64_t ask_price = s.mid_ticks + offset(rng_);
+            double ask_qty = random_quantity();
+            s.asks[ask_price] = ask_qty;
+            asks.push_back(level(s, ask_price, ask_qty));
+        }
+
+        return {{"symbol", symbol}, {"bids", bids}, {"asks", asks}};
+    }
+
+    /**
+     * @brief Print a trade at the touch and append it to the tape
+     */
+    json next_trade(const std::string& symbol) {
+        SymbolState& s = state(symbol);
+        bool buyer_maker = (rng_() & 1) != 0;
+        int64_t price = buyer_maker ? s.mid_ticks - 1 : s.mid_ticks + 1;
+        double quantity = random_quantity() / 10.0;
+
+        json trade = {
+            {"symbol", symbol},
+            {"id", std::to_string(s.next_trade_id++)},
+            {"timestamp", timestamp_to_iso8601(get_current_timestamp_ms())},
+            {"price", format_price(s, price)},
+            {"quantity", format_quantity(quantity)},
+            {"isBuyerMaker", buyer_maker}
+        };
+
+        s.last_ticks = price;
+        s.volume += quantity;
+        s.trades.push_back(trade);
+        if (s.trades.size() > config_.trade_history) {
+            s.trades.pop_front();
+        }
+        return trade;
+    }
+
+    json ticker(const std::string& symbol) {
+        SymbolState& s = state(symbol);
+        int64_t last = s.last_ticks ? s.last_ticks : s.mid_ticks;
+        return {
+            {"symbol", symbol},
+            {"timestamp", timestamp_to_iso8601(get_current_timestamp_ms())},
+            {"lastPrice", format_price(s, last)},
+            {"bestBid", format_price(s, s.bids.empty() ? s.mid_ticks - 1 : s.bids.rbegin()->first)},
+            {"bestAsk", format_price(s, s.asks.empty() ? s.mid_ticks + 1 : s.asks.begin()->first)},
+            {"volume24h", format_quantity(s.volume)},
+            {"priceChange24h", format_price(s, last - s.open_ticks)}
+        };
+    }
+
+    json depth_snapshot(const std::string& symbol, size_t limit) {
+        SymbolState& s = state(symbol);
+        json bids = json::array();
+        json asks = json::array();
+        for (auto it = s.bids.rbegin(); it != s.bids.rend() && bids.size() < limit; ++it) {
+            bids.push_back(level(s, it->first, it->second));
+        }
+        for (auto it = s.asks.begin(); it != s.asks.end() && asks.size() < limit; ++it) {
+            asks.push_back(level(s, it->first, it->second));
+        }
+        return {{"symbol", symbol}, {"bids", bids}, {"asks", asks}};
+    }
+
+    json recent_trades(const std::string& symbol, size_t limit) {
+        SymbolState& s = state(symbol);
+        json trades = json::array();
+        size_t start = s.trades.size() > limit ? s.trades.size() - limit : 0;
+        for (size_t i = start; i < s.trades.size(); ++i) {
+            trades.push_back(s.trades[i]);
+        }
+        return trades;
+    }
+
+    /**
+     * @brief Trades with id > from_id, oldest first, like the exchange's fromId
+     */
+    json trades_after(const std::string& symbol, uint64_t from_id, size_t limit) {
+        SymbolState& s = state(symbol);
+        json trades = json::array();
+        for (const auto& trade : s.trades) {
+            if (std::stoull(trade["id"].get<std::string>()) > from_id) {
+                trades.push_back(trade);
+                if (trades.size() >= limit) {
+                    break;
+                }
+            }
+        }
+        return trades;
+    }
+
+    json klines(const std::string& symbol, size_t limit) {
+        SymbolState& s = state(symbol);
+        json candles = json::array();
+        int64_t now = get_current_timestamp_ms() / 60000 * 60000;
+        for (size_t i = limit; i > 0; --i) {
+            int64_t open = s.mid_ticks - static_cast<int64_t>(i % 7);
+            candles.push_back({
+                now - static_cast<int64_t>(i - 1) * 60000,
+                format_price(s, open),
+                format_price(s, open + 3),
+                format_price(s, open - 3),
+                format_price(s, s.mid_ticks),
+                format_quantity(random_quantity())
+            });
+        }
+        return candles;
+    }
+
+    json exchange_info() const {
+        json symbols = json::array();
+        for (const auto& name : config_.symbols) {
+            const SymbolState& s = symbols_.at(name);
+            auto dash = name.find('-');
+            symbols.push_back({
+                {"symbol", name},
+                {"baseAsset", name.substr(0, dash)},
+                {"quoteAsset", dash == std::string::npos ? "" : name.substr(dash + 1)},
+                {"isActive", true},
+                {"minPrice", format_price(s, 1)},
+                {"maxPrice", "1000000"},
+                {"tickSize", format_price(s, 1)},
+                {"minQty", "0.001"},
+                {"maxQty", "100000"},
+                {"stepSize", "0.001"}
+            });
+        }
+        return {{"timezone", "UTC"}, {"serverTime", get_current_timestamp_ms()}, {"symbols", symbols}};
+    }
+
+    std::string mid_price(const std::string& symbol) {
+        SymbolState& s = state(symbol);
+        return format_price(s, s.mid_ticks);
+    }
+
+private:
+    struct SymbolState {
+        std::string symbol;
+        double tick_size = 0.01;
+        int decimals = 2;
+        int64_t mid_ticks = 0;
+        int64_t open_ticks = 0;
+        int64_t last_ticks = 0;
+        double volume = 0.0;
+        uint64_t next_trade_id = 0;
+        std::map<int64_t, double> bids;
+        std::map<int64_t, double> asks;
+        std::deque<json> trades;
+    };
+
+    SymbolState& state(const std::string& symbol) {
+        auto it = symbols_.find(symbol);
+        if (it == symbols_.end()) {
+            throw std::invalid_argument("Unknown symbol: " + symbol);
+        }
+        return it->second;
+    }
+
+    void rebuild_book(SymbolState& s) {
+        s.bids.clear();
+        s.asks.clear();
+        for (size_t i = 1; i <= config_.book_levels; ++i) {
+            s.bids[s.mid_ticks - static_cast<int64_t>(i)] = random_quantity();
+            s.asks[s.mid_ticks + static_cast<int64_t>(i)] = random_quantity();
+        }
+    }
+
+    double random_quantity() {
+        std::uniform_real_distribution<double> dist(0.1, 250.0);
+        return dist(rng_);
+    }
+
+    json level(const SymbolState& s, int64_t price_ticks, double quantity) const {
+        return json::array({format_price(s, price_ticks), format_quantity(quantity)});
+    }
+
+    static std::string format_price(const SymbolState& s, int64_t ticks) {
+        char buf[32];
+        std::snprintf(buf, sizeof(buf), "%.*f", s.decimals, static_cast<double>(ticks) * s.tick_size);
+        return buf;
+    }
+
+    static std::string format_quantity(double quantity) {
+        char buf[32];
+        std::snprintf(buf, sizeof(buf), "%.3f", quantity);
+        return buf;
+    }
+
+    Config config_;
+    std::mt19937_64 rng_;
+    std::map<std::string, SymbolState> symbols_;
+};
+
+} // namespace mock
+} // namespace backpack
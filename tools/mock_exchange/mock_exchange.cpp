@@ -0,0 +1,1015 @@
+// Local mock of the Backpack Exchange REST and WebSocket APIs.
+//
+// Serves the REST endpoints RestClient calls and the WebSocket subscription
+// protocols spoken by BackpackClient ({"type":"subscribe",...}) and
+// SubscriptionRequest ({"method":"SUBSCRIBE","params":[...]}) over TLS on a
+// single port, so throughput and latency tests can run entirely on localhost.
+//
+// Usage: mock_exchange [--port 8443] [--symbols SOL-USDC,BTC-USDC] [--rate 100]
+//                      [--book-levels 20] [--churn 0.2] [--latency-us 0] [--jitter-us 0]
+//                      [--verify-signatures] [--window-ms 5000]
+//                      [--cert cert.pem --key key.pem] [--ca-out mock_exchange_ca.pem]
+//                      [--stats-interval 5] [--synthetic] [--synthetic-symbols N]
+
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <boost/asio.hpp>
+#include <boost/asio/ssl.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include <boost/beast/ssl.hpp>
+#include <boost/beast/websocket.hpp>
+#include <boost/beast/websocket/ssl.hpp>
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+#include <openssl/x509v3.h>
+
+#include <backpack/codec.hpp>
+#include <backpack/types.hpp>
+#include <backpack/utils.hpp>
+
+#include "feedgen/feed_generator.hpp"
+#include "market.hpp"
+
+namespace beast = boost::beast;
+namespace http = beast::http;
+namespace websocket = beast::websocket;
+namespace net = boost::asio;
+namespace ssl = boost::asio::ssl;
+using tcp = boost::asio::ip::tcp;
+
+namespace backpack {
+namespace mock {
+
+struct ServerConfig {
+    std::string address = "127.0.0.1";
+    unsigned short port = 8443;
+    double rate = 100.0;                        // Messages per second per subscribed stream
+    std::chrono::microseconds latency{0};       // Added to every REST response and WS frame
+    std::chrono::microseconds jitter{0};        // Uniform +/- jitter on top of latency
+    bool verify_signatures = false;
+    int64_t signature_window_ms = 5000;
+    std::string cert_file;
+    std::string key_file;
+    std::string ca_out = "mock_exchange_ca.pem";
+    int stats_interval_s = 5;
+    size_t max_queue = 100000;                  // Per-session outbound frames before dropping
+    bool synthetic = false;                     // Publish FeedGenerator frames instead of the simulator's
+    MarketSimulator::Config market;
+};
+
+struct ServerStats {
+    uint64_t sessions = 0;
+    uint64_t frames_sent = 0;
+    uint64_t frames_dropped = 0;
+    uint64_t rest_requests = 0;
+    uint64_t auth_failures = 0;
+};
+
+// Frames are published either in BackpackClient's legacy shape or the stream shape
+enum class Framing {
+    LEGACY,   // {"type":"data","channel":...,"symbol":...,"data":...}
+    STREAM    // {"stream":"ticker.SOL_USDC","data":...}
+};
+
+using Frame = std::shared_ptr<const std::string>;
+
+class Server;
+
+// ---------------------------------------------------------------------------
+// TLS helpers
+// ---------------------------------------------------------------------------
+
+// Self-signed P-256 certificate for localhost, used when no --cert/--key is given
+void make_self_signed(ssl::context& ctx, const std::string& ca_out) {
+    EVP_PKEY* pkey = EVP_EC_gen("P-256");
+    if (!pkey) {
+        throw std::runtime_error("Failed to generate TLS key");
+    }
+
+    X509* cert = X509_new();
+    X509_set_version(cert, 2);
+    ASN1_INTEGER_set(X509_get_serialNumber(cert), static_cast<long>(std::random_device{}() & 0x7fffffff));
+    X509_gmtime_adj(X509_getm_notBefore(cert), -60);
+    X509_gmtime_adj(X509_getm_notAfter(cert), 60L * 60 * 24 * 30);
+    X509_set_pubkey(cert, pkey);
+
+    X509_NAME* name = X509_get_subject_name(cert);
+    X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC,
+                               reinterpret_cast<const unsigned char*>("localhost"), -1, -1, 0);
+    X509_set_issuer_name(cert, name);
+
+    X509V3_CTX v3;
+    X509V3_set_ctx_nodb(&v3);
+    X509V3_set_ctx(&v3, cert, cert, nullptr, nullptr, 0);
+    const char* extensions[][2] = {
+        {"subjectAltName", "DNS:localhost,IP:127.0.0.1"},
+        {"basicConstraints", "critical,CA:TRUE"},
+        {"keyUsage", "critical,digitalSignature,keyCertSign"}
+    };
+    for (const auto& ext_def : extensions) {
+        X509_EXTENSION* ext = X509V3_EXT_conf_nid(nullptr, &v3, OBJ_txt2nid(ext_def[0]), ext_def[1]);
+        if (ext) {
+            X509_add_ext(cert, ext, -1);
+            X509_EXTENSION_free(ext);
+        }
+    }
+
+    if (!X509_sign(cert, pkey, EVP_sha256())) {
+        X509_free(cert);
+        EVP_PKEY_free(pkey);
+        throw std::runtime_error("Failed to sign TLS certificate");
+    }
+
+    SSL_CTX_use_certificate(ctx.native_handle(), cert);
+    SSL_CTX_use_PrivateKey(ctx.native_handle(), pkey);
+
+    // Clients trust the mock by loading this file via set_ca_file()
+    if (FILE* f = std::fopen(ca_out.c_str(), "w")) {
+        PEM_write_X509(f, cert);
+        std::fclose(f);
+        std::cout << "Wrote mock exchange certificate to " << ca_out << std::endl;
+    } else {
+        std::cerr << "Failed to write certificate to " << ca_out << std::endl;
+    }
+
+    X509_free(cert);
+    EVP_PKEY_free(pkey);
+}
+
+// Verify X-BPX-SIGNATURE the way RestClient::sign_request produces it
+bool verify_ed25519(const std::string& public_key_b64, const std::string& message, const std::string& signature_b64) {
+    std::vector<unsigned char> public_key;
+    std::vector<unsigned char> signature;
+    try {
+        public_key = codec::base64_decode(public_key_b64);
+        signature = codec::base64_decode(signature_b64);
+    } catch (const std::invalid_argument&) {
+        return false;
+    }
+    if (public_key.size() != 32 || signature.size() != 64) {
+        return false;
+    }
+
+    EVP_PKEY* pkey = EVP_PKEY_new_raw_public_key(EVP_PKEY_ED25519, nullptr, public_key.data(), public_key.size());
+    if (!pkey) {
+        return false;
+    }
+
+    EVP_MD_CTX* ctx = EVP_MD_CTX_new();
+    bool ok = ctx &&
+        EVP_DigestVerifyInit(ctx, nullptr, nullptr, nullptr, pkey) == 1 &&
+        EVP_DigestVerify(ctx,
+            reinterpret_cast<const unsigned char*>(signature.data()), signature.size(),
+            reinterpret_cast<const unsigned char*>(message.data()), message.size()) == 1;
+
+    EVP_MD_CTX_free(ctx);
+    EVP_PKEY_free(pkey);
+    return ok;
+}
+
+// ---------------------------------------------------------------------------
+// Request parsing helpers
+// ---------------------------------------------------------------------------
+
+std::string percent_decode(const std::string& in) {
+    std::string out;
+    out.reserve(in.size());
+    for (size_t i = 0; i < in.size(); ++i) {
+        if (in[i] == '%' && i + 2 < in.size()) {
+            out += static_cast<char>(std::stoi(in.substr(i + 1, 2), nullptr, 16));
+            i += 2;
+        } else if (in[i] == '+') {
+            out += ' ';
+        } else {
+            out += in[i];
+        }
+    }
+    return out;
+}
+
+std::map<std::string, std::string> parse_query(const std::string& query) {
+    std::map<std::string, std::string> params;
+    std::istringstream iss(query);
+    std::string pair;
+    while (std::getline(iss, pair, '&')) {
+        size_t eq = pair.find('=');
+        if (eq == std::string::npos) {
+            params[percent_decode(pair)] = "";
+        } else {
+            params[percent_decode(pair.substr(0, eq))] = percent_decode(pair.substr(eq + 1));
+        }
+    }
+    return params;
+}
+
+// "ticker.SOL_USDC" -> ("ticker", "SOL-USDC"), "orders" -> ("orders", "")
+std::pair<std::string, std::string> split_stream(const std::string& stream) {
+    // Channel names such as "candle.1m" and "user.trades" contain dots themselves
+    if (string_to_channel(stream) || stream == "user.trades") {
+        return {stream, ""};
+    }
+    size_t dot = stream.rfind('.');
+    if (dot == std::string::npos) {
+        return {stream, ""};
+    }
+    std::string symbol = stream.substr(dot + 1);
+    std::replace(symbol.begin(), symbol.end(), '_', '-');
+    return {stream.substr(0, dot), symbol};
+}
+
+std::string stream_name(const std::string& channel, const std::string& symbol) {
+    if (symbol.empty()) {
+        return channel;
+    }
+    std::string formatted = symbol;
+    std::replace(formatted.begin(), formatted.end(), '-', '_');
+    return channel + "." + formatted;
+}
+
+// ---------------------------------------------------------------------------
+// WebSocket session
+// ---------------------------------------------------------------------------
+
+class WsSession : public std::enable_shared_from_this<WsSession> {
+public:
+    WsSession(beast::ssl_stream<beast::tcp_stream>&& stream, Server& server)
+        : ws_(std::move(stream)), server_(server) {}
+
+    template<typename Request>
+    void accept(Request&& req) {
+        beast::get_lowest_layer(ws_).expires_never();
+        ws_.set_option(websocket::stream_base::timeout::suggested(beast::role_type::server));
+        ws_.async_accept(req, beast::bind_front_handler(&WsSession::on_accept, shared_from_this()));
+    }
+
+    void send(Frame frame);
+
+private:
+    void on_accept(beast::error_code ec);
+    void do_read();
+    void on_read(beast::error_code ec, std::size_t bytes_transferred);
+    void on_message(const std::string& text);
+    void do_write();
+    void on_write(beast::error_code ec, std::size_t bytes_transferred);
+
+    websocket::stream<beast::ssl_stream<beast::tcp_stream>> ws_;
+    beast::flat_buffer buffer_;
+    std::deque<Frame> queue_;
+    Server& server_;
+};
+
+// ---------------------------------------------------------------------------
+// HTTP session (REST + WebSocket upgrade)
+// ---------------------------------------------------------------------------
+
+class HttpSession : public std::enable_shared_from_this<HttpSession> {
+public:
+    HttpSession(tcp::socket&& socket, ssl::context& ctx, Server& server)
+        : stream_(std::move(socket), ctx), timer_(stream_.get_executor()), server_(server) {}
+
+    void run() {
+        beast::get_lowest_layer(stream_).expires_after(std::chrono::seconds(30));
+        stream_.async_handshake(ssl::stream_base::server,
+            beast::bind_front_handler(&HttpSession::on_handshake, shared_from_this()));
+    }
+
+private:
+    void on_handshake(beast::error_code ec) {
+        if (ec) {
+            return;
+        }
+        do_read();
+    }
+
+    void do_read() {
+        request_ = {};
+        beast::get_lowest_layer(stream_).expires_after(std::chrono::seconds(120));
+        http::async_read(stream_, buffer_, request_,
+            beast::bind_front_handler(&HttpSession::on_read, shared_from_this()));
+    }
+
+    void on_read(beast::error_code ec, std::size_t);
+    void on_write(bool keep_alive, beast::error_code ec, std::size_t);
+
+    beast::ssl_stream<beast::tcp_stream> stream_;
+    beast::flat_buffer buffer_;
+    http::request<http::string_body> request_;
+    std::shared_ptr<http::response<http::string_body>> response_;
+    net::steady_timer timer_;
+    Server& server_;
+};
+
+// ---------------------------------------------------------------------------
+// Server
+// ---------------------------------------------------------------------------
+
+class Server {
+public:
+    Server(net::io_context& ioc, ServerConfig config)
+        : ioc_(ioc)
+        , config_(std::move(config))
+        , ssl_ctx_(ssl::context::tls_server)
+        , acceptor_(ioc)
+        , tick_timer_(ioc)
+        , stats_timer_(ioc)
+        , market_(config_.market)
+        , rng_(std::random_device{}()) {
+        if (config_.synthetic) {
+            feedgen::FeedConfig feed;
+            feed.symbols = config_.market.symbols;
+            feed.depth_levels = config_.market.book_levels;
+            feed.publish_ts = true;
+            synthetic_ = std::make_unique<feedgen::FeedGenerator>(std::move(feed));
+        }
+        if (!config_.cert_file.empty() && !config_.key_file.empty()) {
+            ssl_ctx_.use_certificate_chain_file(config_.cert_file);
+            ssl_ctx_.use_private_key_file(config_.key_file, ssl::context::pem);
+        } else {
+            make_self_signed(ssl_ctx_, config_.ca_out);
+        }
+
+        tcp::endpoint endpoint(net::ip::make_address(config_.address), config_.port);
+        acceptor_.open(endpoint.protocol());
+        acceptor_.set_option(net::socket_base::reuse_address(true));
+        acceptor_.bind(endpoint);
+        acceptor_.listen(net::socket_base::max_listen_connections);
+    }
+
+    void run() {
+        std::cout << "Mock exchange listening on https/wss://" << config_.address << ":" << config_.port
+                  << " (" << config_.market.symbols.size() << " symbols, " << config_.rate
+                  << " msg/s per stream" << (synthetic_ ? ", synthetic feed" : "") << ")" << std::endl;
+        do_accept();
+        last_tick_ = std::chrono::steady_clock::now();
+        schedule_tick();
+        if (config_.stats_interval_s > 0) {
+            schedule_stats();
+        }
+    }
+
+    const ServerConfig& config() const { return config_; }
+    ServerStats& stats() { return stats_; }
+    MarketSimulator& market() { return market_; }
+
+    // Random delay applied to every response/frame
+    std::chrono::microseconds injected_delay() {
+        if (config_.jitter.count() == 0) {
+            return config_.latency;
+        }
+        std::uniform_int_distribution<int64_t> dist(-config_.jitter.count(), config_.jitter.count());
+        return std::max(std::chrono::microseconds(0), config_.latency + std::chrono::microseconds(dist(rng_)));
+    }
+
+    void subscribe(const std::shared_ptr<WsSession>& session, const std::string& channel,
+                   const std::string& symbol, Framing framing) {
+        auto& subscribers = subscriptions_[key(channel, symbol)];
+        subscribers.erase(session);
+        subscribers.emplace(session, framing);
+    }
+
+    void unsubscribe(const std::shared_ptr<WsSession>& session, const std::string& channel, const std::string& symbol) {
+        auto it = subscriptions_.find(key(channel, symbol));
+        if (it != subscriptions_.end()) {
+            it->second.erase(session);
+        }
+    }
+
+    void remove_session(const std::shared_ptr<WsSession>& session) {
+        for (auto& entry : subscriptions_) {
+            entry.second.erase(session);
+        }
+    }
+
+    // Fan a payload out to every session subscribed to channel/symbol
+    void publish(const std::string& channel, const std::string& symbol, const json& data) {
+        auto it = subscriptions_.find(key(channel, symbol));
+        if (it == subscriptions_.end() || it->second.empty()) {
+            return;
+        }
+
+        Frame legacy;
+        Frame stream;
+        for (const auto& entry : it->second) {
+            Frame& frame = entry.second == Framing::LEGACY ? legacy : stream;
+            if (!frame) {
+                json j = entry.second == Framing::LEGACY
+                    ? json{{"type", "data"}, {"channel", channel}, {"symbol", symbol}, {"data", data}}
+                    : json{{"stream", stream_name(channel, symbol)}, {"data", data}};
+                // Publish time in ns since epoch, used by load tools to measure event latency
+                j["ts"] = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::system_clock::now().time_since_epoch()).count();
+                frame = std::make_shared<const std::string>(j.dump());
+            }
+            deliver(entry.first, frame);
+        }
+    }
+
+    // Render the generator's next frame for one stream, skipping streams nobody subscribed to
+    void publish_synthetic(size_t stream) {
+        auto it = subscriptions_.find(key(synthetic_->channel(stream), synthetic_->symbol(stream)));
+        if (it == subscriptions_.end() || it->second.empty()) {
+            return;
+        }
+
+        Frame legacy;
+        Frame framed;
+        for (const auto& entry : it->second) {
+            bool is_legacy = entry.second == Framing::LEGACY;
+            Frame& frame = is_legacy ? legacy : framed;
+            if (!frame) {
+                frame = std::make_shared<const std::string>(synthetic_->render(
+                    stream, is_legacy ? feedgen::FeedFraming::LEGACY : feedgen::FeedFraming::STREAM));
+            }
+            deliver(entry.first, frame);
+        }
+    }
+
+    // Queue a frame behind the injected latency, preserving publish order
+    void deliver(const std::shared_ptr<WsSession>& session, Frame frame) {
+        if (config_.latency.count() == 0 && config_.jitter.count() == 0) {
+            session->send(std::move(frame));
+            return;
+        }
+        auto release = std::max(last_release_, std::chrono::steady_clock::now() + injected_delay());
+        last_release_ = release;
+        delay_line_.push_back({release, session, std::move(frame)});
+    }
+
+    http::response<http::string_body> handle_rest(const http::request<http::string_body>& req);
+
+private:
+    static std::string key(const std::string& channel, const std::string& symbol) {
+        return channel + ":" + symbol;
+    }
+
+    void do_accept() {
+        acceptor_.async_accept(net::make_strand(ioc_), [this](beast::error_code ec, tcp::socket socket) {
+            if (!ec) {
+                std::make_shared<HttpSession>(std::move(socket), ssl_ctx_, *this)->run();
+            }
+            do_accept();
+        });
+    }
+
+    void schedule_tick() {
+        tick_timer_.expires_after(std::chrono::milliseconds(1));
+        tick_timer_.async_wait([this](beast::error_code ec) {
+            if (!ec) {
+                on_tick();
+                schedule_tick();
+            }
+        });
+    }
+
+    void schedule_stats() {
+        stats_timer_.expires_after(std::chrono::seconds(config_.stats_interval_s));
+        stats_timer_.async_wait([this](beast::error_code ec) {
+            if (!ec) {
+                std::cout << "sessions=" << stats_.sessions
+                          << " frames_sent=" << stats_.frames_sent
+                          << " frames_dropped=" << stats_.frames_dropped
+                          << " rest_requests=" << stats_.rest_requests
+                          << " auth_failures=" << stats_.auth_failures << std::endl;
+                schedule_stats();
+            }
+        });
+    }
+
+    // Generate market events for every stream that is due, then release delayed frames
+    void on_tick() {
+        auto now = std::chrono::steady_clock::now();
+        double elapsed = std::chrono::duration<double>(now - last_tick_).count();
+        last_tick_ = now;
+        credit_ += elapsed * config_.rate;
+
+        auto due = static_cast<uint64_t>(credit_);
+        credit_ -= static_cast<double>(due);
+
+        for (uint64_t i = 0; i < due; ++i) {
+            if (synthetic_) {
+                for (size_t stream = 0; stream < synthetic_->stream_count(); ++stream) {
+                    publish_synthetic(stream);
+                }
+                continue;
+            }
+            for (const auto& symbol : market_.symbols()) {
+                publish("depth", symbol, market_.next_depth_update(symbol));
+                publish("trades", symbol, market_.next_trade(symbol));
+                publish("ticker", symbol, market_.ticker(symbol));
+            }
+        }
+
+        while (!delay_line_.empty() && delay_line_.front().release <= now) {
+            delay_line_.front().session->send(std::move(delay_line_.front().frame));
+            delay_line_.pop_front();
+        }
+    }
+
+    json handle_order_request(const json& body);
+    json find_order(const std::map<std::string, std::string>& params);
+
+    struct DelayedFrame {
+        std::chrono::steady_clock::time_point release;
+        std::shared_ptr<WsSession> session;
+        Frame frame;
+    };
+
+    net::io_context& ioc_;
+    ServerConfig config_;
+    ssl::context ssl_ctx_;
+    tcp::acceptor acceptor_;
+    net::steady_timer tick_timer_;
+    net::steady_timer stats_timer_;
+    MarketSimulator market_;
+    std::unique_ptr<feedgen::FeedGenerator> synthetic_;
+    std::mt19937_64 rng_;
+    ServerStats stats_;
+
+    std::map<std::string, std::map<std::shared_ptr<WsSession>, Framing>> subscriptions_;
+    std::deque<DelayedFrame> delay_line_;
+    std::chrono::steady_clock::time_point last_release_{};
+    std::chrono::steady_clock::time_point last_tick_{};
+    double credit_ = 0.0;
+
+    std::map<std::string, json> orders_;
+    uint64_t next_order_id_ = 1000000;
+};
+
+// ---------------------------------------------------------------------------
+// REST handling
+// ---------------------------------------------------------------------------
+
+json Server::handle_order_request(const json& body) {
+    std::string symbol = body.at("symbol");
+    if (!market_.has_symbol(symbol)) {
+        throw std::invalid_argument("Unknown symbol: " + symbol);
+    }
+
+    json order = {
+        {"orderId", std::to_string(next_order_id_++)},
+        {"clientOrderId", body.value("clientOrderId", "")},
+        {"symbol", symbol},
+        {"side", body.at("side")},
+        {"type", body.at("type")},
+        {"price", body.value("price", market_.mid_price(symbol))},
+        {"quantity", body.at("quantity")},
+        {"executedQty", "0"},
+        {"status", "NEW"},
+        {"timestamp", timestamp_to_iso8601(get_current_timestamp_ms())}
+    };
+
+    orders_[order["orderId"].get<std::string>()] = order;
+    publish("orders", "", order);
+    return order;
+}
+
+json Server::find_order(const std::map<std::string, std::string>& params) {
+    auto id = params.find("orderId");
+    if (id != params.end()) {
+        auto it = orders_.find(id->second);
+        if (it != orders_.end()) {
+            return it->second;
+        }
+    }
+
+    auto client_id = params.find("clientOrderId");
+    if (client_id != params.end()) {
+        for (const auto& entry : orders_) {
+            if (entry.second["clientOrderId"] == client_id->second) {
+                return entry.second;
+            }
+        }
+    }
+
+    throw std::out_of_range("Order not found");
+}
+
+http::response<http::string_body> Server::handle_rest(const http::request<http::string_body>& req) {
+    ++stats_.rest_requests;
+
+    std::string target(req.target());
+    std::string path = target.substr(0, target.find('?'));
+    auto params = parse_query(target.find('?') == std::string::npos ? "" : target.substr(target.find('?') + 1));
+    http::verb method = req.method();
+
+    auto respond = [&req](http::status status, const json& body) {
+        http::response<http::string_body> res{status, req.version()};
+        res.set(http::field::server, "backpack-mock-exchange");
+        res.set(http::field::content_type, "application/json");
+        res.keep_alive(req.keep_alive());
+        res.body() = body.dump();
+        res.prepare_payload();
+        return res;
+    };
+
+    static const std::set<std::string> private_paths = {
+        "/api/v1/historicalTrades", "/api/v1/order", "/api/v1/order/test", "/api/v1/openOrders",
+        "/api/v1/allOrders", "/api/v1/account", "/api/v1/balances", "/api/v1/myTrades"
+    };
+
+    if (config_.verify_signatures && private_paths.count(path)) {
+        std::string api_key(req["X-API-KEY"]);
+        std::string ts(req["X-BPX-TS"]);
+        std::string signature(req["X-BPX-SIGNATURE"]);
+
+        bool ok = !api_key.empty() && !signature.empty();
+        int64_t timestamp = 0;
+        if (ok) {
+            // A malformed timestamp is the client's fault; it must not throw out of the session
+            auto [end, ec] = std::from_chars(ts.data(), ts.data() + ts.size(), timestamp);
+            ok = ec == std::errc() && end == ts.data() + ts.size() && timestamp >= 0;
+        }
+        if (ok) {
+            int64_t skew = get_current_timestamp_ms() - timestamp;
+            ok = std::llabs(skew) <= config_.signature_window_ms;
+        }
+        if (ok) {
+            bool has_body = method == http::verb::post || method == http::verb::put;
+            ok = verify_ed25519(api_key, (has_body ? req.body() : std::string()) + ts, signature);
+        }
+        if (!ok) {
+            ++stats_.auth_failures;
+            return respond(http::status::unauthorized, {{"code", "INVALID_SIGNATURE"}, {"message", "Signature verification failed"}});
+        }
+    }
+
+    try {
+        auto symbol_param = [&params]() { return params.at("symbol"); };
+        auto limit_param = [&params](size_t fallback) {
+            auto it = params.find("limit");
+            return it == params.end() ? fallback : static_cast<size_t>(std::stoul(it->second));
+        };
+
+        if (path == "/api/v1/time") {
+            return respond(http::status::ok, {{"serverTime", get_current_timestamp_ms()}});
+        }
+        if (path == "/api/v1/exchangeInfo") {
+            return respond(http::status::ok, market_.exchange_info());
+        }
+        if (path == "/api/v1/ticker") {
+            return respond(http::status::ok, market_.ticker(symbol_param()));
+        }
+        if (path == "/api/v1/tickers") {
+            json tickers = json::array();
+            for (const auto& symbol : market_.symbols()) {
+                tickers.push_back(market_.ticker(symbol));
+            }
+            return respond(http::status::ok, tickers);
+        }
+        if (path == "/api/v1/depth") {
+            return respond(http::status::ok, market_.depth_snapshot(symbol_param(), limit_param(100)));
+        }
+        if (path == "/api/v1/trades") {
+            return respond(http::status::ok, market_.recent_trades(symbol_param(), limit_param(100)));
+        }
+        if (path == "/api/v1/historicalTrades") {
+            auto from = params.find("fromId");
+            uint64_t from_id = from == params.end() ? 0 : std::stoull(from->second);
+            return respond(http::status::ok, market_.trades_after(symbol_param(), from_id, limit_param(100)));
+        }
+        if (path == "/api/v1/myTrades") {
+            return respond(http::status::ok, json::array());
+        }
+        if (path == "/api/v1/klines") {
+            return respond(http::status::ok, market_.klines(symbol_param(), limit_param(100)));
+        }
+        if (path == "/api/v1/order/test" && method == http::verb::post) {
+            json body = json::parse(req.body());
+            if (!market_.has_symbol(body.at("symbol"))) {
+                return respond(http::status::bad_request, {{"code", "INVALID_SYMBOL"}, {"message", "Unknown symbol"}});
+            }
+            return respond(http::status::ok, json::object());
+        }
+        if (path == "/api/v1/order") {
+            if (method == http::verb::post) {
+                return respond(http::status::ok, handle_order_request(json::parse(req.body())));
+            }
+            json order = find_order(params);
+            if (method == http::verb::delete_) {
+                order["status"] = "CANCELED";
+                orders_[order["orderId"].get<std::string>()] = order;
+                publish("orders", "", order);
+            }
+            return respond(http::status::ok, order);
+        }
+        if (path == "/api/v1/openOrders" || path == "/api/v1/allOrders") {
+            bool open_only = path == "/api/v1/openOrders";
+            auto symbol = params.find("symbol");
+            json orders = json::array();
+            int cancelled = 0;
+            for (auto& entry : orders_) {
+                json& order = entry.second;
+                if (symbol != params.end() && order["symbol"] != symbol->second) {
+                    continue;
+                }
+                if (open_only && order["status"] != "NEW" && order["status"] != "PARTIALLY_FILLED") {
+                    continue;
+                }
+                if (method == http::verb::delete_) {
+                    order["status"] = "CANCELED";
+                    publish("orders", "", order);
+                    ++cancelled;
+                } else {
+                    orders.push_back(order);
+                }
+            }
+            if (method == http::verb::delete_) {
+                return respond(http::status::ok, {{"count", cancelled}});
+            }
+            return respond(http::status::ok, orders);
+        }
+        if (path == "/api/v1/balances" || path == "/api/v1/account") {
+            json balances = json::array();
+            balances.push_back({{"asset", "USDC"}, {"free", "1000000.00"}, {"locked", "0.00"}});
+            for (const auto& symbol : market_.symbols()) {
+                balances.push_back({{"asset", symbol.substr(0, symbol.find('-'))}, {"free", "1000.00"}, {"locked", "0.00"}});
+            }
+            if (path == "/api/v1/balances") {
+                return respond(http::status::ok, balances);
+            }
+            return respond(http::status::ok, {
+                {"accountId", "mock-account"},
+                {"accountType", "SPOT"},
+                {"canTrade", true},
+                {"canWithdraw", false},
+                {"balances", balances}
+            });
+        }
+
+        return respond(http::status::not_found, {{"code", "NOT_FOUND"}, {"message", "Unknown endpoint " + path}});
+    } catch (const std::out_of_range& e) {
+        return respond(http::status::not_found, {{"code", "NOT_FOUND"}, {"message", e.what()}});
+    } catch (const std::exception& e) {
+        return respond(http::status::bad_request, {{"code", "INVALID_REQUEST"}, {"message", e.what()}});
+    }
+}
+
+void HttpSession::on_read(beast::error_code ec, std::size_t) {
+    if (ec) {
+        return;
+    }
+
+    if (websocket::is_upgrade(request_)) {
+        ++server_.stats().sessions;
+        std::make_shared<WsSession>(std::move(stream_), server_)->accept(std::move(request_));
+        return;
+    }
+
+    response_ = std::make_shared<http::response<http::string_body>>(server_.handle_rest(request_));
+    bool keep_alive = response_->keep_alive();
+
+    auto write = [self = shared_from_this(), keep_alive]() {
+        http::async_write(self->stream_, *self->response_,
+            beast::bind_front_handler(&HttpSession::on_write, self, keep_alive));
+    };
+
+    auto delay = server_.injected_delay();
+    if (delay.count() == 0) {
+        write();
+        return;
+    }
+    timer_.expires_after(delay);
+    timer_.async_wait([write](beast::error_code) { write(); });
+}
+
+void HttpSession::on_write(bool keep_alive, beast::error_code ec, std::size_t) {
+    if (ec) {
+        return;
+    }
+    if (!keep_alive) {
+        beast::get_lowest_layer(stream_).socket().shutdown(tcp::socket::shutdown_send, ec);
+        return;
+    }
+    do_read();
+}
+
+// ---------------------------------------------------------------------------
+// WebSocket handling
+// ---------------------------------------------------------------------------
+
+void WsSession::on_accept(beast::error_code ec) {
+    if (ec) {
+        return;
+    }
+    do_read();
+}
+
+void WsSession::do_read() {
+    ws_.async_read(buffer_, beast::bind_front_handler(&WsSession::on_read, shared_from_this()));
+}
+
+void WsSession::on_read(beast::error_code ec, std::size_t) {
+    if (ec) {
+        server_.remove_session(shared_from_this());
+        return;
+    }
+
+    std::string text = beast::buffers_to_string(buffer_.data());
+    buffer_.consume(buffer_.size());
+    on_message(text);
+    do_read();
+}
+
+void WsSession::on_message(const std::string& text) {
+    auto self = shared_from_this();
+    auto reply = [this](const json& j) {
+        send(std::make_shared<const std::string>(j.dump()));
+    };
+
+    json msg;
+    try {
+        msg = json::parse(text);
+    } catch (const std::exception& e) {
+        reply({{"type", "error"}, {"message", std::string("Invalid JSON: ") + e.what()}});
+        return;
+    }
+
+    // BackpackClient protocol: {"type":"subscribe","channel":"ticker","symbol":"SOL-USDC"}
+    if (msg.contains("type")) {
+        std::string type = msg["type"];
+        std::string channel = msg.value("channel", "");
+        std::string symbol = msg.value("symbol", "");
+
+        if (type == "subscribe" || type == "unsubscribe") {
+            if (!symbol.empty() && !server_.market().has_symbol(symbol)) {
+                reply({{"type", "error"}, {"message", "Unknown symbol " + symbol}});
+                return;
+            }
+            if (type == "subscribe") {
+                server_.subscribe(self, channel, symbol, Framing::LEGACY);
+            } else {
+                server_.unsubscribe(self, channel, symbol);
+            }
+            reply({{"type", type + "d"}, {"channel", channel}, {"symbol", symbol}});
+        } else if (type == "ping") {
+            reply({{"type", "pong"}});
+        } else if (type == "auth") {
+            reply({{"type", "authenticated"}});
+        } else {
+            reply({{"type", "error"}, {"message", "Unknown message type " + type}});
+        }
+        return;
+    }
+
+    // Stream protocol: {"method":"SUBSCRIBE","params":["ticker.SOL_USDC", ...]}
+    std::string method = msg.value("method", "");
+    if (method == "SUBSCRIBE" || method == "UNSUBSCRIBE") {
+        for (const auto& param : msg.value("params", json::array())) {
+            auto [channel, symbol] = split_stream(param.get<std::string>());
+            if (method == "SUBSCRIBE") {
+                server_.subscribe(self, channel, symbol, Framing::STREAM);
+            } else {
+                server_.unsubscribe(self, channel, symbol);
+            }
+        }
+        if (msg.contains("id")) {
+            reply({{"result", nullptr}, {"id", msg["id"]}});
+        }
+    } else if (method == "PING") {
+        reply({{"result", "PONG"}});
+    }
+}
+
+void WsSession::send(Frame frame) {
+    if (queue_.size() >= server_.config().max_queue) {
+        ++server_.stats().frames_dropped;
+        return;
+    }
+    queue_.push_back(std::move(frame));
+    if (queue_.size() == 1) {
+        do_write();
+    }
+}
+
+void WsSession::do_write() {
+    ws_.text(true);
+    ws_.async_write(net::buffer(*queue_.front()),
+        beast::bind_front_handler(&WsSession::on_write, shared_from_this()));
+}
+
+void WsSession::on_write(beast::error_code ec, std::size_t) {
+    if (ec) {
+        queue_.clear();
+        server_.remove_session(shared_from_this());
+        return;
+    }
+    ++server_.stats().frames_sent;
+    queue_.pop_front();
+    if (!queue_.empty()) {
+        do_write();
+    }
+}
+
+} // namespace mock
+} // namespace backpack
+
+namespace {
+
+std::vector<std::string> split_list(const std::string& list) {
+    std::vector<std::string> items;
+    std::istringstream iss(list);
+    std::string item;
+    while (std::getline(iss, item, ',')) {
+        if (!item.empty()) {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+void print_usage(const char* argv0) {
+    std::cout << "Usage: " << argv0 << " [options]\n"
+              << "  --address ADDR         Listen address (default 127.0.0.1)\n"
+              << "  --port PORT            Listen port for HTTPS and WSS (default 8443)\n"
+              << "  --symbols A,B,...      Symbols to simulate (default SOL-USDC,BTC-USDC,ETH-USDC)\n"
+              << "  --rate N               Messages per second per subscribed stream (default 100)\n"
+              << "  --book-levels N        Book levels per side (default 20)\n"
+              << "  --churn F              Fraction of levels changed per depth update (default 0.2)\n"
+              << "  --latency-us N         Latency injected into every REST response and WS frame\n"
+              << "  --jitter-us N          Uniform +/- jitter on top of the injected latency\n"
+              << "  --verify-signatures    Reject private REST requests with a bad X-BPX-SIGNATURE\n"
+              << "  --window-ms N          Accepted X-BPX-TS skew when verifying (default 5000)\n"
+              << "  --cert FILE --key FILE PEM certificate and key (default: generate self-signed)\n"
+              << "  --ca-out FILE          Where to write the generated certificate (default mock_exchange_ca.pem)\n"
+              << "  --stats-interval S     Seconds between stats lines, 0 to disable (default 5)\n"
+              << "  --synthetic            Publish pre-rendered synthetic frames (cheap enough for millions/s)\n"
+              << "  --synthetic-symbols N  Simulate SYM0-USDC..SYM<N-1>-USDC; implies --synthetic\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    backpack::mock::ServerConfig config;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                throw std::invalid_argument("Missing value for " + arg);
+            }
+            return argv[++i];
+        };
+
+        try {
+            if (arg == "--address") config.address = next();
+            else if (arg == "--port") config.port = static_cast<unsigned short>(std::stoi(next()));
+            else if (arg == "--symbols") config.market.symbols = split_list(next());
+            else if (arg == "--rate") config.rate = std::stod(next());
+            else if (arg == "--book-levels") config.market.book_levels = std::stoul(next());
+            else if (arg == "--churn") config.market.churn = std::stod(next());
+            else if (arg == "--latency-us") config.latency = std::chrono::microseconds(std::stoll(next()));
+            else if (arg == "--jitter-us") config.jitter = std::chrono::microseconds(std::stoll(next()));
+            else if (arg == "--verify-signatures") config.verify_signatures = true;
+            else if (arg == "--window-ms") config.signature_window_ms = std::stoll(next());
+            else if (arg == "--cert") config.cert_file = next();
+            else if (arg == "--key") config.key_file = next();
+            else if (arg == "--ca-out") config.ca_out = next();
+            else if (arg == "--stats-interval") config.stats_interval_s = std::stoi(next());
+            else if (arg == "--synthetic") config.synthetic = true;
+            else if (arg == "--synthetic-symbols") {
+                config.market.symbols = backpack::feedgen::FeedGenerator::make_symbols(std::stoul(next()));
+                config.synthetic = true;
+            }
+            else if (arg == "--help" || arg == "-h") {
+                print_usage(argv[0]);
+                return 0;
+            } else {
+                throw std::invalid_argument("Unknown option " + arg);
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    try {
+        net::io_context ioc{1};
+        backpack::mock::Server server(ioc, config);
+        server.run();
+
+        net::signal_set signals(ioc, SIGINT, SIGTERM);
+        signals.async_wait([&ioc](beast::error_code, int) { ioc.stop(); });
+
+        ioc.run();
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}